@@ -0,0 +1,102 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "core/opencv_circlesgrid.h"
+#include "util/utils.h"
+#include "spdlog/spdlog.h"
+#include "opencv2/calib3d.hpp"
+#include "random"
+#include "chrono"
+#include "algorithm"
+
+/**
+ * sweeps the count of spurious candidates around a synthetic symmetric circle grid, and reports the
+ * time of 'FindCirclesGrid' with the default parameters, and with the candidate pruning and the
+ * path length bound enabled, as well as whether the detected centers are identical
+ */
+int main(int argc, char **argv) {
+    ns_ekalibr::ConfigSpdlog();
+
+    const cv::Size patternSize(7, 5), imgSize(640, 480);
+    const float spacing = 40.0f;
+    const int repeats = 20;
+
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+    std::uniform_real_distribution<float> xDist(0.0f, float(imgSize.width));
+    std::uniform_real_distribution<float> yDist(0.0f, float(imgSize.height));
+
+    std::vector<cv::Point2f> grid;
+    for (int r = 0; r < patternSize.height; ++r) {
+        for (int c = 0; c < patternSize.width; ++c) {
+            grid.emplace_back(180.0f + c * spacing + jitter(engine),
+                              140.0f + r * spacing + jitter(engine));
+        }
+    }
+
+    ns_cv_helper::CirclesGridFinderParameters defaultParams;
+    ns_cv_helper::CirclesGridFinderParameters fastParams;
+    fastParams.candidatePruningFactor = 4.0f;
+    fastParams.pathLengthBoundFactor = 2.0f;
+
+    auto Detect = [&patternSize](const std::vector<cv::Point2f> &candidates,
+                                 const ns_cv_helper::CirclesGridFinderParameters &params,
+                                 std::vector<cv::Point2f> &centers) {
+        const auto start = std::chrono::steady_clock::now();
+        const bool found = ns_cv_helper::FindCirclesGrid(
+            candidates, patternSize, centers, cv::CALIB_CB_SYMMETRIC_GRID, nullptr, params);
+        const auto end = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+        return std::make_pair(found, elapsed);
+    };
+
+    spdlog::info("{:>10} {:>14} {:>14} {:>8} {:>10}", "clutter", "default (ms)", "fast (ms)",
+                 "found", "identical");
+    for (int clutter : {0, 25, 50, 100, 200, 400, 800}) {
+        double defaultTime = 0.0, fastTime = 0.0;
+        int foundCount = 0, identicalCount = 0;
+        for (int i = 0; i < repeats; ++i) {
+            std::vector<cv::Point2f> candidates = grid;
+            for (int j = 0; j < clutter; ++j) {
+                candidates.emplace_back(xDist(engine), yDist(engine));
+            }
+            std::shuffle(candidates.begin(), candidates.end(), engine);
+
+            std::vector<cv::Point2f> defaultCenters, fastCenters;
+            const auto [defaultFound, dt1] = Detect(candidates, defaultParams, defaultCenters);
+            const auto [fastFound, dt2] = Detect(candidates, fastParams, fastCenters);
+            defaultTime += dt1, fastTime += dt2;
+            foundCount += defaultFound;
+            identicalCount += defaultFound == fastFound && defaultCenters == fastCenters;
+        }
+        spdlog::info("{:>10} {:>14.3f} {:>14.3f} {:>8} {:>10}", clutter, defaultTime / repeats,
+                     fastTime / repeats, fmt::format("{}/{}", foundCount, repeats),
+                     fmt::format("{}/{}", identicalCount, repeats));
+    }
+    return 0;
+}
@@ -38,6 +38,7 @@
 #include "sensor/imu.hpp"
 #include "ctraj/core/spline_bundle.h"
 #include "config/configor.h"
+#include "util/time_indexed.hpp"
 
 namespace ns_veta {
 struct PinholeIntrinsic;
@@ -65,6 +66,8 @@ using EstimatorPtr = std::shared_ptr<Estimator>;
 enum class OptOption : std::uint64_t;
 struct VisualProjectionPair;
 using VisualProjectionPairPtr = std::shared_ptr<VisualProjectionPair>;
+struct VisualProjectionPairs;
+using VisualProjectionPairsPtr = std::shared_ptr<VisualProjectionPairs>;
 struct VisualProjectionCircleBasedPair;
 using VisualProjectionCircleBasedPairPtr = std::shared_ptr<VisualProjectionCircleBasedPair>;
 class SpatialTemporalPriori;
@@ -140,7 +143,7 @@ protected:
     // visual reprojection pairs
     std::map<std::string, std::vector<VisualProjectionPairPtr>> _evSyncPointProjPairs;
     // visual reprojection pairs (asynchronous, from time-varying circle, circle-center-based)
-    std::map<std::string, std::list<VisualProjectionPairPtr>> _evAsyncPointProjPairs;
+    std::map<std::string, VisualProjectionPairsPtr> _evAsyncPointProjPairs;
 
 public:
     CalibSolver(CalibParamManagerPtr parMgr);
@@ -160,7 +163,36 @@ protected:
 
     static PosSplineType CreatePosSpline(double st, double et, double posDt, bool printInfo);
 
-    void CreateSplineSegments(double dtSo3, double dtPos, bool printInfo = false);
+    /**
+     * @param adaptiveKnots if true, knot distances of each segment are enlarged according to its
+     * motion, see 'AdaptiveKnotTimeDist'
+     */
+    void CreateSplineSegments(double dtSo3,
+                              double dtPos,
+                              bool printInfo = false,
+                              bool adaptiveKnots = false);
+
+    /**
+     * knot distances are enlarged by powers of two, as long as the inertial measurements of the
+     * reference imu in [st, et] can still be fitted, see 'Configor::Prior::AdaptiveKnots'
+     * @return the knot distances of the so3 spline and the pos spline
+     */
+    std::pair<double, double> AdaptiveKnotTimeDist(double st,
+                                                   double et,
+                                                   double dtSo3,
+                                                   double dtPos) const;
+
+    /**
+     * root mean square error of the least-squares fitting of samples using a uniform B-spline
+     * @param order the order of the B-spline, i.e., 3 for angular velocities of so3 splines, and 2
+     * for accelerations of pos splines (both of order 4)
+     */
+    static double UniformBSplineFittingRMSE(
+        const std::vector<std::pair<double, Eigen::Vector3d>> &samples,
+        double st,
+        double et,
+        double dt,
+        int order);
 
     void EstimateCameraIntrinsics();
 
@@ -197,7 +229,7 @@ protected:
      * the gyroscope. If multiple gyroscopes (IMUs) are involved, the extrinsic rotations and
      * time offsets would be also recovered
      */
-    void InitSo3Spline() const;
+    void InitSo3Spline();
 
     void EventInertialAlignment();
 
@@ -208,17 +240,57 @@ protected:
 
     void InitSo3SplineSegments();
 
-    void InitPosSpline() const;
+    /**
+     * obtain the so3 spline of a segment from the full so3 spline by knot insertion (exactly)
+     * @param refinedSplines the full so3 spline refined 0, 1, 2, ... times, extended when needed
+     * @return false if their knot grids are not aligned
+     */
+    bool So3SplineSegmentByKnotInsertion(int segIdx, std::vector<So3SplineType> &refinedSplines);
+
+    // move starts of time segments onto the knot grid of the spline (as long as not overlapped)
+    void AlignTimeSegmentsToKnotGrid(const So3SplineType &spline);
+
+    /**
+     * split valid time segments into windows, and greedily keep those maximizing the
+     * log-determinant of the approximated information of calibration parameters (from gyroscope
+     * and accelerometer measurements of the reference imu, weighted by grid tracking density)
+     * within the budget, see 'Configor::Prior::InformativeSegments'. The '_validTimeSegments' are
+     * updated as the kept windows
+     */
+    void SelectInformativeTimeSegments();
+
+    void InitPosSpline();
 
     std::optional<int> IsTimeInValidSegment(double timeByBr) const;
 
     void CreateVisualProjPairsSyncPointBased();
 
-    void CreateVisualProjPairsAsyncPointBased(double dt = 0.005);
+    void CreateVisualProjPairsAsyncPointBased();
 
     void BatchOptimizations();
 
+    /**
+     * spline segments are linked only by calibration parameters, thus knots of each segment are
+     * solved in parallel with calibration parameters fixed, and then calibration parameters are
+     * solved on the Schur complements of segments, alternately. Returns false if the Schur
+     * complement of any segment fails, then the joint problem should be solved in full
+     */
+    bool PartitionedBatchOptimization(OptOption option);
+
 protected:
+    enum class VisualProjType { SYNC_POINT_BASED, ASYNC_POINT_BASED };
+    // the type of visual projection pairs used in batch optimizations
+    static constexpr VisualProjType BatchOptVisualProjType = VisualProjType::ASYNC_POINT_BASED;
+
+    /**
+     * add all factors of batch optimizations to the estimator
+     * @param segIdx if set, only measurements in this spline segment are involved
+     */
+    void AddBatchOptimizationFactors(const EstimatorPtr &estimator,
+                                     OptOption option,
+                                     const std::optional<int> &segIdx = {},
+                                     bool verbose = true);
+
     std::size_t AddGyroFactorToFullSo3Spline(const EstimatorPtr &estimator,
                                              const std::string &imuTopic,
                                              OptOption option,
@@ -229,56 +301,45 @@ protected:
                                               const std::string &imuTopic,
                                               OptOption option,
                                               const std::optional<double> &weight,
-                                              const std::optional<double> &dsRate = {}) const;
+                                              const std::optional<double> &dsRate = {},
+                                              const std::optional<int> &segIdx = {}) const;
 
     std::size_t AddAcceFactorToSplineSegments(const EstimatorPtr &estimator,
                                               const std::string &imuTopic,
                                               OptOption option,
                                               const std::optional<double> &weight,
-                                              const std::optional<double> &dsRate = {}) const;
+                                              const std::optional<double> &dsRate = {},
+                                              const std::optional<int> &segIdx = {}) const;
 
     std::size_t AddVisualProjPairsSyncPointBasedToSplineSegments(
         const EstimatorPtr &estimator,
         const std::string &camTopic,
         OptOption option,
-        const std::optional<double> &weight) const;
+        const std::optional<double> &weight,
+        const std::optional<int> &segIdx = {}) const;
 
     std::size_t AddVisualProjPairsAsyncPointBasedToSplineSegments(
         const EstimatorPtr &estimator,
         const std::string &camTopic,
         OptOption option,
-        const std::optional<double> &weight) const;
+        const std::optional<double> &weight,
+        const std::optional<int> &segIdx = {}) const;
 
 private:
-    // remove the head data according to the pred
-    template <class MsgType>
-    void EraseSeqHeadData(std::vector<std::shared_ptr<MsgType>> &seq,
-                          std::function<bool(const std::shared_ptr<MsgType> &)> pred,
-                          const std::string &errorMsg) const {
-        auto iter = std::find_if(seq.begin(), seq.end(), std::move(pred));
-        if (iter == seq.end()) {
-            // find failed
-            this->OutputDataStatus();
-            throw std::runtime_error(errorMsg);
-        } else {
-            // adjust
-            seq.erase(seq.begin(), iter);
-        }
-    }
-
-    // remove the tail data according to the pred
+    // remove the head and tail data, i.e., keep the data in the time range (st, et)
     template <class MsgType>
-    void EraseSeqTailData(std::vector<std::shared_ptr<MsgType>> &seq,
-                          std::function<bool(const std::shared_ptr<MsgType> &)> pred,
-                          const std::string &errorMsg) const {
-        auto iter = std::find_if(seq.rbegin(), seq.rend(), pred);
-        if (iter == seq.rend()) {
+    void EraseSeqDataOutOfRange(std::vector<std::shared_ptr<MsgType>> &seq,
+                                double st,
+                                double et,
+                                const std::string &errorMsg) const {
+        auto range = TimeIndexed<MsgType>(seq).OpenRange(st, et);
+        if (range.empty()) {
             // find failed
             this->OutputDataStatus();
             throw std::runtime_error(errorMsg);
         } else {
             // adjust
-            seq.erase(iter.base(), seq.end());
+            seq = std::vector<std::shared_ptr<MsgType>>(range.begin(), range.end());
         }
     }
 
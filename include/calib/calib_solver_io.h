@@ -71,13 +71,24 @@ protected:
     void SaveInertialGyroError() const;
 
 public:
+    /**
+     * raw events are saved in the compact chunked format (see 'PatternEventsCache') for the binary
+     * archive type, and as a cereal archive otherwise
+     */
     static bool SaveRawEventsOfExtractedPatterns(const std::map<int, ExtractedCirclesVec> &data,
                                                  const std::string &filename,
                                                  double timeBias,
                                                  CerealArchiveType::Enum archiveType);
 
+    /**
+     * @param gridIds ids of grids to load, all grids are loaded if empty. Only these grids are
+     * decoded from a compact chunked file, while cereal archives are loaded entirely.
+     */
     static std::map<int, ExtractedCirclesVec> LoadRawEventsOfExtractedPatterns(
-        const std::string &filename, double newTimeBias, CerealArchiveType::Enum archiveType);
+        const std::string &filename,
+        double newTimeBias,
+        CerealArchiveType::Enum archiveType,
+        const std::vector<int> &gridIds = {});
 
     static std::pair<std::string, std::string> GetDiskPathOfExtractedGridPatterns(
         const std::string &topic);
@@ -44,6 +44,8 @@ struct VisualProjectionCircleBasedPair;
 using VisualProjectionCircleBasedPairPtr = std::shared_ptr<VisualProjectionCircleBasedPair>;
 class SpatialTemporalPriori;
 using SpatialTemporalPrioriPtr = std::shared_ptr<SpatialTemporalPriori>;
+class InertialIntegrationCache;
+using InertialIntegrationCachePtr = std::shared_ptr<InertialIntegrationCache>;
 
 using namespace magic_enum::bitwise_operators;
 
@@ -91,9 +93,46 @@ public:
     using SplineMetaType = ns_ctraj::SplineMeta<Configor::Prior::SplineOrder>;
     using Opt = OptOption;
 
+    /**
+     * descriptor of a residual block, which is created without touching the problem, so that
+     * descriptors can be created in parallel and then committed to the problem in order
+     */
+    struct ResidualBlockDesc {
+        ceres::CostFunction *costFunc = nullptr;
+        ceres::LossFunction *lossFunc = nullptr;
+        // param blocks of the residual block, where knots of the so3 and scale spline come first
+        std::vector<double *> paramBlocks;
+        std::size_t so3KnotCount = 0;
+        std::size_t scaleKnotCount = 0;
+    };
+
+    /**
+     * Gauss-Newton normal equation 'H * dx = -b' over the variable param blocks of the problem,
+     * where some blocks are eliminated via the Schur complement
+     */
+    struct SchurSummary {
+        double cost = 0.0;
+        // remaining variable param blocks, and their offsets in the tangent space (plus the size)
+        std::vector<double *> blocks;
+        std::vector<int> offsets;
+        Eigen::MatrixXd H;
+        Eigen::VectorXd b;
+        // eliminated param blocks, recovered by 'dm = margStep + margGain * dx'
+        std::vector<double *> margBlocks;
+        std::vector<int> margOffsets;
+        Eigen::VectorXd margStep;
+        Eigen::MatrixXd margGain;
+    };
+
 private:
     CalibParamManagerPtr parMagr;
 
+    // spline states at inertial measurements shared by alignment factors, keyed by the spline, the
+    // measurement sequence and the imu topic
+    using InertialIntegrationCacheKey =
+        std::tuple<const So3SplineType *, const std::vector<IMUFrame::Ptr> *, std::string>;
+    mutable std::map<InertialIntegrationCacheKey, InertialIntegrationCachePtr> _inertialIntegCache;
+
     // manifolds
     static std::shared_ptr<ceres::EigenQuaternionManifold> QUATER_MANIFOLD;
     static std::shared_ptr<ceres::SphereManifold<3>> GRAVITY_MANIFOLD;
@@ -115,6 +154,16 @@ public:
     Eigen::MatrixXd GetHessianMatrix(const std::vector<double *> &consideredParBlocks,
                                      int numThread = 1);
 
+    /**
+     * @param margBlocks param blocks to be eliminated, those not in the problem or constant are
+     * ignored. All other variable param blocks remain in the summary
+     */
+    SchurSummary MarginalizeParamBlocks(const std::vector<double *> &margBlocks,
+                                        int numThread = 1);
+
+    // 'values = values [+] delta' on the manifold of this param block, clamped to its bounds
+    void UpdateParamBlock(double *values, const double *delta) const;
+
     void PrintParameterInfo() const;
 
     void SetIMUParamsConstant(const std::string &refIMUTopic);
@@ -132,6 +181,95 @@ protected:
                         const SplineMetaType &splineMeta,
                         bool setToConst);
 
+    // param blocks (pointers) of knots involved in the spline meta
+    template <class SplineType>
+    static void KnotsData(std::vector<double *> &paramBlockVec,
+                          const SplineType &spline,
+                          const SplineMetaType &splineMeta) {
+        // for each segment
+        for (const auto &seg : splineMeta.segments) {
+            // the factor 'seg.dt * 0.5' is the treatment for numerical accuracy
+            auto idxMaster = spline.ComputeTIndex(seg.t0 + seg.dt * 0.5).second;
+
+            // from the first control point to the last control point
+            for (std::size_t i = idxMaster; i < idxMaster + seg.NumParameters(); ++i) {
+                paramBlockVec.push_back(
+                    const_cast<double *>(spline.GetKnot(static_cast<int>(i)).data()));
+            }
+        }
+    }
+
+    /**
+     * commit descriptors to the problem in order, knots are registered once up front
+     * @return the number of committed (valid) residual blocks
+     */
+    std::size_t CommitResidualBlocks(const std::vector<ResidualBlockDesc> &descs,
+                                     bool so3KnotsConst,
+                                     bool scaleKnotsConst);
+
+    // measurements in the same knot span(s) of the given spline(s) are grouped in order
+    static std::vector<std::vector<IMUFrame::Ptr>> GroupByKnotSpan(
+        const std::vector<IMUFrame::Ptr> &imuFrames,
+        double TO_BiToBr,
+        const So3SplineType &so3Spline,
+        const PosSplineType *posSpline);
+
+    /**
+     * descriptors are created without touching the problem, so they are thread-safe. Invalid
+     * descriptors (null cost function) are returned for measurements out of the spline range
+     */
+    [[nodiscard]] ResidualBlockDesc IMUGyroMeasurementDesc(const So3SplineType &so3Spline,
+                                                           const IMUFrame::Ptr &imuFrame,
+                                                           const std::string &topic,
+                                                           Opt option,
+                                                           double gyroWeight) const;
+
+    [[nodiscard]] ResidualBlockDesc IMUGyroIntervalDesc(const So3SplineType &so3Spline,
+                                                        const std::vector<IMUFrame::Ptr> &imuFrames,
+                                                        const std::string &topic,
+                                                        double gyroWeight) const;
+
+    [[nodiscard]] ResidualBlockDesc IMUGyroResidualBlockDesc(ceres::DynamicCostFunction *costFunc,
+                                                             int numResiduals,
+                                                             const So3SplineType &so3Spline,
+                                                             const SplineMetaType &so3Meta,
+                                                             const std::string &topic) const;
+
+    [[nodiscard]] ResidualBlockDesc IMUAcceMeasurementDesc(const So3SplineType &so3Spline,
+                                                           const PosSplineType &posSpline,
+                                                           const IMUFrame::Ptr &imuFrame,
+                                                           const std::string &topic,
+                                                           Opt option,
+                                                           double acceWeight) const;
+
+    [[nodiscard]] ResidualBlockDesc IMUAcceIntervalDesc(const So3SplineType &so3Spline,
+                                                        const PosSplineType &posSpline,
+                                                        const std::vector<IMUFrame::Ptr> &imuFrames,
+                                                        const std::string &topic,
+                                                        double acceWeight) const;
+
+    [[nodiscard]] ResidualBlockDesc IMUAcceResidualBlockDesc(ceres::DynamicCostFunction *costFunc,
+                                                             int numResiduals,
+                                                             const So3SplineType &so3Spline,
+                                                             const PosSplineType &posSpline,
+                                                             const SplineMetaType &so3Meta,
+                                                             const SplineMetaType &scaleMeta,
+                                                             const std::string &topic) const;
+
+    [[nodiscard]] ResidualBlockDesc VisualProjectionDesc(const So3SplineType &so3Spline,
+                                                         const PosSplineType &posSpline,
+                                                         const std::string &camTopic,
+                                                         const VisualProjectionPair &pair,
+                                                         Opt option,
+                                                         double weight) const;
+
+    // manifolds, constant blocks and bounds of non-knot param blocks, set once after committing
+    void SetIMUGyroParamBlocks(const std::string &topic, Opt option);
+
+    void SetIMUAcceParamBlocks(const std::string &topic, Opt option);
+
+    void SetVisualProjectionParamBlocks(const std::string &camTopic, Opt option);
+
     static Eigen::MatrixXd CRSMatrix2EigenMatrix(const ceres::CRSMatrix *jacobian_crs_matrix);
 
     std::optional<std::pair<Eigen::Vector3d, Eigen::Matrix3d>> InertialVelIntegration(
@@ -149,23 +287,10 @@ protected:
                            double sTimeByBi,
                            double eTimeByBi) const;
 
-    std::pair<std::vector<std::pair<double, Eigen::Vector3d>>,
-              std::vector<std::pair<double, Eigen::Matrix3d>>>
-    InertialIntegrationBase(const So3SplineType &so3Spline,
-                            const std::vector<IMUFrame::Ptr> &data,
-                            const std::string &imuTopic,
-                            double sTimeByBi,
-                            double eTimeByBi) const;
-
-    static auto ExtractIMUDataPiece(const std::vector<IMUFrame::Ptr> &data, double st, double et) {
-        auto sIter = std::find_if(data.begin(), data.end(), [st](const IMUFrame::Ptr &frame) {
-            return frame->GetTimestamp() > st;
-        });
-        auto eIter = std::find_if(data.rbegin(), data.rend(), [et](const IMUFrame::Ptr &frame) {
-                         return frame->GetTimestamp() < et;
-                     }).base();
-        return std::pair(sIter, eIter);
-    }
+    const InertialIntegrationCachePtr &InertialIntegrationBase(
+        const So3SplineType &so3Spline,
+        const std::vector<IMUFrame::Ptr> &data,
+        const std::string &imuTopic) const;
 
 public:
     void AddIMUGyroMeasurement(const So3SplineType &so3Spline,
@@ -174,6 +299,17 @@ public:
                                Opt option,
                                double gyroWeight);
 
+    /**
+     * measurements in the same knot span share one residual block if the time offset is constant,
+     * otherwise they are added one by one, see 'AddIMUGyroMeasurement'. Residual blocks are
+     * created in parallel and committed in order
+     */
+    void AddIMUGyroMeasurements(const So3SplineType &so3Spline,
+                                const std::vector<IMUFrame::Ptr> &imuFrames,
+                                const std::string &topic,
+                                Opt option,
+                                double gyroWeight);
+
     void AddHandEyeRotAlignment(const So3SplineType &so3Spline,
                                 const std::string &camTopic,
                                 double tLastByCj,
@@ -229,6 +365,18 @@ public:
                                Opt option,
                                double acceWeight);
 
+    /**
+     * measurements in the same knot span share one residual block if the time offset is constant,
+     * otherwise they are added one by one, see 'AddIMUAcceMeasurement'. Residual blocks are
+     * created in parallel and committed in order
+     */
+    void AddIMUAcceMeasurements(const So3SplineType &so3Spline,
+                                const PosSplineType &posSpline,
+                                const std::vector<IMUFrame::Ptr> &imuFrames,
+                                const std::string &topic,
+                                Opt option,
+                                double acceWeight);
+
     void AddPositionConstraint(const PosSplineType &posSpline,
                                double timeByBr,
                                const Eigen::Vector3d &pos,
@@ -244,10 +392,21 @@ public:
     void AddVisualProjectionFactor(const So3SplineType &so3Spline,
                                    const PosSplineType &posSpline,
                                    const std::string &camTopic,
-                                   const VisualProjectionPairPtr &pair,
+                                   const VisualProjectionPair &pair,
                                    Opt option,
                                    double weight);
 
+    /**
+     * residual blocks are created in parallel and committed in order, the same as adding pairs
+     * one by one via 'AddVisualProjectionFactor'
+     */
+    void AddVisualProjectionFactors(const So3SplineType &so3Spline,
+                                    const PosSplineType &posSpline,
+                                    const std::string &camTopic,
+                                    const std::vector<VisualProjectionPair> &pairs,
+                                    Opt option,
+                                    double weight);
+
     void AddVisualDiscreteProjectionFactor(Sophus::SO3d *SO3_CjToW,
                                            Eigen::Vector3d *POS_CjInW,
                                            const std::string &camTopic,
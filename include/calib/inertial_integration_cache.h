@@ -0,0 +1,106 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef INERTIAL_INTEGRATION_CACHE_H
+#define INERTIAL_INTEGRATION_CACHE_H
+
+#include "config/configor.h"
+#include "ctraj/core/spline_bundle.h"
+#include "sensor/imu.hpp"
+#include "util/time_indexed.hpp"
+#include "optional"
+
+namespace ns_ekalibr {
+/**
+ * Spline states (rotation, angular velocity and acceleration) at the inertial measurements, which
+ * are evaluated once and turned into prefix sums of the trapezoidal integration, so that the
+ * (once and twice) integrated terms of the inertial alignment over any time window are obtained in
+ * O(1), rather than re-evaluating the spline at every measurement of overlapping windows.
+ */
+class InertialIntegrationCache {
+public:
+    using Ptr = std::shared_ptr<InertialIntegrationCache>;
+    using So3SplineType = ns_ctraj::So3Spline<Configor::Prior::SplineOrder>;
+    // the integrated 'SO3_BiToBr0 * acce' and '(SO3_ACCE_MAT + SO3_VEL_MAT^2) * SO3_BrToBr0'
+    using VecMat = std::pair<Eigen::Vector3d, Eigen::Matrix3d>;
+
+private:
+    // the spatiotemporal parameters that the cache is built with
+    double _TO_BiToBr;
+    Sophus::SO3d _SO3_BiToBr;
+
+    // measurements in the range of the spline, and their time index
+    std::vector<IMUFrame::Ptr> _frames;
+    TimeIndexed<IMUFrame>::Ptr _framesIndex;
+    // timestamps stamped by the reference imu
+    std::vector<double> _timesByBr;
+    // '_onceSum[k]': integration from the first measurement to the k-th one
+    std::vector<VecMat> _onceSum;
+    // '_twiceSum[k]': the weighted '_onceSum' from the first measurement to the k-th one, see
+    // 'PosIntegration' for details
+    std::vector<VecMat> _twiceSum;
+
+public:
+    InertialIntegrationCache(const So3SplineType &so3Spline,
+                             const std::vector<IMUFrame::Ptr> &data,
+                             double TO_BiToBr,
+                             const Sophus::SO3d &SO3_BiToBr);
+
+    static Ptr Create(const So3SplineType &so3Spline,
+                      const std::vector<IMUFrame::Ptr> &data,
+                      double TO_BiToBr,
+                      const Sophus::SO3d &SO3_BiToBr);
+
+    [[nodiscard]] bool IsBuiltWith(double TO_BiToBr, const Sophus::SO3d &SO3_BiToBr) const;
+
+    /**
+     * the same as 'TrapIntegrationOnce' on measurements in (sTimeByBi, eTimeByBi)
+     */
+    [[nodiscard]] std::optional<VecMat> VelIntegration(double sTimeByBi, double eTimeByBi) const;
+
+    /**
+     * the same as 'TrapIntegrationOnce' and 'TrapIntegrationTwice' on measurements in
+     * (sTimeByBi, eTimeByBi)
+     */
+    [[nodiscard]] std::optional<std::pair<VecMat, VecMat>> PosIntegration(double sTimeByBi,
+                                                                          double eTimeByBi) const;
+
+protected:
+    /**
+     * indices [i, j) of cached measurements in (sTimeByBi, eTimeByBi), at least two are required
+     */
+    [[nodiscard]] std::optional<std::pair<std::size_t, std::size_t>> Range(
+        double sTimeByBi, double eTimeByBi) const;
+
+    [[nodiscard]] double MidTime(std::size_t k) const {
+        return (_timesByBr[k] + _timesByBr[k + 1]) * 0.5;
+    }
+};
+}  // namespace ns_ekalibr
+
+#endif  // INERTIAL_INTEGRATION_CACHE_H
@@ -0,0 +1,121 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PATTERN_EVENTS_CACHE_H
+#define PATTERN_EVENTS_CACHE_H
+
+#include "memory"
+#include "vector"
+#include "map"
+#include "string"
+#include "cstdint"
+#include "fstream"
+
+namespace ns_ekalibr {
+struct TimeVaryingEllipse;
+using TimeVaryingEllipsePtr = std::shared_ptr<TimeVaryingEllipse>;
+class EventArray;
+using EventArrayPtr = std::shared_ptr<EventArray>;
+
+/**
+ * Compact chunked binary file of raw events of extracted grid patterns. The layout is:
+ * [header: magic, version, flags, time bias, grid count]
+ * [index table: grid id, chunk offset, chunk size, chunk checksum (crc32) for each grid]
+ * [chunks: circles of a grid, i.e., the time-varying ellipses and their raw events]
+ * Timestamps of events are stored as nanosecond ticks, which are delta encoded along with the
+ * coordinates and written as zigzag varints, the polarity is packed into the y delta. Each grid is
+ * stored in an independent chunk, so that grids can be loaded individually, hence raw events shared
+ * among grids are stored (and loaded) once per grid. The time bias is stored once in the header and
+ * applied when grids are decoded.
+ */
+class PatternEventsCache {
+public:
+    using Ptr = std::shared_ptr<PatternEventsCache>;
+    // for a tracked 2d grid pattern
+    using ExtractedCirclesVec = std::vector<std::pair<TimeVaryingEllipsePtr, EventArrayPtr>>;
+
+    struct ChunkIndex {
+        int gridId;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t checksum;
+    };
+
+private:
+    std::string _filename;
+    double _timeBias;
+    bool _checksum;
+    std::vector<ChunkIndex> _index;
+
+public:
+    PatternEventsCache(std::string filename,
+                       double timeBias,
+                       bool checksum,
+                       std::vector<ChunkIndex> index);
+
+    /**
+     * @brief read the header and the index table of a cache file, chunks are not loaded
+     * @return nullptr if the file can not be opened or is not a cache file of this format
+     */
+    static Ptr Open(const std::string& filename);
+
+    static bool IsCacheFile(const std::string& filename);
+
+    static bool Save(const std::map<int, ExtractedCirclesVec>& data,
+                     const std::string& filename,
+                     double timeBias,
+                     bool checksum = true);
+
+    [[nodiscard]] double GetTimeBias() const;
+
+    [[nodiscard]] std::vector<int> GridIds() const;
+
+    [[nodiscard]] const std::vector<ChunkIndex>& GetIndex() const;
+
+    /**
+     * @brief load grids given their ids, timestamps are shifted to the new time bias on decoding
+     * @param gridIds ids of grids to load, all grids are loaded if empty, unknown ids are ignored
+     */
+    [[nodiscard]] std::map<int, ExtractedCirclesVec> Load(
+        double newTimeBias, const std::vector<int>& gridIds = {}) const;
+
+    [[nodiscard]] ExtractedCirclesVec LoadGrid(int gridId, double newTimeBias) const;
+
+protected:
+    [[nodiscard]] std::string ReadChunk(std::ifstream& file, const ChunkIndex& chunk) const;
+
+    static std::string EncodeChunk(const ExtractedCirclesVec& circles);
+
+    [[nodiscard]] ExtractedCirclesVec DecodeChunk(const std::string& bytes,
+                                                  double newTimeBias) const;
+
+    static std::uint32_t CRC32(const char* data, std::size_t size);
+};
+}  // namespace ns_ekalibr
+
+#endif  // PATTERN_EVENTS_CACHE_H
@@ -143,6 +143,8 @@ public:
         static double GravityNorm;
         static double TimeOffsetPadding;
         static bool OptTemporalParams;
+        // rate (Hz) of inertial measurements used in batch optimizations, zero to use all of them
+        static double InertialSamplingRate;
 
         struct CirclePatternConfig {
         public:
@@ -168,18 +170,67 @@ public:
 
         static double DecayTimeOfActiveEvents;
 
+        struct ActiveEventWindowConfig {
+            // windows with fewer events than this are skipped, zero to disable the gating
+            int MinEventCount;
+            // window length is adapted to make such number of pixels active, zero to disable it
+            int TargetActivePixels;
+            // bounds of the adapted window length, as rates of 'DecayTimeOfActiveEvents'
+            double MinWindowRate;
+            double MaxWindowRate;
+
+            ActiveEventWindowConfig() = default;
+
+            template <class Archive>
+            void serialize(Archive &ar) {
+                ar(CEREAL_NVP(MinEventCount), CEREAL_NVP(TargetActivePixels),
+                   CEREAL_NVP(MinWindowRate), CEREAL_NVP(MaxWindowRate));
+            }
+        };
+
+        static ActiveEventWindowConfig ActiveEventWindow;
+
+        struct EventDenoiserConfig {
+            // time window (s) of neighborhood support of background activity filter
+            double BackgroundActivityWindow;
+            // events (s) within this period after the last one at the same pixel are removed
+            double RefractoryPeriod;
+            // robust sigma count of the event rate over which a pixel is hot
+            double HotPixelSigma;
+
+            EventDenoiserConfig() = default;
+
+            template <class Archive>
+            void serialize(Archive &ar) {
+                ar(CEREAL_NVP(BackgroundActivityWindow), CEREAL_NVP(RefractoryPeriod),
+                   CEREAL_NVP(HotPixelSigma));
+            }
+        };
+
+        static EventDenoiserConfig EventDenoiser;
+
         struct CircleExtractorConfig {
             double ValidClusterAreaThd;
             double CircleClusterPairDirThd;
             double PointToCircleDistThd;
             int ClusterDilateSize;
+            // levels of the time-surface pyramid for coarse detection, zero to disable it
+            int PyramidLevels;
+            // tolerance (pixels) between grid centers from coarse and full-resolution levels
+            double PyramidCenterTolerance;
+            // extra padding (pixels) of the grid region predicted from last detections for tracking
+            double TrackingROIPadding;
+            // windows between two full-frame scans while tracking, zero to disable the prediction
+            int TrackingFullScanInterval;
 
             CircleExtractorConfig() = default;
 
             template <class Archive>
             void serialize(Archive &ar) {
                 ar(CEREAL_NVP(ValidClusterAreaThd), CEREAL_NVP(CircleClusterPairDirThd),
-                   CEREAL_NVP(PointToCircleDistThd), CEREAL_NVP(ClusterDilateSize));
+                   CEREAL_NVP(PointToCircleDistThd), CEREAL_NVP(ClusterDilateSize),
+                   CEREAL_NVP(PyramidLevels), CEREAL_NVP(PyramidCenterTolerance),
+                   CEREAL_NVP(TrackingROIPadding), CEREAL_NVP(TrackingFullScanInterval));
             }
         };
 
@@ -202,6 +253,97 @@ public:
 
         static NormFlowEstimatorConfig NormFlowEstimator;
 
+        struct AsyncProjectionPairsConfig {
+            // the (densest) sampling interval (s) of time-varying circles
+            double MinSamplingInterval;
+            // circles are sampled every such pixels they move, zero to sample them uniformly
+            double PixelsPerSample;
+            // budget of the pair count of each camera, zero for no budget
+            int MaxPairCount;
+
+            AsyncProjectionPairsConfig() = default;
+
+            template <class Archive>
+            void serialize(Archive &ar) {
+                ar(CEREAL_NVP(MinSamplingInterval), CEREAL_NVP(PixelsPerSample),
+                   CEREAL_NVP(MaxPairCount));
+            }
+        };
+
+        static AsyncProjectionPairsConfig AsyncProjectionPairs;
+
+        struct PartitionedSolverConfig {
+            // outer iterations of the partitioned solving of spline segments, zero to disable it
+            int MaxIterations;
+            // the partitioned solving stops once the relative cost decrease is below this value
+            double CostTolerance;
+            // max iterations of the joint polish after the partitioned solving
+            int PolishIterations;
+
+            PartitionedSolverConfig() = default;
+
+            template <class Archive>
+            void serialize(Archive &ar) {
+                ar(CEREAL_NVP(MaxIterations), CEREAL_NVP(CostTolerance),
+                   CEREAL_NVP(PolishIterations));
+            }
+        };
+
+        static PartitionedSolverConfig PartitionedSolver;
+
+        struct AdaptiveKnotsConfig {
+            // knot distances are enlarged at most by '2^MaxLevel' times, zero to disable it
+            int MaxLevel;
+            // tolerances of the increase of the fitting error of angular velocities (rad/s) and
+            // accelerations (m/s^2) when enlarging the knot distance
+            double GyroFitTolerance;
+            double AcceFitTolerance;
+
+            AdaptiveKnotsConfig() = default;
+
+            template <class Archive>
+            void serialize(Archive &ar) {
+                ar(CEREAL_NVP(MaxLevel), CEREAL_NVP(GyroFitTolerance),
+                   CEREAL_NVP(AcceFitTolerance));
+            }
+        };
+
+        static AdaptiveKnotsConfig AdaptiveKnots;
+
+        struct MultiResolutionInitConfig {
+            // splines are initialized at '2^Levels', ..., 2 times of knot distances first, and then
+            // refined by knot insertion, zero to fit them directly at their knot distances
+            int Levels;
+            // max iterations of the fitting at the final level
+            int PolishIterations;
+
+            MultiResolutionInitConfig() = default;
+
+            template <class Archive>
+            void serialize(Archive &ar) {
+                ar(CEREAL_NVP(Levels), CEREAL_NVP(PolishIterations));
+            }
+        };
+
+        static MultiResolutionInitConfig MultiResolutionInit;
+
+        struct InformativeSegmentsConfig {
+            // valid time segments are split into windows of (at least) this length, unit: sec
+            double WindowLength;
+            // rate of the time of the selected windows to the total time of valid segments, one to
+            // keep all data, i.e., disable the selection
+            double BudgetRatio;
+
+            InformativeSegmentsConfig() = default;
+
+            template <class Archive>
+            void serialize(Archive &ar) {
+                ar(CEREAL_NVP(WindowLength), CEREAL_NVP(BudgetRatio));
+            }
+        };
+
+        static InformativeSegmentsConfig InformativeSegments;
+
         struct KnotTimeDistConfig {
             double So3Spline;
             double ScaleSpline;
@@ -222,8 +364,12 @@ public:
         void serialize(Archive &ar) {
             ar(CEREAL_NVP(SpatTempPrioriPath), CEREAL_NVP(GravityNorm),
                CEREAL_NVP(TimeOffsetPadding), CEREAL_NVP(OptTemporalParams),
-               CEREAL_NVP(CirclePattern), CEREAL_NVP(DecayTimeOfActiveEvents),
-               CEREAL_NVP(CircleExtractor), CEREAL_NVP(NormFlowEstimator));
+               CEREAL_NVP(InertialSamplingRate), CEREAL_NVP(CirclePattern),
+               CEREAL_NVP(DecayTimeOfActiveEvents), CEREAL_NVP(ActiveEventWindow),
+               CEREAL_NVP(EventDenoiser), CEREAL_NVP(CircleExtractor),
+               CEREAL_NVP(NormFlowEstimator), CEREAL_NVP(AsyncProjectionPairs),
+               CEREAL_NVP(PartitionedSolver), CEREAL_NVP(AdaptiveKnots),
+               CEREAL_NVP(MultiResolutionInit), CEREAL_NVP(InformativeSegments));
         }
     } prior;
 
@@ -59,6 +59,8 @@ public:
     using Ptr = std::shared_ptr<EventCircleExtractor>;
 
     constexpr static double DEG2RAD = M_PI / 180.0;
+    // the gate (relative to the estimated circle spacing) to associate grid centers to circles
+    constexpr static double GRID_MATCH_GATE_RATIO = 0.5;
 
     enum class CircleClusterType : int { CHASE = 0, RUN = 1, OTHER = 2 };
 
@@ -128,8 +130,10 @@ public:
 
     void InitMatsForVisualization(const EventNormFlow::NormFlowPack::Ptr& nfPack);
 
+    // 'decay' no larger than zero means 'Configor::Prior::DecayTimeOfActiveEvents'
     static cv::Mat CreateSAE(const std::string& topic,
-                             const ExtractedCirclesVec& tvCirclesWithRawEvs);
+                             const ExtractedCirclesVec& tvCirclesWithRawEvs,
+                             double decay = -1.0);
 
     static cv::Mat CreateSAEWithTVEllipses(const std::string& topic,
                                            const ExtractedCirclesVec& tvCirclesWithRawEvs,
@@ -144,6 +148,33 @@ public:
     [[nodiscard]] cv::Mat SAEMapExtractCircles() const { return imgExtractCircles; }
     [[nodiscard]] cv::Mat SAEMapExtractCirclesGrid() const { return imgExtractCirclesGrid; }
 
+    /**
+     * regions of interest at full resolution around circles extracted on a time-surface pyramid
+     * level downsampled by 'scale', i.e., bounding boxes of their events expanded by 'margin'
+     */
+    static std::vector<cv::Rect> CircleROIs(const ExtractedCirclesVec& circles,
+                                            int scale,
+                                            int margin,
+                                            const cv::Size& imgSize);
+
+    /**
+     * whether events of all circles keep at least 'margin' pixels away from the borders of 'roi',
+     * i.e., no circle is clipped by the region. Borders lying on the image border are not checked
+     */
+    static bool CirclesInsideROI(const ExtractedCirclesVec& circles,
+                                 const cv::Rect& roi,
+                                 int margin,
+                                 const cv::Size& imgSize);
+
+    /**
+     * whether grid centers extracted at full resolution agree with the ones extracted on a
+     * pyramid level downsampled by 'scale', within 'tolerance' pixels
+     */
+    static bool CentersAgree(const std::vector<cv::Point2f>& centers,
+                             const std::vector<cv::Point2f>& coarseCenters,
+                             int scale,
+                             double tolerance);
+
     static TimeVaryingEllipsePtr RefineTimeVaryingCircleToEllipse(const TimeVaryingEllipsePtr& c,
                                                                   const EventArrayPtr& ary,
                                                                   double avgDistThd);
@@ -155,6 +186,14 @@ protected:
         double DIR_DIFF_DEG_THD,
         int CLUSTER_DILATE_SIZE);
 
+    /**
+     * estimate the distance (pixels) between neighboring circles of a found grid, which is used to
+     * size the spatial hash and derive the distance gate for center association
+     */
+    static double EstimateGridSpacing(const std::vector<cv::Point2f>& centers,
+                                      const cv::Size& gridSize,
+                                      CirclePatternType circlePatternType);
+
     static TimeVaryingEllipsePtr FitTimeVaryingCircle(const EventArrayPtr& ary1,
                                                       const EventArrayPtr& ary2,
                                                       double avgDistThd);
@@ -57,18 +57,25 @@ struct CircleGrid2D {
     std::vector<cv::Point2f> centers;
     std::vector<uint8_t> cenValidity;
     bool isComplete;
+    /**
+     * length (s) of the event window the grid is extracted from, zero if unknown. It is not
+     * serialized, loaded grids fall back to 'Configor::Prior::DecayTimeOfActiveEvents'
+     */
+    double window;
 
     CircleGrid2D(int id = -1,
                  double timestamp = 0.0,
                  const std::vector<cv::Point2f>& centers = {},
                  const std::vector<uint8_t>& cenValidity = {},
-                 bool isComplete = false);
+                 bool isComplete = false,
+                 double window = 0.0);
 
     static Ptr Create(int id,
                       double timestamp,
                       const std::vector<cv::Point2f>& centers,
                       const std::vector<uint8_t>& cenValidity,
-                      bool isComplete);
+                      bool isComplete,
+                      double window = 0.0);
 
     void DrawCenters(cv::Mat& img, cv::Size patternSize) const;
 
@@ -0,0 +1,107 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef EVENT_DENOISER_H
+#define EVENT_DENOISER_H
+
+#include "memory"
+#include "vector"
+#include "cstdint"
+#include "string"
+
+namespace ns_ekalibr {
+
+struct EventArray;
+using EventArrayPtr = std::shared_ptr<EventArray>;
+
+/**
+ * Removes noise events before the tracking stages, in a single pass over the temporally ordered
+ * events with per-pixel timestamp buffers:
+ *  (1) hot pixels, whose event rates are outliers among all pixels of the stream;
+ *  (2) events within the refractory period of the last accepted one at the same pixel;
+ *  (3) background activity, i.e., events without any event in the 8-neighborhood recently.
+ * Each filter is disabled by a non-positive parameter.
+ */
+class EventDenoiser {
+public:
+    using Ptr = std::shared_ptr<EventDenoiser>;
+
+    struct Statistics {
+        std::size_t total = 0;
+        std::size_t hotPixel = 0;
+        std::size_t refractory = 0;
+        std::size_t backgroundActivity = 0;
+        // number of pixels identified as hot ones
+        std::size_t hotPixelCount = 0;
+
+        [[nodiscard]] std::size_t Removed() const;
+
+        [[nodiscard]] std::string InfoString() const;
+    };
+
+private:
+    const int w, h;
+    // time window (s) of the neighborhood support for background activity filter
+    const double BA_WINDOW;
+    const double REFRACTORY_PERIOD;
+    // a pixel is hot if its log event count exceeds the median by such times the robust sigma
+    const double HOT_PIXEL_SIGMA;
+
+    // buffers are padded by one pixel on each side, so that neighbors need no bound checks
+    std::vector<double> _lastStamp;
+    std::vector<double> _lastAccepted;
+    std::vector<std::uint8_t> _isHot;
+
+    Statistics _stats;
+
+public:
+    EventDenoiser(int w, int h, double baWindow, double refractoryPeriod, double hotPixelSigma);
+
+    static Ptr Create(int w,
+                      int h,
+                      double baWindow,
+                      double refractoryPeriod,
+                      double hotPixelSigma);
+
+    // identify hot pixels from the per-pixel event counts of the whole stream
+    void DetectHotPixels(const std::vector<EventArrayPtr>& arrays);
+
+    /**
+     * @brief filter event arrays, which should be temporally ordered and follow the ones filtered
+     * before. Arrays keep their timestamps even if all their events are removed
+     */
+    std::vector<EventArrayPtr> Filter(const std::vector<EventArrayPtr>& arrays);
+
+    [[nodiscard]] const Statistics& GetStatistics() const;
+
+protected:
+    [[nodiscard]] int PaddedIndex(int x, int y) const { return (y + 1) * (w + 2) + (x + 1); }
+};
+}  // namespace ns_ekalibr
+
+#endif  // EVENT_DENOISER_H
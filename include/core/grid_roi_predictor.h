@@ -0,0 +1,86 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef GRID_ROI_PREDICTOR_H
+#define GRID_ROI_PREDICTOR_H
+
+#include "opencv4/opencv2/core/types.hpp"
+#include "memory"
+#include "deque"
+#include "optional"
+
+namespace ns_ekalibr {
+
+struct CircleGrid2D;
+using CircleGrid2DPtr = std::shared_ptr<CircleGrid2D>;
+
+/**
+ * Predicts the image region of the next grid pattern during continuous tracking. The bounding
+ * boxes of the centers of the last three complete grids are extrapolated to the query time using
+ * lagrange polynomials, the predicted box is merged with the last one and then padded by: (1) the
+ * center spacing of the last grid, which bounds the circle radius, (2) the margin required by the
+ * norm flow estimation and cluster dilation, (3) the extrapolated motion, and (4) an extra padding.
+ * No region is predicted (i.e., a full-frame scan is expected) if the grid is lost, or periodically
+ * every 'fullScanInterval' windows.
+ */
+class GridROIPredictor {
+public:
+    using Ptr = std::shared_ptr<GridROIPredictor>;
+
+private:
+    cv::Size _imgSize;
+    int _margin;
+    double _padding;
+    int _fullScanInterval;
+    // timestamp, bounding box of grid centers
+    std::deque<std::pair<double, cv::Rect2d>> _history;
+    // the largest distance from a center to its nearest neighbor in the last grid
+    double _spacing;
+    int _windowsSinceFullScan;
+
+public:
+    /**
+     * @param margin pixels required around circles to estimate norm flows and dilate clusters
+     * @param padding extra padding (pixels) of the predicted region
+     */
+    GridROIPredictor(const cv::Size& imgSize, int margin, double padding, int fullScanInterval);
+
+    static Ptr Create(const cv::Size& imgSize, int margin, double padding, int fullScanInterval);
+
+    /**
+     * @brief predict the region of the grid pattern at time 't', to be called once per window
+     * @return the predicted region, 'std::nullopt' means a full-frame scan is expected
+     */
+    std::optional<cv::Rect> Predict(double t);
+
+    // feed the grid extracted in current window, incomplete ones reset the history
+    void Update(const CircleGrid2DPtr& grid);
+};
+}  // namespace ns_ekalibr
+
+#endif  // GRID_ROI_PREDICTOR_H
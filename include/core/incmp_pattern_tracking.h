@@ -41,6 +41,7 @@ struct TimeVaryingEllipse;
 using TimeVaryingEllipsePtr = std::shared_ptr<TimeVaryingEllipse>;
 struct EventArray;
 using EventArrayPtr = std::shared_ptr<EventArray>;
+class SpatialGridHash;
 
 struct InCmpPatternTracker {
     // for a tracked 2d grid pattern
@@ -75,6 +76,7 @@ protected:
         const CircleGrid2DPtr& grid2,
         const CircleGrid2DPtr& grid3,
         const CircleGrid2DPtr& gridToTrack,
+        const SpatialGridHash& cenIndex,
         const std::map<int, ExtractedCirclesVec>& tvCirclesWithRawEvs) const;
 
     static void DrawTrace(cv::Mat& img,
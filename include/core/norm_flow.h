@@ -34,12 +34,15 @@
 #include "opengv/sac/SampleConsensusProblem.hpp"
 #include "map"
 #include "list"
+#include "array"
 
 namespace ns_ekalibr {
 struct Event;
 using EventPtr = std::shared_ptr<Event>;
 class ActiveEventSurface;
 using ActiveEventSurfacePtr = std::shared_ptr<ActiveEventSurface>;
+class EventSerialIndex;
+using EventSerialIndexPtr = std::shared_ptr<EventSerialIndex>;
 
 struct NormFlow {
 public:
@@ -73,6 +76,11 @@ public:
         cv::Mat polarityMap;        // the polarity map
         double timestamp;
 
+        // serials of the source events of inlier pixels ('y * cols + x'), -1 for other pixels
+        std::vector<std::int64_t> sourceSerials;
+        // events addressed by 'sourceSerials', if not set, events of inliers are created anew
+        EventSerialIndexPtr eventSource = nullptr;
+
         // for visualization
         cv::Mat nfSeedsImg;  // CV_8UC3
         cv::Mat nfsImg;      // CV_8UC3
@@ -106,18 +114,63 @@ private:
 public:
     explicit EventNormFlow(const ActiveEventSurfacePtr &sea);
 
+    /**
+     * @param rois if not empty, only pixels in these regions of interest are involved
+     */
     NormFlowPack::Ptr ExtractNormFlows(double decaySec = 0.02,
                                        int winSize = 2,
                                        int neighborDist = 2,
                                        double goodRatioThd = 0.9,
                                        double timeDistEventToPlaneThd = 2E-3,
-                                       int ransacMaxIter = 3) const;
+                                       int ransacMaxIter = 3,
+                                       const std::vector<cv::Rect> &rois = {}) const;
 
 protected:
     static std::vector<std::tuple<double, double, double>> Centralization(
         const std::vector<std::tuple<int, int, double>> &inRangeData);
 };
 
+/**
+ * summed-area tables of the moments (1, x, y, x^2, xy, y^2, t, xt, yt, t^2) of the masked raw time
+ * surface in a region of interest, so that the least-squares local plane of any window, and its
+ * residual, are obtained in O(1) regardless of the window size
+ */
+class EventLocalPlaneIntegral {
+public:
+    using Ptr = std::shared_ptr<EventLocalPlaneIntegral>;
+
+    enum Moment { N = 0, X, Y, XX, XY, YY, T, XT, YT, TT, MOMENT_COUNT };
+
+private:
+    cv::Rect _roi;
+    // coordinates and timestamps are relative to the roi origin and '_timeRef' for precision
+    double _timeRef;
+    // (rows + 1) x (cols + 1) tables, moments of a cell are stored contiguously
+    std::vector<std::array<double, MOMENT_COUNT>> _sat;
+
+public:
+    EventLocalPlaneIntegral(const cv::Mat &rtsMat,
+                            const cv::Mat &mask,
+                            const cv::Rect &roi,
+                            double timeRef);
+
+    static Ptr Create(const cv::Mat &rtsMat,
+                      const cv::Mat &mask,
+                      const cv::Rect &roi,
+                      double timeRef);
+
+    /**
+     * fit the local plane of masked pixels in the window centered at (x, y) with half size 'ws'.
+     * Succeeds only if the sum of squared temporal residuals is within 'timeDistThd^2', i.e., every
+     * pixel lies within 'timeDistThd' to the plane and is an inlier of the robust estimation.
+     * @param abc the plane 't = -(A * x + B * y + C)' in coordinates centered at the mean
+     */
+    bool FitPlane(int x, int y, int ws, double timeDistThd, Eigen::Vector3d &abc) const;
+
+protected:
+    [[nodiscard]] std::array<double, MOMENT_COUNT> WindowSum(int x0, int y0, int x1, int y1) const;
+};
+
 class EventLocalPlaneSacProblem : public opengv::sac::SampleConsensusProblem<Eigen::Vector3d> {
 public:
     typedef Eigen::Vector3d model_t;
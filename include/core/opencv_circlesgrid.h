@@ -76,6 +76,14 @@ struct CV_EXPORTS_W_SIMPLE CirclesGridFinderParameters {
         squareSize;  //!< Distance between two adjacent points. Used by CALIB_CB_CLUSTERING.
     CV_PROP_RW float
         maxRectifiedDistance;  //!< Max deviation from prediction. Used by CALIB_CB_CLUSTERING.
+    CV_PROP_RW float
+        candidatePruningFactor;  //!< Candidates whose nearest neighbor is farther than this factor
+                                 //!< times the median neighbor spacing are dropped before graph
+                                 //!< construction. Non-positive values disable the pruning.
+    CV_PROP_RW float
+        pathLengthBoundFactor;  //!< Shortest paths in basis graphs are searched up to this factor
+                                //!< times the larger grid dimension (edges). Non-positive values
+                                //!< disable the bound.
 };
 
 class Graph {
@@ -95,7 +103,13 @@ public:
     size_t getVerticesCount() const;
     size_t getDegree(size_t id) const;
     const Neighbors &getNeighbors(size_t id) const;
-    void floydWarshall(cv::Mat &distanceMatrix, int infinity = -1) const;
+    // all-pairs shortest paths by breadth-first search over the adjacency lists, i.e., O(V * E)
+    // instead of O(V^3) of the Floyd-Warshall algorithm, unreachable pairs are set to 'infinity'.
+    // If 'maxDistance' is non-negative, the search from each vertex stops at this depth, and
+    // farther pairs are set to 'infinity' as well.
+    void allPairsShortestPaths(cv::Mat &distanceMatrix,
+                               int infinity = -1,
+                               int maxDistance = -1) const;
 
 private:
     Vertices vertices;
@@ -29,8 +29,9 @@
 #ifndef SAE_H
 #define SAE_H
 
-#include "Eigen/Dense"
 #include "opencv4/opencv2/core.hpp"
+#include "limits"
+#include "cstdint"
 
 namespace ns_ekalibr {
 struct Event;
@@ -42,34 +43,237 @@ class ActiveEventSurface {
 public:
     using Ptr = std::shared_ptr<ActiveEventSurface>;
 
+    // resolution of stored timestamps, i.e., one tick is a microsecond
+    constexpr static double TICK = 1E-6;
+    // ticks are kept in [-TICK_RANGE, TICK_RANGE] around the time base by rebasing
+    constexpr static std::int32_t TICK_RANGE = 1 << 30;
+    // never-updated cells
+    constexpr static std::int32_t NO_STAMP = std::numeric_limits<std::int32_t>::min();
+    // max number of events ingested as a run in 'GrabEvents'
+    constexpr static int RUN_CAPACITY = 1024;
+
+    /**
+     * surfaces of a window, rendered in a single pass by 'RenderWindow'
+     */
+    struct WindowSurface {
+        // CV_8UC1, 255 for pixels updated in [sinceTime, timeLatest], reused across windows
+        cv::Mat mask;
+        // CV_8UC1, the decayed surface ignoring polarities, reused across windows
+        cv::Mat decayImg;
+        // CV_64FC1 and CV_8UC1, of masked pixels, newly allocated as they outlive the window
+        cv::Mat rawTimeSurface;
+        cv::Mat polarityMap;
+        // linear indices of masked pixels in raster order
+        std::vector<int> pixels;
+    };
+
 private:
     const double FILTER_THD;
+    const std::int64_t FILTER_THD_TICKS;
     int w, h;
 
-    Eigen::MatrixXd _sae[2];        // save sae
-    Eigen::MatrixXd _saeLatest[2];  // save previous sae
+    /**
+     * surfaces are stored row-major (the same as 'cv::Mat', index 'y * w + x'), as int32 tick
+     * offsets with respect to '_timeBase' (CV_32SC1), which halves the memory of double stamps
+     */
+    cv::Mat _sae[2];        // save sae
+    cv::Mat _saeLatest[2];  // save previous sae
+    double _timeBase;
+    bool _hasTimeBase;
     double _timeLatest;
+    std::int32_t _tickLatest;
+
+    /**
+     * serials of ingested events (i.e., their order of ingestion from zero), and the serial of the
+     * event each stamp in '_sae' comes from, so that consumers can refer to the source events
+     * instead of copying them
+     */
+    std::int64_t _eventSerial;
+    std::vector<std::int64_t> _saeSource[2];
+
+    /**
+     * the sparse set of active pixels, i.e., pixels whose surface has been updated within the
+     * retention horizon '_activeRetention', stored as linear indices 'y * w + x'. Pixels older than
+     * the horizon are lazily dropped from the compact list, so that window-local consumers only
+     * visit pixels that can actually be in range instead of traversing the whole frame
+     */
+    double _activeRetention;
+    std::vector<bool> _isActive;     // per-pixel bitset, whether it is in '_activePixels'
+    std::vector<int> _activePixels;  // compact list of active pixels, not ordered
+    std::vector<int> _activeInRow;   // number of active pixels in each row
+    std::size_t _activeSizeAfterCompact;
 
     cv::Mat _accEventImg;
 
+    // reusable buffers for the sparse decay rendering
+    std::vector<std::int32_t> _gatherBuf;
+    std::vector<uchar> _decayBuf;
+
+    /**
+     * a run of events in batched ingestion for one polarity, stored as structure of arrays. Pixels
+     * in a run are distinct, thus the cells can be gathered, checked and scattered independently
+     */
+    struct EventRun {
+        std::vector<int> idx;
+        std::vector<std::int32_t> tick;
+        std::vector<std::int64_t> serial;
+        std::vector<std::int32_t> tLast;
+        std::vector<std::int32_t> tLastInv;
+        std::vector<uchar> keep;
+
+        void Clear();
+
+        void Push(int pixelIdx, std::int32_t eventTick, std::int64_t eventSerial);
+    };
+
+    WindowSurface _window;
+    // per-row scratch of masked pixels in 'RenderWindow'
+    std::vector<std::vector<int>> _rowPixels;
+
+    EventRun _runs[2];
+    // per-pixel serial of the last run touching it, to detect repeated pixels in a run
+    std::vector<std::uint32_t> _runMark;
+    std::uint32_t _runSerial;
+
 public:
-    explicit ActiveEventSurface(int w, int h, double filterThd = 0.01);
+    /**
+     * @param activeRetention pixels not updated in the last 'activeRetention' seconds are dropped
+     * from the active-pixel set, queries beyond this horizon fall back to full-frame traversal
+     */
+    explicit ActiveEventSurface(int w,
+                                int h,
+                                double filterThd = 0.01,
+                                double activeRetention = std::numeric_limits<double>::max());
 
-    static Ptr Create(int w, int h, double filterThd = 0.01);
+    static Ptr Create(int w,
+                      int h,
+                      double filterThd = 0.01,
+                      double activeRetention = std::numeric_limits<double>::max());
 
     void GrabEvent(const EventPtr &event, bool drawEventMat = false);
 
     void GrabEvent(const EventArrayPtr &events, bool drawAccumulatedEventMat = false);
 
+    /**
+     * ingest 'events' from index 'begin' in batch, until (inclusive) the first event whose
+     * timestamp reaches 'timeEnd', i.e., the boundary of the current window. Equivalent to calling
+     * 'GrabEvent' for each of them.
+     * @return the index of the first event not ingested
+     */
+    std::size_t GrabEvents(const std::vector<EventPtr> &events,
+                           std::size_t begin,
+                           double timeEnd = std::numeric_limits<double>::max(),
+                           bool drawEventMat = false);
+
     [[nodiscard]] cv::Mat GetAccumulatedEventImg(bool resetMat);
 
     cv::Mat DecayTimeSurface(bool ignorePolarity = false,
                              int medianBlurKernelSize = 0,
                              double decaySec = 0.02);
 
-    std::pair<cv::Mat, cv::Mat> RawTimeSurface(bool ignorePolarity = false);
+    /**
+     * render the decayed surface into 'timeSurfaceMap' (CV_8UC1), whose memory is reused if it is
+     * already allocated with the right size and type
+     */
+    void DecayTimeSurface(cv::Mat &timeSurfaceMap,
+                          bool ignorePolarity = false,
+                          int medianBlurKernelSize = 0,
+                          double decaySec = 0.02);
+
+    /**
+     * pixels whose most recent timestamp is earlier than 'sinceTime' are left zero
+     */
+    std::pair<cv::Mat, cv::Mat> RawTimeSurface(bool ignorePolarity = false,
+                                               double sinceTime = -1.0);
+
+    void RawTimeSurface(cv::Mat &timeSurfaceMap,
+                        cv::Mat &polarityMap,
+                        bool ignorePolarity = false,
+                        double sinceTime = -1.0);
+
+    /**
+     * render the mask, raw time surface, polarity map and (optionally) decayed surface of the
+     * window [sinceTime, timeLatest] in a single row-parallel traversal. Rows without active
+     * pixels are only cleared. The returned reference is valid until the next call
+     */
+    const WindowSurface &RenderWindow(double sinceTime, double decaySec, bool renderDecay = true);
+
+    /**
+     * the surface downsampled by 'factor', where a coarse cell holds the most recent timestamps
+     * (max pooling) of the 'factor x factor' pixels it covers. Only active pixels are pooled
+     */
+    [[nodiscard]] Ptr Downsample(int factor) const;
+
+    /**
+     * successive 2x downsampled surfaces, i.e., 2x, 4x, ..., (2^levels)x
+     */
+    [[nodiscard]] std::vector<Ptr> Pyramid(int levels) const;
+
+    /**
+     * linear indices ('y * w + x') of pixels updated since 'sinceTime', in raster order
+     */
+    [[nodiscard]] std::vector<int> ActivePixels(double sinceTime) const;
+
+    /**
+     * the serial (order of ingestion from zero) of the event the most recent stamp at pixel 'idx'
+     * comes from, -1 if there is none. Surfaces from 'Downsample' have no source events
+     */
+    [[nodiscard]] std::int64_t SourceSerialAt(int idx) const;
+
+    /**
+     * the time span back from the latest event in which 'count' pixels are updated, clamped to
+     * ['minSpan', 'maxSpan'], i.e., 'maxSpan' is returned if fewer pixels are updated within it
+     */
+    [[nodiscard]] double SpanOfRecentPixels(std::size_t count,
+                                            double minSpan,
+                                            double maxSpan) const;
 
     [[nodiscard]] double GetTimeLatest() const;
+
+    [[nodiscard]] cv::Size GetSize() const;
+
+    /**
+     * the age beyond which an exponential-decayed stamp is rounded to zero in an 8-bit image
+     */
+    static double DecayTimeSurfaceCutoff(double decaySec);
+
+protected:
+    [[nodiscard]] double MostRecentStampAt(int idx) const;
+
+    [[nodiscard]] std::int32_t MostRecentTickAt(int idx) const;
+
+    [[nodiscard]] double TickToTime(std::int32_t tick) const;
+
+    [[nodiscard]] std::int32_t TimeToTick(double time);
+
+    void Rebase(double timeBase);
+
+    /**
+     * e^{-x} for 'x' in [0, 87], evaluated as 2^{-x log2(e)}, where the fractional power is
+     * approximated by a polynomial, the relative error is below 5E-6 (far less than one
+     * intensity level in 8-bit images). Branch-free, so that loops calling it are vectorized
+     */
+    static float ExpNegApprox(float x);
+
+    /**
+     * render a contiguous run of cells to CV_8U, i.e., '255 * exp(-age * tickToX)', or
+     * '255 * (±exp(-age * tickToX) + 1) / 2' signed by the polarity if it is not ignored
+     */
+    static void DecayTicksTo8U(const std::int32_t *ticks0,
+                               const std::int32_t *ticks1,
+                               bool ignorePolarity,
+                               std::int32_t tickLatest,
+                               float tickToX,
+                               uchar *out,
+                               int n);
+
+    [[nodiscard]] bool ActivePixelsCover(double sinceTime) const;
+
+    void CompactActivePixels();
+
+    void IngestRuns(bool drawEventMat);
+
+    void MarkActive(int idx);
 };
 }  // namespace ns_ekalibr
 
@@ -0,0 +1,115 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include "opencv4/opencv2/core/types.hpp"
+#include "unordered_map"
+#include "optional"
+#include "memory"
+#include "vector"
+#include "cmath"
+#include "cstdint"
+
+namespace ns_ekalibr {
+
+/**
+ * A uniform grid hash over a set of 2d points. The cell size is expected to be in the same order
+ * as the typical distance between points (e.g., the circle spacing of a grid pattern), so that a
+ * nearest or radius query only touches a handful of cells. Point indices are stored contiguously
+ * in cell order, each occupied cell only keeps a range into this index buffer.
+ */
+class SpatialGridHash {
+public:
+    using Ptr = std::shared_ptr<SpatialGridHash>;
+
+private:
+    double _cellSize;
+    double _cellSizeInv;
+    std::vector<cv::Point2f> _points;
+    // point indices sorted by cell
+    std::vector<int> _indices;
+    // cell key -> [begin, end) range in '_indices'
+    std::unordered_map<std::int64_t, std::pair<int, int>> _cells;
+
+public:
+    SpatialGridHash(const std::vector<cv::Point2f>& points, double cellSize);
+
+    static Ptr Create(const std::vector<cv::Point2f>& points, double cellSize);
+
+    /**
+     * @brief find the nearest point whose distance to the query point is less than 'maxDist'
+     * @return the index of the nearest point and the corresponding distance (pixels)
+     */
+    [[nodiscard]] std::optional<std::pair<int, double>> Nearest(const cv::Point2f& p,
+                                                                double maxDist) const;
+
+    // indices of all points whose distance to the query point is less than 'radius'
+    [[nodiscard]] std::vector<int> Radius(const cv::Point2f& p, double radius) const;
+
+    /**
+     * @brief associate the points in 'src' to the points in 'dst', only the mutual nearest pairs
+     * whose distance is less than 'gate' are kept
+     * @return the index in 'dst' of each point in 'src', -1 means no association
+     */
+    static std::vector<int> MutualNearestMatch(const SpatialGridHash& src,
+                                               const SpatialGridHash& dst,
+                                               double gate);
+
+    [[nodiscard]] const std::vector<cv::Point2f>& GetPoints() const;
+
+    [[nodiscard]] double GetCellSize() const;
+
+    [[nodiscard]] std::size_t Size() const;
+
+protected:
+    [[nodiscard]] std::pair<int, int> CellCoord(const cv::Point2f& p) const;
+
+    static std::int64_t CellKey(int cx, int cy);
+
+    template <typename Func>
+    void ForEachInRange(const cv::Point2f& p, double radius, Func&& func) const {
+        const int reach = static_cast<int>(std::ceil(radius * _cellSizeInv));
+        const auto [cx, cy] = CellCoord(p);
+        for (int y = cy - reach; y <= cy + reach; ++y) {
+            for (int x = cx - reach; x <= cx + reach; ++x) {
+                auto iter = _cells.find(CellKey(x, y));
+                if (iter == _cells.cend()) {
+                    continue;
+                }
+                for (int i = iter->second.first; i < iter->second.second; ++i) {
+                    func(_indices[i]);
+                }
+            }
+        }
+    }
+};
+}  // namespace ns_ekalibr
+
+#endif  // SPATIAL_HASH_H
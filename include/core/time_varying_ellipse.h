@@ -119,6 +119,9 @@ public:
 
     Ellipse::Ptr EllipseAt(double t) const;
 
+    // pixels the center moves and the axes change in the time range '[st, et]'
+    double MotionExtent() const;
+
     void Draw(cv::Mat& mat,
               double timestamp,
               const std::optional<cv::Scalar>& color = std::nullopt) const;
@@ -38,6 +38,8 @@
 #include "sensor/imu.hpp"
 #include "util/utils.h"
 #include "config/configor.h"
+#include "factor/spline_basis.hpp"
+#include "limits"
 
 namespace ns_ekalibr {
 template <int Order, int TimeDeriv>
@@ -157,7 +159,236 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * 'IMUAcceFactor' with a constant time offset, the spline basis of the measurement is precomputed.
+ * The param blocks are the same, while the time offset block is not involved.
+ */
+template <int Order, int TimeDeriv>
+struct IMUAcceFixedTOFactor {
+private:
+    std::size_t _so3ParamCount, _scaleParamCount;
+    IMUFrame::Ptr _imuFrame{};
+    SplineBasisAt<Order> _so3Basis, _scaleBasis;
+
+    double _weight;
+
+public:
+    explicit IMUAcceFixedTOFactor(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                                  const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                                  IMUFrame::Ptr imuFrame,
+                                  double TO_BiToBr,
+                                  double weight)
+        : _so3ParamCount(rotMeta.NumParameters()),
+          _scaleParamCount(linScaleMeta.NumParameters()),
+          _imuFrame(std::move(imuFrame)),
+          _so3Basis(rotMeta, _imuFrame->GetTimestamp() + TO_BiToBr),
+          _scaleBasis(linScaleMeta, _imuFrame->GetTimestamp() + TO_BiToBr, TimeDeriv),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                       const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                       const IMUFrame::Ptr &imuFrame,
+                       double TO_BiToBr,
+                       double weight) {
+        return new ceres::DynamicAutoDiffCostFunction<IMUAcceFixedTOFactor>(
+            new IMUAcceFixedTOFactor(rotMeta, linScaleMeta, imuFrame, TO_BiToBr, weight));
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUAcceFixedTOFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
+     *   SO3_BiToBr | POS_BiInBr | TO_BiToBr ]
+     */
+    template <class T>
+    bool operator()(T const *const *sKnots, T *sResiduals) const {
+        std::size_t SO3_OFFSET = _so3Basis.index;
+        std::size_t LIN_SCALE_OFFSET = _scaleBasis.index + _so3ParamCount;
+
+        std::size_t ACCE_BIAS_OFFSET = _so3ParamCount + _scaleParamCount;
+        std::size_t ACCE_MAP_COEFF_OFFSET = ACCE_BIAS_OFFSET + 1;
+        std::size_t GRAVITY_OFFSET = ACCE_MAP_COEFF_OFFSET + 1;
+        std::size_t SO3_BiToBr_OFFSET = GRAVITY_OFFSET + 1;
+        std::size_t POS_BiInBr_OFFSET = SO3_BiToBr_OFFSET + 1;
+
+        // get value
+        Eigen::Map<const Sophus::SO3<T>> SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3<T>> POS_BiInBr(sKnots[POS_BiInBr_OFFSET]);
+
+        Sophus::SO3<T> SO3_BrToBr0;
+        Sophus::SO3Tangent<T> SO3_VEL_BrToBr0InBr, SO3_ACCE_BrToBr0InBr;
+        SplineBasis<Order>::EvaluateLie(sKnots + SO3_OFFSET, _so3Basis.lieCoeff,
+                                        _so3Basis.lieDCoeff, _so3Basis.lieDDCoeff, &SO3_BrToBr0,
+                                        &SO3_VEL_BrToBr0InBr, &SO3_ACCE_BrToBr0InBr);
+        Sophus::SO3Tangent<T> SO3_VEL_BrToBr0InBr0 = SO3_BrToBr0 * SO3_VEL_BrToBr0InBr;
+        Sophus::SO3Tangent<T> SO3_ACCE_BrToBr0InBr0 = SO3_BrToBr0 * SO3_ACCE_BrToBr0InBr;
+
+        Eigen::Vector3<T> ACCE_BrToBr0InBr0;
+        SplineBasis<Order>::template Evaluate<3>(sKnots + LIN_SCALE_OFFSET, _scaleBasis.coeff,
+                                                 &ACCE_BrToBr0InBr0);
+
+        Eigen::Map<const Eigen::Vector3<T>> acceBias(sKnots[ACCE_BIAS_OFFSET]);
+        Eigen::Map<const Eigen::Vector3<T>> gravity(sKnots[GRAVITY_OFFSET]);
+
+        auto acceCoeff = sKnots[ACCE_MAP_COEFF_OFFSET];
+
+        Eigen::Matrix33<T> acceMapMat = Eigen::Matrix33<T>::Zero();
+
+        acceMapMat.diagonal() = Eigen::Map<const Eigen::Vector3<T>>(acceCoeff, 3);
+        acceMapMat(0, 1) = *(acceCoeff + 3);
+        acceMapMat(0, 2) = *(acceCoeff + 4);
+        acceMapMat(1, 2) = *(acceCoeff + 5);
+
+        Sophus::SO3<T> SO3_BiToBr0 = SO3_BrToBr0 * SO3_BiToBr;
+
+        Eigen::Matrix33<T> SO3_VEL_MAT = Sophus::SO3<T>::hat(SO3_VEL_BrToBr0InBr0);
+        Eigen::Matrix33<T> SO3_ACCE_MAT = Sophus::SO3<T>::hat(SO3_ACCE_BrToBr0InBr0);
+        Eigen::Vector3<T> POS_ACCE_BiToBr0InBr0 =
+            ACCE_BrToBr0InBr0 +
+            (SO3_ACCE_MAT + SO3_VEL_MAT * SO3_VEL_MAT) * (SO3_BrToBr0.matrix() * POS_BiInBr);
+
+        Eigen::Vector3<T> accePred =
+            (acceMapMat * (SO3_BiToBr0.inverse() * (POS_ACCE_BiToBr0InBr0 - gravity))).eval() +
+            acceBias;
+
+        Eigen::Map<Eigen::Vector3<T>> residuals(sResiduals);
+        residuals = accePred - _imuFrame->GetAcce().template cast<T>();
+        residuals = T(_weight) * residuals;
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * 'IMUAcceFixedTOFactor' for all measurements in a single knot span, which share one residual
+ * block. Relative rotations between knots and the intrinsics are evaluated once for the group,
+ * and three residuals are produced for each measurement.
+ */
+template <int Order, int TimeDeriv>
+struct IMUAcceIntervalFactor {
+private:
+    std::size_t _so3ParamCount, _scaleParamCount;
+    std::vector<IMUFrame::Ptr> _imuFrames;
+    std::vector<SplineBasisAt<Order>> _so3Bases, _scaleBases;
+
+    double _weight;
+
+public:
+    explicit IMUAcceIntervalFactor(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                                   const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                                   std::vector<IMUFrame::Ptr> imuFrames,
+                                   double TO_BiToBr,
+                                   double weight)
+        : _so3ParamCount(rotMeta.NumParameters()),
+          _scaleParamCount(linScaleMeta.NumParameters()),
+          _imuFrames(std::move(imuFrames)),
+          _weight(weight) {
+        _so3Bases.reserve(_imuFrames.size());
+        _scaleBases.reserve(_imuFrames.size());
+        for (const auto &frame : _imuFrames) {
+            _so3Bases.emplace_back(rotMeta, frame->GetTimestamp() + TO_BiToBr);
+            _scaleBases.emplace_back(linScaleMeta, frame->GetTimestamp() + TO_BiToBr, TimeDeriv);
+        }
+    }
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                       const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                       const std::vector<IMUFrame::Ptr> &imuFrames,
+                       double TO_BiToBr,
+                       double weight) {
+        return new ceres::DynamicAutoDiffCostFunction<IMUAcceIntervalFactor>(
+            new IMUAcceIntervalFactor(rotMeta, linScaleMeta, imuFrames, TO_BiToBr, weight));
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUAcceIntervalFactor).hash_code(); }
+
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
+     *   SO3_BiToBr | POS_BiInBr | TO_BiToBr ]
+     */
+    template <class T>
+    bool operator()(T const *const *sKnots, T *sResiduals) const {
+        std::size_t ACCE_BIAS_OFFSET = _so3ParamCount + _scaleParamCount;
+        std::size_t ACCE_MAP_COEFF_OFFSET = ACCE_BIAS_OFFSET + 1;
+        std::size_t GRAVITY_OFFSET = ACCE_MAP_COEFF_OFFSET + 1;
+        std::size_t SO3_BiToBr_OFFSET = GRAVITY_OFFSET + 1;
+        std::size_t POS_BiInBr_OFFSET = SO3_BiToBr_OFFSET + 1;
+
+        // get value
+        Eigen::Map<const Sophus::SO3<T>> SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3<T>> POS_BiInBr(sKnots[POS_BiInBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3<T>> acceBias(sKnots[ACCE_BIAS_OFFSET]);
+        Eigen::Map<const Eigen::Vector3<T>> gravity(sKnots[GRAVITY_OFFSET]);
+
+        auto acceCoeff = sKnots[ACCE_MAP_COEFF_OFFSET];
+
+        Eigen::Matrix33<T> acceMapMat = Eigen::Matrix33<T>::Zero();
+
+        acceMapMat.diagonal() = Eigen::Map<const Eigen::Vector3<T>>(acceCoeff, 3);
+        acceMapMat(0, 1) = *(acceCoeff + 3);
+        acceMapMat(0, 2) = *(acceCoeff + 4);
+        acceMapMat(1, 2) = *(acceCoeff + 5);
+
+        const Eigen::Matrix33<T> mapToAcce = acceMapMat * SO3_BiToBr.inverse().matrix();
+
+        // knots of the span, and relative rotations between them, are shared by all measurements
+        std::size_t lastOffset = std::numeric_limits<std::size_t>::max();
+        Sophus::SO3<T> firstKnot;
+        std::array<Sophus::SO3Tangent<T>, Order - 1> deltas;
+
+        for (std::size_t i = 0; i < _imuFrames.size(); ++i) {
+            const auto &so3Basis = _so3Bases[i], &scaleBasis = _scaleBases[i];
+            if (so3Basis.index != lastOffset) {
+                lastOffset = so3Basis.index;
+                firstKnot = Sophus::SO3<T>(Eigen::Map<const Sophus::SO3<T>>(sKnots[lastOffset]));
+                deltas = SplineBasis<Order>::LieDeltas(sKnots + lastOffset);
+            }
+
+            Sophus::SO3<T> SO3_BrToBr0;
+            Sophus::SO3Tangent<T> SO3_VEL_BrToBr0InBr, SO3_ACCE_BrToBr0InBr;
+            SplineBasis<Order>::EvaluateLie(firstKnot, deltas, so3Basis.lieCoeff,
+                                            so3Basis.lieDCoeff, so3Basis.lieDDCoeff, &SO3_BrToBr0,
+                                            &SO3_VEL_BrToBr0InBr, &SO3_ACCE_BrToBr0InBr);
+            Sophus::SO3Tangent<T> SO3_VEL_BrToBr0InBr0 = SO3_BrToBr0 * SO3_VEL_BrToBr0InBr;
+            Sophus::SO3Tangent<T> SO3_ACCE_BrToBr0InBr0 = SO3_BrToBr0 * SO3_ACCE_BrToBr0InBr;
+
+            Eigen::Vector3<T> ACCE_BrToBr0InBr0;
+            SplineBasis<Order>::template Evaluate<3>(
+                sKnots + scaleBasis.index + _so3ParamCount, scaleBasis.coeff, &ACCE_BrToBr0InBr0);
+
+            Eigen::Matrix33<T> SO3_VEL_MAT = Sophus::SO3<T>::hat(SO3_VEL_BrToBr0InBr0);
+            Eigen::Matrix33<T> SO3_ACCE_MAT = Sophus::SO3<T>::hat(SO3_ACCE_BrToBr0InBr0);
+            Eigen::Vector3<T> POS_ACCE_BiToBr0InBr0 =
+                ACCE_BrToBr0InBr0 +
+                (SO3_ACCE_MAT + SO3_VEL_MAT * SO3_VEL_MAT) * (SO3_BrToBr0.matrix() * POS_BiInBr);
+
+            Eigen::Vector3<T> accePred =
+                (mapToAcce * (SO3_BrToBr0.inverse() * (POS_ACCE_BiToBr0InBr0 - gravity))).eval() +
+                acceBias;
+
+            Eigen::Map<Eigen::Vector3<T>> residuals(sResiduals + 3 * i);
+            residuals = accePred - _imuFrames[i]->GetAcce().template cast<T>();
+            residuals = T(_weight) * residuals;
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct IMUAcceFactor<Configor::Prior::SplineOrder, 2>;
+extern template struct IMUAcceFixedTOFactor<Configor::Prior::SplineOrder, 2>;
+extern template struct IMUAcceIntervalFactor<Configor::Prior::SplineOrder, 2>;
 }  // namespace ns_ekalibr
 
 #endif  // IMU_ACCE_FACTOR_HPP
@@ -34,6 +34,8 @@
 #include "sensor/imu.hpp"
 #include "ceres/dynamic_autodiff_cost_function.h"
 #include "config/configor.h"
+#include "factor/spline_basis.hpp"
+#include "limits"
 
 namespace ns_ekalibr {
 
@@ -119,7 +121,189 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * 'IMUGyroFactor' with a constant time offset, the spline basis of the measurement is precomputed.
+ * The param blocks are the same, while the time offset block is not involved.
+ */
+template <int Order>
+struct IMUGyroFixedTOFactor {
+private:
+    std::size_t _so3ParamCount;
+    IMUFrame::Ptr _frame{};
+    SplineBasisAt<Order> _so3Basis;
+
+    double _weight;
+
+public:
+    explicit IMUGyroFixedTOFactor(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                                  IMUFrame::Ptr frame,
+                                  double TO_BiToBr,
+                                  double weight)
+        : _so3ParamCount(so3Meta.NumParameters()),
+          _frame(std::move(frame)),
+          _so3Basis(so3Meta, _frame->GetTimestamp() + TO_BiToBr),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                       const IMUFrame::Ptr &frame,
+                       double TO_BiToBr,
+                       double weight) {
+        return new ceres::DynamicAutoDiffCostFunction<IMUGyroFixedTOFactor>(
+            new IMUGyroFixedTOFactor(so3Meta, frame, TO_BiToBr, weight));
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUGyroFixedTOFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 | ... | SO3 | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr | TO_BiToBr ]
+     */
+    template <class T>
+    bool operator()(T const *const *sKnots, T *sResiduals) const {
+        // array offset
+        std::size_t SO3_OFFSET = _so3Basis.index;
+        std::size_t GYRO_BIAS_OFFSET = _so3ParamCount;
+        std::size_t GYRO_MAP_COEFF_OFFSET = GYRO_BIAS_OFFSET + 1;
+        std::size_t SO3_AtoG_OFFSET = GYRO_MAP_COEFF_OFFSET + 1;
+        std::size_t SO3_BiToBr_OFFSET = SO3_AtoG_OFFSET + 1;
+
+        Sophus::SO3<T> SO3_BrToBr0;
+        Sophus::SO3Tangent<T> SO3_VEL_BrToBr0InBr;
+        SplineBasis<Order>::EvaluateLie(sKnots + SO3_OFFSET, _so3Basis.lieCoeff,
+                                        _so3Basis.lieDCoeff, _so3Basis.lieDDCoeff, &SO3_BrToBr0,
+                                        &SO3_VEL_BrToBr0InBr);
+
+        Eigen::Map<const Eigen::Vector3<T>> gyroBias(sKnots[GYRO_BIAS_OFFSET]);
+        auto gyroCoeff = sKnots[GYRO_MAP_COEFF_OFFSET];
+        Eigen::Matrix33<T> gyroMapMat = Eigen::Matrix33<T>::Zero();
+        gyroMapMat.diagonal() = Eigen::Map<const Eigen::Vector3<T>>(gyroCoeff, 3);
+        gyroMapMat(0, 1) = *(gyroCoeff + 3);
+        gyroMapMat(0, 2) = *(gyroCoeff + 4);
+        gyroMapMat(1, 2) = *(gyroCoeff + 5);
+
+        Eigen::Map<Sophus::SO3<T> const> const SO3_AtoG(sKnots[SO3_AtoG_OFFSET]);
+        Eigen::Map<Sophus::SO3<T> const> const SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+        Sophus::SO3<T> SO3_BiToBr0 = SO3_BrToBr0 * SO3_BiToBr;
+        Sophus::SO3Tangent<T> SO3_VEL_BrToBr0InBr0 = SO3_BrToBr0 * SO3_VEL_BrToBr0InBr;
+
+        Eigen::Vector3<T> pred =
+            (gyroMapMat * (SO3_AtoG * SO3_BiToBr0.inverse() * SO3_VEL_BrToBr0InBr0)).eval() +
+            gyroBias;
+
+        Eigen::Map<Eigen::Vector3<T>> residuals(sResiduals);
+        residuals = pred - _frame->GetGyro().template cast<T>();
+        residuals = T(_weight) * residuals;
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * 'IMUGyroFixedTOFactor' for all measurements in a single knot span, which share one residual
+ * block. Relative rotations between knots and the intrinsics are evaluated once for the group,
+ * and three residuals are produced for each measurement.
+ */
+template <int Order>
+struct IMUGyroIntervalFactor {
+private:
+    std::size_t _so3ParamCount;
+    std::vector<IMUFrame::Ptr> _frames;
+    std::vector<SplineBasisAt<Order>> _so3Bases;
+
+    double _weight;
+
+public:
+    explicit IMUGyroIntervalFactor(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                                   std::vector<IMUFrame::Ptr> frames,
+                                   double TO_BiToBr,
+                                   double weight)
+        : _so3ParamCount(so3Meta.NumParameters()),
+          _frames(std::move(frames)),
+          _weight(weight) {
+        _so3Bases.reserve(_frames.size());
+        for (const auto &frame : _frames) {
+            _so3Bases.emplace_back(so3Meta, frame->GetTimestamp() + TO_BiToBr);
+        }
+    }
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                       const std::vector<IMUFrame::Ptr> &frames,
+                       double TO_BiToBr,
+                       double weight) {
+        return new ceres::DynamicAutoDiffCostFunction<IMUGyroIntervalFactor>(
+            new IMUGyroIntervalFactor(so3Meta, frames, TO_BiToBr, weight));
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUGyroIntervalFactor).hash_code(); }
+
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 | ... | SO3 | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr | TO_BiToBr ]
+     */
+    template <class T>
+    bool operator()(T const *const *sKnots, T *sResiduals) const {
+        // array offset
+        std::size_t GYRO_BIAS_OFFSET = _so3ParamCount;
+        std::size_t GYRO_MAP_COEFF_OFFSET = GYRO_BIAS_OFFSET + 1;
+        std::size_t SO3_AtoG_OFFSET = GYRO_MAP_COEFF_OFFSET + 1;
+        std::size_t SO3_BiToBr_OFFSET = SO3_AtoG_OFFSET + 1;
+
+        Eigen::Map<const Eigen::Vector3<T>> gyroBias(sKnots[GYRO_BIAS_OFFSET]);
+        auto gyroCoeff = sKnots[GYRO_MAP_COEFF_OFFSET];
+        Eigen::Matrix33<T> gyroMapMat = Eigen::Matrix33<T>::Zero();
+        gyroMapMat.diagonal() = Eigen::Map<const Eigen::Vector3<T>>(gyroCoeff, 3);
+        gyroMapMat(0, 1) = *(gyroCoeff + 3);
+        gyroMapMat(0, 2) = *(gyroCoeff + 4);
+        gyroMapMat(1, 2) = *(gyroCoeff + 5);
+
+        Eigen::Map<Sophus::SO3<T> const> const SO3_AtoG(sKnots[SO3_AtoG_OFFSET]);
+        Eigen::Map<Sophus::SO3<T> const> const SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+        // the angular velocity in the body frame of the imu: 'SO3_BiToBr0^-1 * SO3_BrToBr0 * vel'
+        // equals 'SO3_BiToBr^-1 * vel', as the velocity is expressed in the reference frame
+        const Eigen::Matrix33<T> mapToGyro =
+            gyroMapMat * (SO3_AtoG * SO3_BiToBr.inverse()).matrix();
+
+        // knots of the span, and relative rotations between them, are shared by all measurements
+        std::size_t lastOffset = std::numeric_limits<std::size_t>::max();
+        Sophus::SO3<T> firstKnot;
+        std::array<Sophus::SO3Tangent<T>, Order - 1> deltas;
+
+        for (std::size_t i = 0; i < _frames.size(); ++i) {
+            const auto &basis = _so3Bases[i];
+            if (basis.index != lastOffset) {
+                lastOffset = basis.index;
+                firstKnot = Sophus::SO3<T>(Eigen::Map<const Sophus::SO3<T>>(sKnots[lastOffset]));
+                deltas = SplineBasis<Order>::LieDeltas(sKnots + lastOffset);
+            }
+
+            Sophus::SO3<T> SO3_BrToBr0;
+            Sophus::SO3Tangent<T> SO3_VEL_BrToBr0InBr;
+            SplineBasis<Order>::EvaluateLie(firstKnot, deltas, basis.lieCoeff, basis.lieDCoeff,
+                                            basis.lieDDCoeff, &SO3_BrToBr0, &SO3_VEL_BrToBr0InBr);
+
+            Eigen::Vector3<T> pred = (mapToGyro * SO3_VEL_BrToBr0InBr).eval() + gyroBias;
+
+            Eigen::Map<Eigen::Vector3<T>> residuals(sResiduals + 3 * i);
+            residuals = pred - _frames[i]->GetGyro().template cast<T>();
+            residuals = T(_weight) * residuals;
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct IMUGyroFactor<Configor::Prior::SplineOrder>;
+extern template struct IMUGyroFixedTOFactor<Configor::Prior::SplineOrder>;
+extern template struct IMUGyroIntervalFactor<Configor::Prior::SplineOrder>;
 }  // namespace ns_ekalibr
 
 #endif  // IMU_GYRO_FACTOR_HPP
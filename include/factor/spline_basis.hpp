@@ -0,0 +1,228 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SPLINE_BASIS_HPP
+#define SPLINE_BASIS_HPP
+
+#include "Eigen/Dense"
+#include "sophus/so3.hpp"
+#include "array"
+
+namespace ns_ekalibr {
+
+/**
+ * Basis of uniform b-splines evaluated in double precision, for measurements whose times on the
+ * spline are constant during an optimization (i.e., their time offsets are fixed). The knot index
+ * and the (cumulative) basis coefficients of such a measurement are then computed once, rather than
+ * in jets at every residual evaluation. The formulas are the ones of 'CeresSplineHelperJet'.
+ */
+template <int Order>
+struct SplineBasis {
+    using MatN = Eigen::Matrix<double, Order, Order>;
+    using VecN = Eigen::Matrix<double, Order, 1>;
+
+    static const MatN &BlendingMatrix() {
+        static const MatN mat = ComputeBlendingMatrix(false);
+        return mat;
+    }
+
+    static const MatN &CumulativeBlendingMatrix() {
+        static const MatN mat = ComputeBlendingMatrix(true);
+        return mat;
+    }
+
+    /**
+     * @param u the normalized time in the segment, see 'SplineMeta::ComputeSplineIndex'
+     * @param dtInv the inverse of the knot distance
+     * @return coefficients of knots for the 'deriv'-th derivative
+     */
+    static VecN Coeffs(double u, double dtInv, int deriv, bool cumulative) {
+        VecN p = VecN::Zero();
+        if (deriv < Order) {
+            // derivatives of [1, u, u^2, ..., u^(N-1)]
+            double ui = 1.0;
+            for (int j = deriv; j < Order; ++j) {
+                double factor = 1.0;
+                for (int k = 0; k < deriv; ++k) {
+                    factor *= j - k;
+                }
+                p(j) = factor * ui;
+                ui *= u;
+            }
+        }
+        const MatN &mat = cumulative ? CumulativeBlendingMatrix() : BlendingMatrix();
+        return std::pow(dtInv, deriv) * mat * p;
+    }
+
+    /**
+     * the same as 'CeresSplineHelperJet::EvaluateLie', with cumulative coefficients given
+     */
+    template <class T>
+    static void EvaluateLie(T const *const *sKnots,
+                            const VecN &coeff,
+                            const VecN &dCoeff,
+                            const VecN &ddCoeff,
+                            Sophus::SO3<T> *so3Out,
+                            typename Sophus::SO3<T>::Tangent *velOut = nullptr,
+                            typename Sophus::SO3<T>::Tangent *accOut = nullptr) {
+        EvaluateLie(Sophus::SO3<T>(Eigen::Map<const Sophus::SO3<T>>(sKnots[0])),
+                    LieDeltas(sKnots), coeff, dCoeff, ddCoeff, so3Out, velOut, accOut);
+    }
+
+    /**
+     * relative rotations between neighboring knots, i.e., 'log(inv(R_i) * R_(i+1))', which are
+     * shared by all measurements in the knot span
+     */
+    template <class T>
+    static std::array<typename Sophus::SO3<T>::Tangent, Order - 1> LieDeltas(
+        T const *const *sKnots) {
+        std::array<typename Sophus::SO3<T>::Tangent, Order - 1> deltas;
+        for (int i = 0; i < Order - 1; ++i) {
+            Eigen::Map<const Sophus::SO3<T>> p0(sKnots[i]);
+            Eigen::Map<const Sophus::SO3<T>> p1(sKnots[i + 1]);
+            deltas[i] = (p0.inverse() * p1).log();
+        }
+        return deltas;
+    }
+
+    template <class T>
+    static void EvaluateLie(const Sophus::SO3<T> &firstKnot,
+                            const std::array<typename Sophus::SO3<T>::Tangent, Order - 1> &deltas,
+                            const VecN &coeff,
+                            const VecN &dCoeff,
+                            const VecN &ddCoeff,
+                            Sophus::SO3<T> *so3Out,
+                            typename Sophus::SO3<T>::Tangent *velOut = nullptr,
+                            typename Sophus::SO3<T>::Tangent *accOut = nullptr) {
+        using Tangent = typename Sophus::SO3<T>::Tangent;
+
+        Sophus::SO3<T> res = firstKnot;
+        Tangent vel = Tangent::Zero(), acc = Tangent::Zero();
+
+        for (int i = 0; i < Order - 1; ++i) {
+            const Tangent &delta = deltas[i];
+            const Sophus::SO3<T> expKDelta = Sophus::SO3<T>::exp(delta * T(coeff[i + 1]));
+            res = res * expKDelta;
+
+            if (velOut != nullptr || accOut != nullptr) {
+                const auto adj = expKDelta.inverse().Adj();
+                vel = adj * vel;
+                const Tangent velCur = delta * T(dCoeff[i + 1]);
+                vel += velCur;
+                if (accOut != nullptr) {
+                    acc = adj * acc;
+                    acc += delta * T(ddCoeff[i + 1]) + Sophus::SO3<T>::lieBracket(vel, velCur);
+                }
+            }
+        }
+        *so3Out = res;
+        if (velOut != nullptr) {
+            *velOut = vel;
+        }
+        if (accOut != nullptr) {
+            *accOut = acc;
+        }
+    }
+
+    /**
+     * the same as 'CeresSplineHelperJet::Evaluate', with (non-cumulative) coefficients given
+     */
+    template <int Dim, class T>
+    static void Evaluate(T const *const *sKnots, const VecN &coeff, Eigen::Matrix<T, Dim, 1> *out) {
+        out->setZero();
+        for (int i = 0; i < Order; ++i) {
+            *out += T(coeff[i]) * Eigen::Map<const Eigen::Matrix<T, Dim, 1>>(sKnots[i]);
+        }
+    }
+
+protected:
+    static MatN ComputeBlendingMatrix(bool cumulative) {
+        const auto Binomial = [](int n, int k) {
+            double res = 1.0;
+            for (int i = 1; i <= k; ++i) {
+                res = res * (n - k + i) / i;
+            }
+            return res;
+        };
+        MatN m = MatN::Zero();
+        for (int i = 0; i < Order; ++i) {
+            for (int j = 0; j < Order; ++j) {
+                double sum = 0.0;
+                for (int s = j; s < Order; ++s) {
+                    sum += std::pow(-1.0, s - j) * Binomial(Order, s - j) *
+                           std::pow(Order - s - 1.0, Order - 1.0 - i);
+                }
+                m(j, i) = Binomial(Order - 1, Order - 1 - i) * sum;
+            }
+        }
+        double factorial = 1.0;
+        for (int i = 2; i < Order; ++i) {
+            factorial *= i;
+        }
+        m /= factorial;
+        if (cumulative) {
+            for (int i = 0; i < Order; ++i) {
+                for (int j = i + 1; j < Order; ++j) {
+                    m.row(i) += m.row(j);
+                }
+            }
+        }
+        return m;
+    }
+};
+
+/**
+ * the knot index and the basis coefficients of a measurement whose time on the spline is constant
+ */
+template <int Order>
+struct SplineBasisAt {
+    using VecN = typename SplineBasis<Order>::VecN;
+
+    // index of the first knot in the spline meta
+    std::size_t index;
+    // cumulative coefficients (and time derivatives) for the lie group spline
+    VecN lieCoeff, lieDCoeff, lieDDCoeff;
+    // coefficients for the 'deriv'-th time derivative of the euclidean spline
+    VecN coeff;
+
+    SplineBasisAt() = default;
+
+    template <class SplineMeta>
+    SplineBasisAt(const SplineMeta &meta, double time, int deriv = 0) {
+        double u;
+        meta.ComputeSplineIndex(time, index, u);
+        const double dtInv = 1.0 / meta.segments.front().dt;
+        lieCoeff = SplineBasis<Order>::Coeffs(u, dtInv, 0, true);
+        lieDCoeff = SplineBasis<Order>::Coeffs(u, dtInv, 1, true);
+        lieDDCoeff = SplineBasis<Order>::Coeffs(u, dtInv, 2, true);
+        coeff = SplineBasis<Order>::Coeffs(u, dtInv, deriv, false);
+    }
+};
+}  // namespace ns_ekalibr
+
+#endif  // SPLINE_BASIS_HPP
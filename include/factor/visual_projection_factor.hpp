@@ -37,6 +37,7 @@
 #include "ceres/dynamic_autodiff_cost_function.h"
 #include "util/utils.h"
 #include "config/configor.h"
+#include "factor/spline_basis.hpp"
 
 namespace ns_ekalibr {
 struct VisualProjectionPair {
@@ -60,29 +61,80 @@ struct VisualProjectionPair {
     }
 };
 
+/**
+ * contiguous (struct-of-arrays) store of visual projection pairs, each pair is indexed by the id of
+ * its grid and the index of its circle in the grid
+ */
+struct VisualProjectionPairs {
+    using Ptr = std::shared_ptr<VisualProjectionPairs>;
+
+    std::vector<double> timestamps;
+    std::vector<Eigen::Vector3d> points3d;
+    std::vector<Eigen::Vector2d> pixels2d;
+    std::vector<int> gridIds;
+    std::vector<int> circleIds;
+
+    static Ptr Create() { return std::make_shared<VisualProjectionPairs>(); }
+
+    void Reserve(std::size_t size) {
+        timestamps.reserve(size);
+        points3d.reserve(size);
+        pixels2d.reserve(size);
+        gridIds.reserve(size);
+        circleIds.reserve(size);
+    }
+
+    void Clear() {
+        timestamps.clear();
+        points3d.clear();
+        pixels2d.clear();
+        gridIds.clear();
+        circleIds.clear();
+    }
+
+    void Push(double timestamp,
+              const Eigen::Vector3d &point3d,
+              const Eigen::Vector2d &pixel2d,
+              int gridId,
+              int circleId) {
+        timestamps.push_back(timestamp);
+        points3d.push_back(point3d);
+        pixels2d.push_back(pixel2d);
+        gridIds.push_back(gridId);
+        circleIds.push_back(circleId);
+    }
+
+    [[nodiscard]] std::size_t Size() const { return timestamps.size(); }
+
+    [[nodiscard]] VisualProjectionPair At(std::size_t i) const {
+        return {timestamps[i], points3d[i], pixels2d[i]};
+    }
+};
+
 template <int Order>
 struct VisualProjectionFactor {
 private:
     ns_ctraj::SplineMeta<Order> _so3Meta, _scaleMeta;
-    VisualProjectionPair::Ptr _pair;
+    // held by value, so that pairs need not be allocated individually
+    VisualProjectionPair _pair;
     double _so3DtInv, _scaleDtInv;
     double _weight;
 
 public:
     explicit VisualProjectionFactor(ns_ctraj::SplineMeta<Order> rotMeta,
                                     ns_ctraj::SplineMeta<Order> linScaleMeta,
-                                    VisualProjectionPair::Ptr pair,
+                                    const VisualProjectionPair &pair,
                                     double weight)
         : _so3Meta(rotMeta),
           _scaleMeta(std::move(linScaleMeta)),
-          _pair(std::move(pair)),
+          _pair(pair),
           _so3DtInv(1.0 / rotMeta.segments.front().dt),
           _scaleDtInv(1.0 / _scaleMeta.segments.front().dt),
           _weight(weight) {}
 
     static auto Create(const ns_ctraj::SplineMeta<Order> &rotMeta,
                        const ns_ctraj::SplineMeta<Order> &linScaleMeta,
-                       const VisualProjectionPair::Ptr &pair,
+                       const VisualProjectionPair &pair,
                        double weight) {
         return new ceres::DynamicAutoDiffCostFunction<VisualProjectionFactor>(
             new VisualProjectionFactor(rotMeta, linScaleMeta, pair, weight));
@@ -155,7 +207,7 @@ public:
         // this is for pinhole brow t2 [k1, k2, k3, p1, p2]
         Eigen::Map<const Eigen::Vector5<T>> DIST_COEFFS(sKnots[DIST_COEFFS_OFFSET]);
 
-        T timeByBr = static_cast<T>(_pair->timestamp) + TO_CjToBr;
+        T timeByBr = static_cast<T>(_pair.timestamp) + TO_CjToBr;
 
         // calculate the so3 and lin scale offset
         std::pair<std::size_t, T> iuSo3, iuScale;
@@ -177,7 +229,7 @@ public:
         Sophus::SE3<T> SE3_CjToW = SE3_BrToW * SE3_CjToBr;
 
         // from world frame to camera frame
-        Eigen::Vector3<T> pInCam = SE3_CjToW.inverse() * _pair->point3d.cast<T>();
+        Eigen::Vector3<T> pInCam = SE3_CjToW.inverse() * _pair.point3d.cast<T>();
         // from camera frame to camera normalized plane
         Eigen::Vector2<T> pInCamPlane(pInCam(0) / pInCam(2), pInCam(1) / pInCam(2));
         // add distortion
@@ -187,7 +239,109 @@ public:
         TransformCamToImg<T>(&FX, &FY, &CX, &CY, pInCamPlane, &pixelPred);
 
         Eigen::Map<Eigen::Vector2<T>> residuals(sResiduals);
-        residuals = pixelPred - _pair->pixel2d.cast<T>();
+        residuals = pixelPred - _pair.pixel2d.cast<T>();
+        residuals = T(_weight) * residuals;
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * 'VisualProjectionFactor' with a constant time offset, the spline basis of the pair is
+ * precomputed. The param blocks are the same, while the time offset block is not involved.
+ */
+template <int Order>
+struct VisualProjectionFixedTOFactor {
+private:
+    using Helper = VisualProjectionFactor<Order>;
+
+    std::size_t _so3ParamCount, _scaleParamCount;
+    VisualProjectionPair _pair;
+    SplineBasisAt<Order> _so3Basis, _scaleBasis;
+    double _weight;
+
+public:
+    explicit VisualProjectionFixedTOFactor(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                                           const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                                           const VisualProjectionPair &pair,
+                                           double TO_CjToBr,
+                                           double weight)
+        : _so3ParamCount(rotMeta.NumParameters()),
+          _scaleParamCount(linScaleMeta.NumParameters()),
+          _pair(pair),
+          _so3Basis(rotMeta, pair.timestamp + TO_CjToBr),
+          _scaleBasis(linScaleMeta, pair.timestamp + TO_CjToBr),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                       const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                       const VisualProjectionPair &pair,
+                       double TO_CjToBr,
+                       double weight) {
+        return new ceres::DynamicAutoDiffCostFunction<VisualProjectionFixedTOFactor>(
+            new VisualProjectionFixedTOFactor(rotMeta, linScaleMeta, pair, TO_CjToBr, weight));
+    }
+
+    static std::size_t TypeHashCode() { return typeid(VisualProjectionFixedTOFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | SO3_CjToBr | POS_CjInBr | TO_CjToBr |
+     *   FX | FY | CX | CY | DIST_COEFFS ]
+     */
+    template <class T>
+    bool operator()(T const *const *sKnots, T *sResiduals) const {
+        std::size_t SO3_OFFSET = _so3Basis.index;
+        std::size_t LIN_SCALE_OFFSET = _scaleBasis.index + _so3ParamCount;
+
+        std::size_t SO3_CjToBr_OFFSET = _so3ParamCount + _scaleParamCount;
+        std::size_t POS_CjInBr_OFFSET = SO3_CjToBr_OFFSET + 1;
+        std::size_t TO_CjToBr_OFFSET = POS_CjInBr_OFFSET + 1;
+        std::size_t FX_OFFSET = TO_CjToBr_OFFSET + 1;
+        std::size_t FY_OFFSET = FX_OFFSET + 1;
+        std::size_t CX_OFFSET = FY_OFFSET + 1;
+        std::size_t CY_OFFSET = CX_OFFSET + 1;
+        std::size_t DIST_COEFFS_OFFSET = CY_OFFSET + 1;
+
+        Eigen::Map<const Sophus::SO3<T>> SO3_CjToBr(sKnots[SO3_CjToBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3<T>> POS_CjInBr(sKnots[POS_CjInBr_OFFSET]);
+        Sophus::SE3<T> SE3_CjToBr(SO3_CjToBr, POS_CjInBr);
+
+        T FX = sKnots[FX_OFFSET][0];
+        T FY = sKnots[FY_OFFSET][0];
+        T CX = sKnots[CX_OFFSET][0];
+        T CY = sKnots[CY_OFFSET][0];
+
+        // this is for pinhole brow t2 [k1, k2, k3, p1, p2]
+        Eigen::Map<const Eigen::Vector5<T>> DIST_COEFFS(sKnots[DIST_COEFFS_OFFSET]);
+
+        Sophus::SO3<T> SO3_BrToW;
+        SplineBasis<Order>::EvaluateLie(sKnots + SO3_OFFSET, _so3Basis.lieCoeff,
+                                        _so3Basis.lieDCoeff, _so3Basis.lieDDCoeff, &SO3_BrToW);
+        Eigen::Vector3<T> POS_BrInW;
+        SplineBasis<Order>::template Evaluate<3>(sKnots + LIN_SCALE_OFFSET, _scaleBasis.coeff,
+                                                 &POS_BrInW);
+
+        Sophus::SE3<T> SE3_BrToW(SO3_BrToW, POS_BrInW);
+
+        Sophus::SE3<T> SE3_CjToW = SE3_BrToW * SE3_CjToBr;
+
+        // from world frame to camera frame
+        Eigen::Vector3<T> pInCam = SE3_CjToW.inverse() * _pair.point3d.cast<T>();
+        // from camera frame to camera normalized plane
+        Eigen::Vector2<T> pInCamPlane(pInCam(0) / pInCam(2), pInCam(1) / pInCam(2));
+        // add distortion
+        pInCamPlane = Helper::template AddDistortion<T>(DIST_COEFFS, pInCamPlane);
+
+        Eigen::Vector2<T> pixelPred;
+        Helper::template TransformCamToImg<T>(&FX, &FY, &CX, &CY, pInCamPlane, &pixelPred);
+
+        Eigen::Map<Eigen::Vector2<T>> residuals(sResiduals);
+        residuals = pixelPred - _pair.pixel2d.cast<T>();
         residuals = T(_weight) * residuals;
 
         return true;
@@ -198,6 +352,7 @@ public:
 };
 
 extern template struct VisualProjectionFactor<Configor::Prior::SplineOrder>;
+extern template struct VisualProjectionFixedTOFactor<Configor::Prior::SplineOrder>;
 
 struct VisualDiscreteProjectionFactor {
 private:
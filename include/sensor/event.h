@@ -32,25 +32,52 @@
 #include "sensor/event.h"
 #include "Eigen/Dense"
 #include "cereal/cereal.hpp"
+#include "memory"
+#include "vector"
 
 namespace ns_ekalibr {
+/**
+ * the time domain of events: timestamps are stored in the raw domain and this bias is subtracted
+ * when they are read (and added when written), so that re-basing the time of a chunk of events is
+ * performed by setting the bias of its domain, rather than rewriting each event
+ */
+struct EventTimeDomain : public std::enable_shared_from_this<EventTimeDomain> {
+public:
+    using Ptr = std::shared_ptr<EventTimeDomain>;
+
+    double bias;
+
+    explicit EventTimeDomain(double bias = 0.0);
+
+    static Ptr Create(double bias = 0.0);
+};
+
 class Event {
 public:
     using Ptr = std::shared_ptr<Event>;
     using PosType = Eigen::Vector2<std::uint16_t>;
 
 private:
-    // the timestamp of this event
+    // the timestamp of this event in the raw time domain, see 'EventTimeDomain'
     double _timestamp;
     PosType _pos;
     bool _polarity;
+    // the time domain, owned by event arrays holding this event, 'nullptr' for a zero bias
+    EventTimeDomain* _domain;
 
 public:
-    explicit Event(double timestamp = -1.0, PosType pos = PosType::Zero(), bool polarity = {});
+    /**
+     * @param timestamp the timestamp in the raw time domain of 'domain'
+     */
+    explicit Event(double timestamp = -1.0,
+                   PosType pos = PosType::Zero(),
+                   bool polarity = {},
+                   EventTimeDomain* domain = nullptr);
 
     static Ptr Create(double timestamp = -1.0,
                       const PosType& pos = PosType::Zero(),
-                      bool polarity = {});
+                      bool polarity = {},
+                      EventTimeDomain* domain = nullptr);
 
     [[nodiscard]] double GetTimestamp() const;
 
@@ -60,14 +87,28 @@ public:
 
     [[nodiscard]] bool GetPolarity() const;
 
+    [[nodiscard]] EventTimeDomain* GetTimeDomain() const;
+
+    // move this event into another time domain, the timestamp read is kept
+    void SetTimeDomain(EventTimeDomain* domain);
+
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 public:
+    // the biased timestamp is archived, so that archives are independent of time domains
     template <class Archive>
-    void serialize(Archive& ar) {
+    void save(Archive& ar) const {
+        const double timestamp = GetTimestamp();
+        ar(cereal::make_nvp("timestamp", timestamp), cereal::make_nvp("pos", _pos),
+           cereal::make_nvp("polarity", _polarity));
+    }
+
+    template <class Archive>
+    void load(Archive& ar) {
         ar(cereal::make_nvp("timestamp", _timestamp), cereal::make_nvp("pos", _pos),
            cereal::make_nvp("polarity", _polarity));
+        _domain = nullptr;
     }
 };
 
@@ -76,13 +117,24 @@ public:
     using Ptr = std::shared_ptr<EventArray>;
 
 private:
+    // the timestamp of this array in the raw domain of the first time domain
     double _timestamp;
     std::vector<Event::Ptr> _events;
+    // time domains of events (the first one is also that of this array), kept alive by the array
+    std::vector<EventTimeDomain::Ptr> _domains;
 
 public:
-    explicit EventArray(double timestamp = -1.0, const std::vector<Event::Ptr>& events = {});
+    /**
+     * @param timestamp the (biased) timestamp of this array
+     * @param domains the time domains of 'events', collected from them if empty
+     */
+    explicit EventArray(double timestamp = -1.0,
+                        const std::vector<Event::Ptr>& events = {},
+                        const std::vector<EventTimeDomain::Ptr>& domains = {});
 
-    static Ptr Create(double timestamp = -1.0, const std::vector<Event::Ptr>& events = {});
+    static Ptr Create(double timestamp = -1.0,
+                      const std::vector<Event::Ptr>& events = {},
+                      const std::vector<EventTimeDomain::Ptr>& domains = {});
 
     [[nodiscard]] double GetTimestamp() const;
 
@@ -90,15 +142,66 @@ public:
 
     void SetTimestamp(double timestamp);
 
+    [[nodiscard]] const std::vector<EventTimeDomain::Ptr>& GetTimeDomains() const;
+
+    /**
+     * set the bias of time domains of this array, i.e., timestamps of the array and its events are
+     * re-based without rewriting events. Arrays sharing these domains are re-based as well
+     */
+    void SetTimeBias(double bias);
+
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
+protected:
+    void CollectTimeDomains();
+
 public:
     template <class Archive>
-    void serialize(Archive& ar) {
+    void save(Archive& ar) const {
+        const double timestamp = GetTimestamp();
+        ar(cereal::make_nvp("timestamp", timestamp), cereal::make_nvp("events", _events));
+    }
+
+    /**
+     * loaded events (those not shared with arrays loaded before) are moved into a new time domain
+     * of this array while deserializing, so that loaders re-base them by 'SetTimeBias'
+     */
+    template <class Archive>
+    void load(Archive& ar) {
         ar(cereal::make_nvp("timestamp", _timestamp), cereal::make_nvp("events", _events));
+        _domains = {EventTimeDomain::Create()};
+        for (const auto& event : _events) {
+            if (event->GetTimeDomain() == nullptr) {
+                event->SetTimeDomain(_domains.front().get());
+            }
+        }
+        CollectTimeDomains();
     }
 };
+
+/**
+ * events of a sequence of arrays addressed by serials, i.e., indices in the concatenated sequence,
+ * which is also the order they are ingested into an 'ActiveEventSurface'
+ */
+class EventSerialIndex {
+public:
+    using Ptr = std::shared_ptr<EventSerialIndex>;
+
+private:
+    std::vector<EventArray::Ptr> _arrays;
+    // serial of the first event of each array, and the total event count at the end
+    std::vector<std::int64_t> _offsets;
+
+public:
+    explicit EventSerialIndex(const std::vector<EventArray::Ptr>& arrays);
+
+    static Ptr Create(const std::vector<EventArray::Ptr>& arrays);
+
+    [[nodiscard]] const Event::Ptr& At(std::int64_t serial) const;
+
+    [[nodiscard]] std::int64_t Size() const;
+};
 }  // namespace ns_ekalibr
 
 #endif  // EVENT_H
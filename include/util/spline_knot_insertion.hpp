@@ -0,0 +1,110 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SPLINE_KNOT_INSERTION_HPP
+#define SPLINE_KNOT_INSERTION_HPP
+
+#include "Eigen/Dense"
+#include "sophus/so3.hpp"
+#include "algorithm"
+#include "cmath"
+
+namespace ns_ekalibr {
+/**
+ * Dyadic knot insertion of uniform cubic B-splines (ctraj splines of order 4), i.e., control points
+ * of a spline whose knot distance is half of another one are obtained analytically, so that it
+ * represents the same curve. Control point 'j' of a cubic spline is located at 't0 + (j - 1) * dt',
+ * new control points located at old ones and at midpoints are given by the subdivision masks
+ * '(1, 6, 1) / 8' and '(1, 1) / 2' respectively. For rotation splines, masks are applied in the
+ * tangent space of the central control point, which is exact for rotations about a fixed axis and
+ * accurate to second order otherwise.
+ */
+class SplineKnotInsertion {
+public:
+    /**
+     * @param fine the spline to be set, whose knot distance is half of that of the coarse one, and
+     * whose knots are aligned to those of the coarse one
+     * @return false if the knot grids of two splines are not aligned
+     */
+    template <class SplineType>
+    static bool Dyadic(const SplineType &coarse, SplineType &fine) {
+        const double dtCoarse = coarse.GetTimeInterval(), dtFine = fine.GetTimeInterval();
+        // position of the first control point of the fine spline in the coarse grid (in halves)
+        const double offset = 2.0 * (fine.MinTime() - coarse.MinTime()) / dtCoarse;
+        const int halfOffset = static_cast<int>(std::lround(offset));
+        if (std::abs(dtFine * 2.0 - dtCoarse) > 1E-9 * dtCoarse ||
+            std::abs(offset - halfOffset) > 1E-6) {
+            return false;
+        }
+        const int coarseCount = static_cast<int>(coarse.GetKnots().size());
+        auto Knot = [&coarse, coarseCount](int j) {
+            // knots out of the coarse spline are extrapolated constantly
+            return coarse.GetKnot(std::clamp(j, 0, coarseCount - 1));
+        };
+        for (int m = 0; m < static_cast<int>(fine.GetKnots().size()); ++m) {
+            // fine control point 'm' is located at coarse index 'q / 2'
+            const int q = m + 1 + halfOffset;
+            if (q % 2 == 0) {
+                fine.GetKnot(m) = Vertex(Knot(q / 2 - 1), Knot(q / 2), Knot(q / 2 + 1));
+            } else {
+                const int j = (q - 1) / 2;
+                fine.GetKnot(m) = Edge(Knot(j), Knot(j + 1));
+            }
+        }
+        return true;
+    }
+
+protected:
+    template <class Scalar, int Dim>
+    static Eigen::Matrix<Scalar, Dim, 1> Vertex(const Eigen::Matrix<Scalar, Dim, 1> &prev,
+                                                const Eigen::Matrix<Scalar, Dim, 1> &cur,
+                                                const Eigen::Matrix<Scalar, Dim, 1> &next) {
+        return (prev + 6.0 * cur + next) / 8.0;
+    }
+
+    template <class Scalar, int Dim>
+    static Eigen::Matrix<Scalar, Dim, 1> Edge(const Eigen::Matrix<Scalar, Dim, 1> &cur,
+                                              const Eigen::Matrix<Scalar, Dim, 1> &next) {
+        return (cur + next) * 0.5;
+    }
+
+    static Sophus::SO3d Vertex(const Sophus::SO3d &prev,
+                               const Sophus::SO3d &cur,
+                               const Sophus::SO3d &next) {
+        const Sophus::SO3d::Tangent delta =
+            ((cur.inverse() * prev).log() + (cur.inverse() * next).log()) / 8.0;
+        return cur * Sophus::SO3d::exp(delta);
+    }
+
+    static Sophus::SO3d Edge(const Sophus::SO3d &cur, const Sophus::SO3d &next) {
+        return cur * Sophus::SO3d::exp((cur.inverse() * next).log() * 0.5);
+    }
+};
+}  // namespace ns_ekalibr
+
+#endif  // SPLINE_KNOT_INSERTION_HPP
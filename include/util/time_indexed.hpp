@@ -0,0 +1,169 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef TIME_INDEXED_HPP
+#define TIME_INDEXED_HPP
+
+#include "vector"
+#include "memory"
+#include "algorithm"
+#include "cmath"
+
+namespace ns_ekalibr {
+/**
+ * A time index over a chronological sequence of messages (imu frames, event arrays, camera frames,
+ * i.e., anything providing 'GetTimestamp()'). Ranges are extracted by binary search and returned
+ * as views of the sequence rather than copies, the sequence must outlive the index. If a bucket
+ * width is given, the first message of each time bucket is recorded, so that the binary search is
+ * restricted to a single bucket, i.e., O(1) expected for (roughly) uniformly sampled sequences.
+ */
+template <class MsgType>
+class TimeIndexed {
+public:
+    using Ptr = std::shared_ptr<TimeIndexed>;
+    using MsgPtr = std::shared_ptr<MsgType>;
+    using Container = std::vector<MsgPtr>;
+    using ConstIter = typename Container::const_iterator;
+
+    struct View {
+        ConstIter first, last;
+
+        [[nodiscard]] ConstIter begin() const { return first; }
+
+        [[nodiscard]] ConstIter end() const { return last; }
+
+        [[nodiscard]] std::size_t size() const { return std::distance(first, last); }
+
+        [[nodiscard]] bool empty() const { return first == last; }
+
+        [[nodiscard]] const MsgPtr &front() const { return *first; }
+
+        [[nodiscard]] const MsgPtr &back() const { return *std::prev(last); }
+    };
+
+private:
+    const Container &_seq;
+
+    double _bucketStart;
+    double _bucketWidthInv;
+    // index of the first message not before the start of each bucket, and the size of the sequence
+    std::vector<std::size_t> _buckets;
+
+public:
+    explicit TimeIndexed(const Container &seq, double bucketWidth = 0.0)
+        : _seq(seq),
+          _bucketStart(0.0),
+          _bucketWidthInv(0.0) {
+        if (bucketWidth <= 0.0 || _seq.size() < 2) {
+            return;
+        }
+        _bucketStart = _seq.front()->GetTimestamp();
+        _bucketWidthInv = 1.0 / bucketWidth;
+        // buckets of messages are computed in the same way as queries, see 'Bucket'
+        const auto count = static_cast<std::size_t>(BucketOf(_seq.back()->GetTimestamp())) + 1;
+        _buckets.resize(count + 1);
+        std::size_t b = 0;
+        for (std::size_t idx = 0; idx < _seq.size(); ++idx) {
+            const auto bIdx = static_cast<std::size_t>(BucketOf(_seq[idx]->GetTimestamp()));
+            while (b <= bIdx) {
+                _buckets[b++] = idx;
+            }
+        }
+        _buckets[count] = _seq.size();
+    }
+
+    static Ptr Create(const Container &seq, double bucketWidth = 0.0) {
+        return std::make_shared<TimeIndexed>(seq, bucketWidth);
+    }
+
+    [[nodiscard]] const Container &Sequence() const { return _seq; }
+
+    /**
+     * the first message whose timestamp is not less than 't'
+     */
+    [[nodiscard]] ConstIter LowerBound(double t) const {
+        auto [sIter, eIter] = Bucket(t);
+        return std::lower_bound(sIter, eIter, t, [](const MsgPtr &msg, double time) {
+            return msg->GetTimestamp() < time;
+        });
+    }
+
+    /**
+     * the first message whose timestamp is greater than 't'
+     */
+    [[nodiscard]] ConstIter UpperBound(double t) const {
+        auto [sIter, eIter] = Bucket(t);
+        return std::upper_bound(sIter, eIter, t, [](double time, const MsgPtr &msg) {
+            return time < msg->GetTimestamp();
+        });
+    }
+
+    /**
+     * messages in the closed range [st, et]
+     */
+    [[nodiscard]] View Range(double st, double et) const {
+        auto sIter = LowerBound(st);
+        return View{sIter, std::max(sIter, UpperBound(et))};
+    }
+
+    /**
+     * messages in the open range (st, et)
+     */
+    [[nodiscard]] View OpenRange(double st, double et) const {
+        auto sIter = UpperBound(st);
+        return View{sIter, std::max(sIter, LowerBound(et))};
+    }
+
+protected:
+    /**
+     * the sub range of the sequence that contains both bounds of 't'
+     */
+    [[nodiscard]] std::pair<ConstIter, ConstIter> Bucket(double t) const {
+        if (_buckets.empty()) {
+            return {_seq.cbegin(), _seq.cend()};
+        }
+        const double b = BucketOf(t);
+        if (b < 0.0) {
+            return {_seq.cbegin(), _seq.cbegin() + _buckets.front()};
+        } else if (b >= static_cast<double>(_buckets.size() - 1)) {
+            return {_seq.cbegin() + _buckets.back(), _seq.cend()};
+        }
+        const auto idx = static_cast<std::size_t>(b);
+        return {_seq.cbegin() + _buckets[idx], _seq.cbegin() + _buckets[idx + 1]};
+    }
+
+    /**
+     * the floating-point floor is monotonic, so buckets of messages and queries are consistent
+     */
+    [[nodiscard]] double BucketOf(double t) const {
+        return std::floor((t - _bucketStart) * _bucketWidthInv);
+    }
+};
+}  // namespace ns_ekalibr
+
+#endif  // TIME_INDEXED_HPP
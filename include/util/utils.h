@@ -53,6 +53,11 @@ double LagrangePolynomial(Type xQuery,
                           const std::array<Type, N> &xData,
                           const std::array<Type, N> &yData);
 
+// given n x values and a x query, compute the lagrange basis weights, so that the y value of any
+// data series sampled on 'xData' is the weighted sum of its y values
+template <class Type, int N>
+std::array<Type, N> LagrangeBasis(Type xQuery, const std::array<Type, N> &xData);
+
 // given three points, compute the first order of the middle point using lagrange polynomial
 template <class Type>
 Type LagrangePolynomialTripleMidFOD(const std::array<Type, 3> &xData,
@@ -53,6 +53,24 @@ double LagrangePolynomial(Type xQuery,
     return y;
 }
 
+// given n x values and a x query, compute the lagrange basis weights, so that the y value of any
+// data series sampled on 'xData' is the weighted sum of its y values
+template <class Type, int N>
+std::array<Type, N> LagrangeBasis(Type xQuery, const std::array<Type, N> &xData) {
+    std::array<Type, N> basis;
+    for (int i = 0; i < N; ++i) {
+        Type li = 1.0;
+        for (int j = 0; j < N; ++j) {
+            if (j == i) {
+                continue;
+            }
+            li *= (xQuery - xData[j]) / (xData[i] - xData[j]);
+        }
+        basis[i] = li;
+    }
+    return basis;
+}
+
 // given three points, compute the first order of the middle point using lagrange polynomial
 template <class Type>
 Type LagrangePolynomialTripleMidFOD(const std::array<Type, 3> &xData,
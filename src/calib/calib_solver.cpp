@@ -45,10 +45,13 @@
 #include "calib/ceres_callback.h"
 #include <calib/calib_param_mgr.h>
 #include <core/circle_grid.h>
+#include "core/event_denoiser.h"
 #include "tiny-viewer/entity/utils.h"
 #include "factor/visual_projection_factor.hpp"
 #include "calib/spat_temp_priori.h"
 #include <core/time_varying_ellipse.h>
+#include "Eigen/Sparse"
+#include "algorithm"
 
 namespace ns_ekalibr {
 CalibSolver::CalibSolver(CalibParamManagerPtr parMgr)
@@ -231,54 +234,47 @@ void CalibSolver::LoadDataFromRosBag() {
     _dataRawTimestamp.second = *std::min_element(eTimeList.begin(), eTimeList.end());
 
     for (const auto &[topic, _] : _evMes) {
-        // remove event data arrays that are before the start time stamp
-        EraseSeqHeadData<EventArray>(
-            _evMes.at(topic),
-            [this](const EventArray::Ptr &ary) {
-                return ary->GetTimestamp() > _dataRawTimestamp.first - 1E-9;
-            },
+        // remove event data arrays that are before the start time stamp or after the end one
+        EraseSeqDataOutOfRange<EventArray>(
+            _evMes.at(topic), _dataRawTimestamp.first - 1E-9, _dataRawTimestamp.second + 1E-9,
             "the event data is invalid, there is no data intersection between sensors.");
+    }
 
-        // remove event data arrays that are after the end time stamp
-        EraseSeqTailData<EventArray>(
-            _evMes.at(topic),
-            [this](const EventArray::Ptr &ary) {
-                return ary->GetTimestamp() < _dataRawTimestamp.second + 1E-9;
-            },
-            "the event data is invalid, there is no data intersection between sensors.");
+    /**
+     * denoise event data, noise events would never be part of circle edges but pass through all
+     * tracking stages
+     */
+    const auto &dnConfig = Configor::Prior::EventDenoiser;
+    if (dnConfig.BackgroundActivityWindow > 0.0 || dnConfig.RefractoryPeriod > 0.0 ||
+        dnConfig.HotPixelSigma > 0.0) {
+        for (auto &[topic, mes] : _evMes) {
+            const auto &config = Configor::DataStream::EventTopics.at(topic);
+            auto denoiser = EventDenoiser::Create(
+                config.Width, config.Height, dnConfig.BackgroundActivityWindow,
+                dnConfig.RefractoryPeriod, dnConfig.HotPixelSigma);
+            denoiser->DetectHotPixels(mes);
+            mes = denoiser->Filter(mes);
+
+            const auto &stats = denoiser->GetStatistics();
+            spdlog::info(
+                "denoise events of camera '{}': {}. downstream stages ingest '{:.2f}' times fewer "
+                "events",
+                topic, stats.InfoString(),
+                static_cast<double>(stats.total) /
+                    static_cast<double>(std::max<std::size_t>(1, stats.total - stats.Removed())));
+        }
     }
-    for (const auto &[topic, _] : _imuMes) {
-        // remove imu data arrays that are before the start time stamp
-        EraseSeqHeadData<IMUFrame>(
-            _imuMes.at(topic),
-            [this](const IMUFrame::Ptr &ary) {
-                return ary->GetTimestamp() > _dataRawTimestamp.first - 1E-9;
-            },
-            "the imu data is invalid, there is no data intersection between sensors.");
 
-        // remove imu data arrays that are after the end time stamp
-        EraseSeqTailData<IMUFrame>(
-            _imuMes.at(topic),
-            [this](const IMUFrame::Ptr &ary) {
-                return ary->GetTimestamp() < _dataRawTimestamp.second + 1E-9;
-            },
+    for (const auto &[topic, _] : _imuMes) {
+        // remove imu data arrays that are before the start time stamp or after the end one
+        EraseSeqDataOutOfRange<IMUFrame>(
+            _imuMes.at(topic), _dataRawTimestamp.first - 1E-9, _dataRawTimestamp.second + 1E-9,
             "the imu data is invalid, there is no data intersection between sensors.");
     }
     for (const auto &[topic, _] : _frameMes) {
-        // remove frame data arrays that are before the start time stamp
-        EraseSeqHeadData<Frame>(
-            _frameMes.at(topic),
-            [this](const Frame::Ptr &ary) {
-                return ary->GetTimestamp() > _dataRawTimestamp.first - 1E-9;
-            },
-            "the frame data is invalid, there is no data intersection between sensors.");
-
-        // remove frame data arrays that are after the end time stamp
-        EraseSeqTailData<Frame>(
-            _frameMes.at(topic),
-            [this](const Frame::Ptr &ary) {
-                return ary->GetTimestamp() < _dataRawTimestamp.second + 1E-9;
-            },
+        // remove frame data arrays that are before the start time stamp or after the end one
+        EraseSeqDataOutOfRange<Frame>(
+            _frameMes.at(topic), _dataRawTimestamp.first - 1E-9, _dataRawTimestamp.second + 1E-9,
             "the frame data is invalid, there is no data intersection between sensors.");
     }
 
@@ -290,12 +286,8 @@ void CalibSolver::LoadDataFromRosBag() {
     _dataAlignedTimestamp.second = _dataRawTimestamp.second - _dataRawTimestamp.first;
     for (const auto &[eventTopic, mes] : _evMes) {
         for (const auto &array : mes) {
-            // array
-            array->SetTimestamp(array->GetTimestamp() - _dataRawTimestamp.first);
-            // targets
-            for (auto &tar : array->GetEvents()) {
-                tar->SetTimestamp(tar->GetTimestamp() - _dataRawTimestamp.first);
-            }
+            // array and its events (targets), re-based lazily by the bias of their time domain
+            array->SetTimeBias(_dataRawTimestamp.first);
         }
     }
     for (const auto &[imuTopic, mes] : _imuMes) {
@@ -380,17 +372,308 @@ CalibSolver::PosSplineType CalibSolver::CreatePosSpline(double st,
     return posSpline;
 }
 
-void CalibSolver::CreateSplineSegments(double dtSo3, double dtPos, bool printInfo) {
+void CalibSolver::CreateSplineSegments(double dtSo3,
+                                       double dtPos,
+                                       bool printInfo,
+                                       bool adaptiveKnots) {
     _splineSegments.clear();
     _splineSegments.reserve(_validTimeSegments.size());
+    std::size_t so3KnotCount = 0, posKnotCount = 0;
     for (auto &[st, et] : _validTimeSegments) {
-        auto so3Spline = CreateSo3Spline(st, et, dtSo3, printInfo);
-        auto posSpline = CreatePosSpline(st, et, dtPos, printInfo);
+        auto [segDtSo3, segDtPos] = adaptiveKnots ? AdaptiveKnotTimeDist(st, et, dtSo3, dtPos)
+                                                  : std::make_pair(dtSo3, dtPos);
+        auto so3Spline = CreateSo3Spline(st, et, segDtSo3, printInfo);
+        auto posSpline = CreatePosSpline(st, et, segDtPos, printInfo);
+        so3KnotCount += so3Spline.GetKnots().size();
+        posKnotCount += posSpline.GetKnots().size();
         _splineSegments.emplace_back(so3Spline, posSpline);
 
         st = std::min(so3Spline.MinTime(), posSpline.MinTime());
         et = std::max(so3Spline.MaxTime(), posSpline.MaxTime());
     }
+    if (adaptiveKnots) {
+        spdlog::info(
+            "control points of '{}' spline segments with adaptive knots, so3: '{}', pos: '{}'",
+            _splineSegments.size(), so3KnotCount, posKnotCount);
+    }
+}
+
+void CalibSolver::AlignTimeSegmentsToKnotGrid(const So3SplineType &spline) {
+    const double t0 = spline.MinTime(), dt = spline.GetTimeInterval();
+    double lastEt = std::numeric_limits<double>::lowest();
+    for (auto &[st, et] : _validTimeSegments) {
+        // the nearest knot time not after the start time
+        const double alignedSt = t0 + std::floor((st - t0) / dt + 1E-6) * dt;
+        if (alignedSt >= std::max(lastEt, t0)) {
+            st = alignedSt;
+        }
+        lastEt = et;
+    }
+}
+
+void CalibSolver::SelectInformativeTimeSegments() {
+    const auto &config = Configor::Prior::InformativeSegments;
+    const auto &refIMUTopic = Configor::DataStream::RefIMUTopic;
+    if (config.BudgetRatio >= 1.0 || _validTimeSegments.empty() ||
+        _imuMes.count(refIMUTopic) == 0) {
+        return;
+    }
+
+    // split valid time segments into windows no shorter than 'WindowLength' (if possible)
+    struct Window {
+        double st, et;
+        // information of extrinsic rotation, extrinsic translation, and accelerometer excitation
+        Eigen::Matrix<double, 9, 9> info = Eigen::Matrix<double, 9, 9>::Zero();
+        double gridCount = 0.0;
+    };
+    std::vector<Window> windows;
+    double totalTime = 0.0;
+    for (const auto &[st, et] : _validTimeSegments) {
+        const int count =
+            std::max(1, static_cast<int>(std::floor((et - st) / config.WindowLength)));
+        const double len = (et - st) / count;
+        for (int i = 0; i < count; ++i) {
+            windows.push_back({st + i * len, i == count - 1 ? et : st + (i + 1) * len});
+        }
+        totalTime += et - st;
+    }
+
+    // grid tracking density, i.e., the count of tracked grids of all cameras in each window
+    for (const auto &[topic, patterns] : _extractedPatterns) {
+        const double TO_CjToBr = _parMgr->TEMPORAL.TO_CjToBr.at(topic);
+        const auto &grid2dVec = patterns->GetGrid2d();
+        auto LowerBound = [&grid2dVec, TO_CjToBr](double t) {
+            return std::lower_bound(grid2dVec.cbegin(), grid2dVec.cend(), t - TO_CjToBr,
+                                    [](const auto &grid2d, double time) {
+                                        return grid2d->timestamp < time;
+                                    });
+        };
+        for (auto &window : windows) {
+            window.gridCount +=
+                static_cast<double>(std::distance(LowerBound(window.st), LowerBound(window.et)));
+        }
+    }
+
+    /**
+     * information of calibration parameters is approximated using the inertial measurements of
+     * the reference imu: the extrinsic rotation is observable from angular velocities (hand-eye
+     * like, i.e., '-[w]x^2'), the extrinsic translation from the lever-arm effect (i.e.,
+     * '([dw]x + [w]x^2) * p'), and the gravity and scale from the variation of specific forces
+     */
+    const double TO_BiToBr = _parMgr->TEMPORAL.TO_BiToBr.at(refIMUTopic);
+    const auto imuIndex = TimeIndexed<IMUFrame>(_imuMes.at(refIMUTopic));
+#pragma omp parallel for
+    for (int i = 0; i < static_cast<int>(windows.size()); ++i) {
+        auto &window = windows.at(i);
+        const auto frames = imuIndex.Range(window.st - TO_BiToBr, window.et - TO_BiToBr);
+        if (frames.size() < 3) {
+            continue;
+        }
+        Eigen::Vector3d meanAcce = Eigen::Vector3d::Zero();
+        for (const auto &frame : frames) {
+            meanAcce += frame->GetAcce();
+        }
+        meanAcce /= static_cast<double>(frames.size());
+
+        const auto frameIter = frames.begin();
+        for (int j = 1; j < static_cast<int>(frames.size()) - 1; ++j) {
+            const Eigen::Vector3d &gyro = frameIter[j]->GetGyro();
+            const Eigen::Vector3d angAcce =
+                (frameIter[j + 1]->GetGyro() - frameIter[j - 1]->GetGyro()) /
+                (frameIter[j + 1]->GetTimestamp() - frameIter[j - 1]->GetTimestamp());
+            const Eigen::Matrix3d gyroHat = Sophus::SO3d::hat(gyro);
+            const Eigen::Matrix3d leverArm = Sophus::SO3d::hat(angAcce) + gyroHat * gyroHat;
+            const Eigen::Vector3d acceVar = frameIter[j]->GetAcce() - meanAcce;
+
+            window.info.block<3, 3>(0, 0) += gyroHat.transpose() * gyroHat;
+            window.info.block<3, 3>(3, 3) += leverArm.transpose() * leverArm;
+            window.info.block<3, 3>(6, 6) += acceVar * acceVar.transpose();
+        }
+    }
+
+    // weight by the grid tracking density, and normalize each kind of information (different
+    // units) to have an average eigenvalue of one over all windows
+    double meanGridCount = 0.0;
+    for (const auto &window : windows) {
+        meanGridCount += window.gridCount / static_cast<double>(windows.size());
+    }
+    Eigen::Matrix<double, 9, 9> totalInfo = Eigen::Matrix<double, 9, 9>::Zero();
+    for (auto &window : windows) {
+        window.info *= meanGridCount > 0.0 ? window.gridCount / meanGridCount : 1.0;
+        totalInfo += window.info;
+    }
+    for (int k = 0; k < 3; ++k) {
+        const double scale = totalInfo.block<3, 3>(k * 3, k * 3).trace() / 3.0;
+        if (scale <= 0.0) {
+            continue;
+        }
+        for (auto &window : windows) {
+            window.info.block<3, 3>(k * 3, k * 3) /= scale;
+        }
+    }
+
+    auto LogDet = [](const Eigen::Matrix<double, 9, 9> &mat) {
+        const Eigen::LLT<Eigen::Matrix<double, 9, 9>> llt(mat);
+        return 2.0 * llt.matrixLLT().diagonal().array().log().sum();
+    };
+
+    /**
+     * the log-determinant is submodular, thus windows are greedily kept by the gain of the
+     * log-determinant per second until the budget is reached. A small prior keeps it finite
+     */
+    const double budget = config.BudgetRatio * totalTime;
+    Eigen::Matrix<double, 9, 9> selectedInfo =
+        1E-3 / static_cast<double>(windows.size()) * Eigen::Matrix<double, 9, 9>::Identity();
+    double selectedLogDet = LogDet(selectedInfo), selectedTime = 0.0;
+    std::vector<bool> selected(windows.size(), false);
+    while (true) {
+        int bestIdx = -1;
+        double bestGain = 0.0;
+        for (int i = 0; i < static_cast<int>(windows.size()); ++i) {
+            const auto &window = windows.at(i);
+            // the first kept window is allowed to exceed the budget
+            if (selected.at(i) ||
+                (selectedTime > 0.0 && selectedTime + window.et - window.st > budget)) {
+                continue;
+            }
+            const double gain =
+                (LogDet(selectedInfo + window.info) - selectedLogDet) / (window.et - window.st);
+            if (gain > bestGain) {
+                bestIdx = i, bestGain = gain;
+            }
+        }
+        if (bestIdx == -1) {
+            break;
+        }
+        const auto &window = windows.at(bestIdx);
+        selected.at(bestIdx) = true;
+        selectedInfo += window.info;
+        selectedLogDet = LogDet(selectedInfo);
+        selectedTime += window.et - window.st;
+    }
+
+    // adjacent kept windows are merged, those from different segments are never adjacent
+    std::list<std::pair<double, double>> segBoundary;
+    for (int i = 0; i < static_cast<int>(windows.size()); ++i) {
+        if (selected.at(i)) {
+            segBoundary.emplace_back(windows.at(i).st, windows.at(i).et);
+        }
+    }
+    _validTimeSegments = ContinuousSegments(segBoundary, 1E-6 /*neighbor*/);
+
+    std::stringstream ss;
+    for (const auto &[sTime, eTime] : _validTimeSegments) {
+        ss << fmt::format("({:.3f}, {:.3f}) ", sTime, eTime);
+    }
+    spdlog::info(
+        "keep '{}' of '{}' windows as informative time segments, time: '{:.3f}' of '{:.3f}', "
+        "log-determinant of information: '{:.3f}', details:\n{}",
+        std::count(selected.cbegin(), selected.cend(), true), windows.size(), selectedTime,
+        totalTime, selectedLogDet, ss.str());
+}
+
+std::pair<double, double> CalibSolver::AdaptiveKnotTimeDist(double st,
+                                                            double et,
+                                                            double dtSo3,
+                                                            double dtPos) const {
+    const auto &config = Configor::Prior::AdaptiveKnots;
+    const auto &refIMUTopic = Configor::DataStream::RefIMUTopic;
+    if (config.MaxLevel == 0 || _imuMes.count(refIMUTopic) == 0) {
+        return {dtSo3, dtPos};
+    }
+
+    // inertial measurements of the reference imu in this time range
+    const double TO_BiToBr = _parMgr->TEMPORAL.TO_BiToBr.at(refIMUTopic);
+    const auto frames =
+        TimeIndexed<IMUFrame>(_imuMes.at(refIMUTopic)).Range(st - TO_BiToBr, et - TO_BiToBr);
+    if (frames.size() < static_cast<std::size_t>(2 * Configor::Prior::SplineOrder)) {
+        return {dtSo3, dtPos};
+    }
+    std::vector<std::pair<double, Eigen::Vector3d>> angVels, accels;
+    angVels.reserve(frames.size());
+    accels.reserve(frames.size());
+    for (const auto &frame : frames) {
+        angVels.emplace_back(frame->GetTimestamp() + TO_BiToBr, frame->GetGyro());
+        accels.emplace_back(frame->GetTimestamp() + TO_BiToBr, frame->GetAcce());
+    }
+
+    /**
+     * angular velocities and accelerations are the first-order derivatives of the so3 spline and
+     * the second-order derivatives of the pos spline respectively, i.e., B-splines of order 3 and
+     * 2 with the same knot distances. The largest level keeping the fitting error is selected
+     */
+    auto SelectLevel = [&config, st, et](
+                           const std::vector<std::pair<double, Eigen::Vector3d>> &data, double dt,
+                           int order, double tolerance) {
+        const double baseError = UniformBSplineFittingRMSE(data, st, et, dt, order);
+        int level = 0;
+        while (level < config.MaxLevel &&
+               UniformBSplineFittingRMSE(data, st, et, dt * (2 << level), order) <=
+                   baseError + tolerance) {
+            ++level;
+        }
+        return level;
+    };
+    const int so3Level = SelectLevel(angVels, dtSo3, Configor::Prior::SplineOrder - 1,
+                                     config.GyroFitTolerance);
+    const int posLevel = SelectLevel(accels, dtPos, Configor::Prior::SplineOrder - 2,
+                                     config.AcceFitTolerance);
+
+    return {dtSo3 * (1 << so3Level), dtPos * (1 << posLevel)};
+}
+
+double CalibSolver::UniformBSplineFittingRMSE(
+    const std::vector<std::pair<double, Eigen::Vector3d>> &samples,
+    double st,
+    double et,
+    double dt,
+    int order) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const int spanCount = std::max(1, static_cast<int>(std::ceil((et - st) / dt)));
+    const int ctrlCount = spanCount + order - 1;
+
+    // nonzero basis values at 'u' in a span, using the recursion of uniform B-splines:
+    // b_d[j] = (d - j + u) / d * b_{d-1}[j - 1] + (j + 1 - u) / d * b_{d-1}[j]
+    auto Basis = [order](double u) {
+        std::vector<double> b(order, 0.0);
+        b[0] = 1.0;
+        for (int d = 1; d < order; ++d) {
+            for (int j = d; j >= 0; --j) {
+                const double left = j > 0 ? (d - j + u) / d * b[j - 1] : 0.0;
+                const double right = j < d ? (j + 1 - u) / d * b[j] : 0.0;
+                b[j] = left + right;
+            }
+        }
+        return b;
+    };
+
+    // banded least-squares problem of control points
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(samples.size() * order);
+    Eigen::MatrixXd values(samples.size(), 3);
+    for (int i = 0; i < static_cast<int>(samples.size()); ++i) {
+        const double s =
+            std::clamp((samples.at(i).first - st) / dt, 0.0, static_cast<double>(spanCount));
+        const int span = std::min(static_cast<int>(s), spanCount - 1);
+        const auto b = Basis(s - span);
+        for (int j = 0; j < order; ++j) {
+            triplets.emplace_back(i, span + j, b.at(j));
+        }
+        values.row(i) = samples.at(i).second.transpose();
+    }
+    Eigen::SparseMatrix<double> A(static_cast<int>(samples.size()), ctrlCount);
+    A.setFromTriplets(triplets.cbegin(), triplets.cend());
+
+    // control points in spans without samples are slightly regularized
+    Eigen::SparseMatrix<double> I(ctrlCount, ctrlCount);
+    I.setIdentity();
+    const Eigen::SparseMatrix<double> H = Eigen::SparseMatrix<double>(A.transpose() * A) + 1E-9 * I;
+    const Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(H);
+    const Eigen::MatrixXd ctrlPoints = solver.solve(A.transpose() * values);
+
+    return std::sqrt((A * ctrlPoints - values).squaredNorm() / static_cast<double>(samples.size()));
 }
 
 std::optional<int> CalibSolver::IsTimeInValidSegment(double timeByBr) const {
@@ -431,27 +714,97 @@ void CalibSolver::CreateVisualProjPairsSyncPointBased() {
     }
 }
 
-void CalibSolver::CreateVisualProjPairsAsyncPointBased(double dt) {
+void CalibSolver::CreateVisualProjPairsAsyncPointBased() {
+    const auto &pairsConfig = Configor::Prior::AsyncProjectionPairs;
     // for event cameras
     for (const auto &[topic, rawEvsVecOfGrids] : _rawEventsOfExtractedPatterns) {
-        auto &corrList = _evAsyncPointProjPairs[topic];
-        corrList.clear();
+        /**
+         * the sample count of each circle is determined by its motion (center and size) in its time
+         * range, so that slowly moving ones, whose samples are nearly identical, are sampled
+         * sparsely. The densest sampling is given by 'MinSamplingInterval'.
+         */
+        struct Sampling {
+            int grid2dIdx;
+            int circleIdx;
+            TimeVaryingEllipse::Ptr tvCircle;
+            int count;
+        };
+        std::vector<Sampling> samplings;
+        std::size_t totalCount = 0;
         for (const auto &[grid2dIdx, rawEvsOfGrids] : rawEvsVecOfGrids) {
-            // correspondences of each grid
             for (int i = 0; i < static_cast<int>(rawEvsOfGrids.size()); i++) {
-                const auto &[tvCircle, evAry] = rawEvsOfGrids.at(i);
-                if (tvCircle == nullptr) {
+                const auto &tvCircle = rawEvsOfGrids.at(i).first;
+                if (tvCircle == nullptr || tvCircle->et <= tvCircle->st) {
                     continue;
                 }
-                for (double t = tvCircle->st; t < tvCircle->et; t += dt) {
-                    const auto &point3d = _grid3d->points.at(i);
-                    const Eigen::Vector3d point(point3d.x, point3d.y, point3d.z);
-                    corrList.push_back(VisualProjectionPair::Create(t, point, tvCircle->PosAt(t)));
+                // identical to sampling with 'for (t = st; t < et; t += MinSamplingInterval)'
+                int count = static_cast<int>(
+                    std::ceil((tvCircle->et - tvCircle->st) / pairsConfig.MinSamplingInterval));
+                if (pairsConfig.PixelsPerSample > 0.0) {
+                    const auto motion = tvCircle->MotionExtent() / pairsConfig.PixelsPerSample;
+                    count = std::clamp(static_cast<int>(std::ceil(motion)), 1, count);
+                }
+                samplings.push_back({grid2dIdx, i, tvCircle, count});
+                totalCount += count;
+            }
+        }
+        /**
+         * thin samples to meet the budget: each circle keeps one sample, and the rest of the budget
+         * is distributed proportionally to the remaining samples (floors plus the largest
+         * remainders). If even one sample per circle exceeds the budget, whole circles are dropped
+         * evenly instead.
+         */
+        const auto maxCount = static_cast<std::size_t>(pairsConfig.MaxPairCount);
+        if (pairsConfig.MaxPairCount > 0 && totalCount > maxCount) {
+            if (samplings.size() > maxCount) {
+                std::vector<Sampling> kept;
+                kept.reserve(maxCount);
+                for (std::size_t j = 0; j < maxCount; ++j) {
+                    kept.push_back(samplings.at(j * samplings.size() / maxCount));
+                    kept.back().count = 1;
+                }
+                samplings = std::move(kept);
+                totalCount = maxCount;
+            } else {
+                const std::size_t extraBudget = maxCount - samplings.size();
+                const std::size_t extraTotal = totalCount - samplings.size();
+                // (remainder, index) of each circle
+                std::vector<std::pair<std::size_t, std::size_t>> remainders;
+                remainders.reserve(samplings.size());
+                totalCount = 0;
+                for (std::size_t j = 0; j < samplings.size(); ++j) {
+                    auto &sampling = samplings.at(j);
+                    const std::size_t extra = (sampling.count - 1) * extraBudget;
+                    sampling.count = 1 + static_cast<int>(extra / extraTotal);
+                    remainders.emplace_back(extra % extraTotal, j);
+                    totalCount += sampling.count;
                 }
+                std::sort(remainders.begin(), remainders.end(),
+                          [](const auto &p1, const auto &p2) { return p1.first > p2.first; });
+                for (std::size_t j = 0; totalCount < maxCount; ++j, ++totalCount) {
+                    ++samplings.at(remainders.at(j).second).count;
+                }
+            }
+        }
+
+        auto &pairs = _evAsyncPointProjPairs[topic];
+        pairs = VisualProjectionPairs::Create();
+        pairs->Reserve(totalCount);
+        for (const auto &[grid2dIdx, circleIdx, tvCircle, count] : samplings) {
+            const auto &point3d = _grid3d->points.at(circleIdx);
+            const Eigen::Vector3d point(point3d.x, point3d.y, point3d.z);
+            // samples spread over the time range, not denser than 'MinSamplingInterval'
+            const double dt =
+                std::max(pairsConfig.MinSamplingInterval, (tvCircle->et - tvCircle->st) / count);
+            for (int k = 0; k < count; ++k) {
+                const double t = tvCircle->st + k * dt;
+                pairs->Push(t, point, tvCircle->PosAt(t), grid2dIdx, circleIdx);
             }
         }
-        spdlog::info("constructed 'VisualProjectionPair:AsyncPointBased' count for camera '{}': {}",
-                     topic, corrList.size());
+        spdlog::info(
+            "constructed 'VisualProjectionPair:AsyncPointBased' count for camera '{}': {}, of {} "
+            "circles",
+            topic, pairs->Size(), samplings.size());
     }
     // for frame cameras
     for (const auto &[topic, config] : Configor::DataStream::EventTopics) {
@@ -463,7 +816,8 @@ void CalibSolver::CreateVisualProjPairsAsyncPointBased(double dt) {
         const auto &grid2dVec = patterns->GetGrid2d();
 
         auto &pairs = _evAsyncPointProjPairs[topic];
-        pairs.clear();
+        pairs = VisualProjectionPairs::Create();
+        pairs->Reserve(grid2dVec.size() * grid3d->points.size());
 
         for (const auto &grid2d : grid2dVec) {
             for (int i = 0; i < static_cast<int>(grid2d->centers.size()); ++i) {
@@ -476,11 +830,11 @@ void CalibSolver::CreateVisualProjPairsAsyncPointBased(double dt) {
                 const auto &point3d = grid3d->points.at(i);
                 const Eigen::Vector3d point(point3d.x, point3d.y, point3d.z);
 
-                pairs.push_back(VisualProjectionPair::Create(grid2d->timestamp, point, pixel));
+                pairs->Push(grid2d->timestamp, point, pixel, grid2d->id, i);
             }
         }
         spdlog::info("create 'VisualProjectionPair:AsyncPointBased' count for camera '{}': {}",
-                     topic, pairs.size());
+                     topic, pairs->Size());
     }
 }
 
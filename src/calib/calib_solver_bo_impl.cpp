@@ -34,6 +34,9 @@
 #include <spdlog/spdlog.h>
 #include "util/utils_tpl.hpp"
 #include "calib/calib_solver_io.h"
+#include "thread"
+#include "numeric"
+#include "algorithm"
 
 namespace ns_ekalibr {
 void CalibSolver::BatchOptimizations() {
@@ -67,10 +70,7 @@ void CalibSolver::BatchOptimizations() {
         }
     }
 
-    enum class VisualProjType { SYNC_POINT_BASED, ASYNC_POINT_BASED };
-    constexpr VisualProjType vpType = VisualProjType::ASYNC_POINT_BASED;
-
-    switch (vpType) {
+    switch (BatchOptVisualProjType) {
         case VisualProjType::SYNC_POINT_BASED: {
             this->CreateVisualProjPairsSyncPointBased();
             break;
@@ -81,6 +81,9 @@ void CalibSolver::BatchOptimizations() {
         }
     }
 
+    const bool partitioned =
+        Configor::Prior::PartitionedSolver.MaxIterations > 0 && _splineSegments.size() > 1;
+
     for (int i = 0; i < static_cast<int>(options.size()); ++i) {
         const auto& option = options.at(i);
         std::stringstream stringStream;
@@ -88,43 +91,270 @@ void CalibSolver::BatchOptimizations() {
         spdlog::info("performing the '{}'-th batch optimization, option:\n{}", i,
                      stringStream.str());
 
+        auto ceresOption = _ceresOption;
+        if (partitioned && this->PartitionedBatchOptimization(option)) {
+            // the joint problem is only used to polish the partitioned solution
+            ceresOption.max_num_iterations = Configor::Prior::PartitionedSolver.PolishIterations;
+        }
+
         auto estimator = Estimator::Create(_parMgr);
+        this->AddBatchOptimizationFactors(estimator, option);
+        // make this problem full rank
+        estimator->SetIMUParamsConstant(Configor::DataStream::RefIMUTopic);
+        auto sum = estimator->Solve(ceresOption, _priori);
+        spdlog::info("here is the summary:\n{}\n", sum.BriefReport());
+        CalibSolverIO::SaveStageCalibParam(_parMgr,
+                                           "visual_inertial_calib_3_bo_" + std::to_string(i));
+    }
+}
 
-        for (const auto& [topic, _] : Configor::DataStream::IMUTopics) {
-            auto s = this->AddAcceFactorToSplineSegments(estimator, topic, option, {}, 100);
+void CalibSolver::AddBatchOptimizationFactors(const EstimatorPtr& estimator,
+                                              OptOption option,
+                                              const std::optional<int>& segIdx,
+                                              bool verbose) {
+    // zero sampling rate means all inertial measurements are involved
+    std::optional<double> imuDsRate;
+    if (Configor::Prior::InertialSamplingRate > 0.0) {
+        imuDsRate = Configor::Prior::InertialSamplingRate;
+    }
+    for (const auto& [topic, _] : Configor::DataStream::IMUTopics) {
+        auto s =
+            this->AddAcceFactorToSplineSegments(estimator, topic, option, {}, imuDsRate, segIdx);
+        if (verbose) {
             spdlog::info("add '{}' 'IMUAcceFactor' for imu '{}'...", s, topic);
+        }
 
-            s = this->AddGyroFactorToSplineSegments(estimator, topic, option, {}, 100);
+        s = this->AddGyroFactorToSplineSegments(estimator, topic, option, {}, imuDsRate, segIdx);
+        if (verbose) {
             spdlog::info("add '{}' 'IMUGyroFactor' for imu '{}'...", s, topic);
         }
+    }
+
+    for (const auto& [topic, _] : Configor::DataStream::EventTopics) {
+        std::size_t s = 0;
+        switch (BatchOptVisualProjType) {
+            case VisualProjType::SYNC_POINT_BASED: {
+                s = this->AddVisualProjPairsSyncPointBasedToSplineSegments(estimator, topic,
+                                                                           option, {}, segIdx);
+                break;
+            }
+            case VisualProjType::ASYNC_POINT_BASED: {
+                s = this->AddVisualProjPairsAsyncPointBasedToSplineSegments(estimator, topic,
+                                                                            option, {}, segIdx);
+                break;
+            }
+        }
+        if (verbose) {
+            spdlog::info("add '{}' 'VisualProjectionFactor' for camera '{}'...", s, topic);
+        }
+    }
+    for (int i = 0; i < static_cast<int>(_splineSegments.size()); ++i) {
+        if (segIdx != std::nullopt && i != *segIdx) {
+            continue;
+        }
+        auto& [so3Spline, posSpline] = _splineSegments.at(i);
+        estimator->AddRegularizationL2Constraint(so3Spline, option, 1E-3);
+        estimator->AddRegularizationL2Constraint(posSpline, option, 1E-3);
+    }
+}
+
+bool CalibSolver::PartitionedBatchOptimization(OptOption option) {
+    const auto& config = Configor::Prior::PartitionedSolver;
+    const int segCount = static_cast<int>(_splineSegments.size());
+    spdlog::info("performing partitioned solving of '{}' spline segments...", segCount);
+
+    // knots of a segment are solved with calibration parameters fixed
+    const OptOption knotOption =
+        option & (OptOption::OPT_SO3_SPLINE | OptOption::OPT_SCALE_SPLINE);
+    // problems of segments are solved in parallel, threads are shared by them
+    auto segCeresOption = _ceresOption;
+    segCeresOption.callbacks.clear();
+    segCeresOption.update_state_every_iteration = false;
+    segCeresOption.minimizer_progress_to_stdout = false;
+    segCeresOption.num_threads =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / segCount);
+
+    // param blocks of the knots of a segment
+    auto SegmentKnots = [this](int segIdx) {
+        const auto& [so3Spline, posSpline] = _splineSegments.at(segIdx);
+        std::vector<double*> knots;
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            knots.push_back(const_cast<double*>(so3Spline.GetKnot(i).data()));
+        }
+        for (int i = 0; i < static_cast<int>(posSpline.GetKnots().size()); ++i) {
+            knots.push_back(const_cast<double*>(posSpline.GetKnot(i).data()));
+        }
+        return knots;
+    };
+
+    // backups of param blocks, used to revert rejected steps
+    using ParamBlockBackup = std::vector<std::pair<double*, std::vector<double>>>;
+    auto Backup = [](const Estimator::Ptr& estimator, const std::vector<double*>& blocks,
+                     ParamBlockBackup& backup) {
+        for (auto* block : blocks) {
+            const int size = estimator->ParameterBlockSize(block);
+            backup.emplace_back(block, std::vector<double>(block, block + size));
+        }
+    };
+
+    double lastCost = std::numeric_limits<double>::max();
+    // damping of the reduced problem (Levenberg-Marquardt), relative to its diagonal
+    double lambda = 1E-4;
+    for (int iter = 0; iter < config.MaxIterations; ++iter) {
+        // step 1: knots of each segment are solved in parallel
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < segCount; ++i) {
+            auto estimator = Estimator::Create(_parMgr);
+            this->AddBatchOptimizationFactors(estimator, knotOption, i, false);
+            estimator->Solve(segCeresOption, nullptr);
+        }
 
-        for (const auto& [topic, _] : Configor::DataStream::EventTopics) {
-            switch (vpType) {
-                case VisualProjType::SYNC_POINT_BASED: {
-                    auto s = this->AddVisualProjPairsSyncPointBasedToSplineSegments(
-                        estimator, topic, option, {});
-                    spdlog::info("add '{}' 'VisualProjectionFactor' for camera '{}'...", s, topic);
-                    break;
+        // step 2: summaries of segments on calibration parameters (Schur complements of knots)
+        std::vector<Estimator::Ptr> estimators(segCount);
+        std::vector<Estimator::SchurSummary> summaries(segCount);
+        // exceptions can not escape the parallel region, failures are recorded per segment
+        std::vector<char> failed(segCount, false);
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < segCount; ++i) {
+            estimators.at(i) = Estimator::Create(_parMgr);
+            this->AddBatchOptimizationFactors(estimators.at(i), option, i, false);
+            // make this problem full rank
+            estimators.at(i)->SetIMUParamsConstant(Configor::DataStream::RefIMUTopic);
+            try {
+                summaries.at(i) = estimators.at(i)->MarginalizeParamBlocks(SegmentKnots(i));
+            } catch (const EKalibrStatus&) {
+                failed.at(i) = true;
+            }
+        }
+        if (auto iter = std::find(failed.cbegin(), failed.cend(), true); iter != failed.cend()) {
+            spdlog::warn(
+                "knots of the '{}'-th spline segment can not be eliminated, fall back to the "
+                "joint batch optimization!",
+                std::distance(failed.cbegin(), iter));
+            return false;
+        }
+        // the priori is involved once, rather than in each segment
+        if (_priori != nullptr) {
+            auto estimator = Estimator::Create(_parMgr);
+            _priori->AddSpatTempPrioriConstraint(*estimator, *_parMgr);
+            summaries.push_back(estimator->MarginalizeParamBlocks({}));
+            estimators.push_back(estimator);
+        }
+
+        // step 3: the reduced problem on calibration parameters shared by segments, only
+        // parameters that are variable in segments are involved
+        std::map<double*, std::pair<int, int>> sharedOffsets;
+        std::vector<double*> sharedBlocks;
+        int sharedSize = 0;
+        double cost = 0.0;
+        for (int i = 0; i < static_cast<int>(summaries.size()); ++i) {
+            const auto& summary = summaries.at(i);
+            cost += summary.cost;
+            if (i >= segCount) {
+                continue;
+            }
+            for (int j = 0; j < static_cast<int>(summary.blocks.size()); ++j) {
+                const int size = summary.offsets.at(j + 1) - summary.offsets.at(j);
+                if (sharedOffsets.insert({summary.blocks.at(j), {sharedSize, i}}).second) {
+                    sharedBlocks.push_back(summary.blocks.at(j));
+                    sharedSize += size;
                 }
-                case VisualProjType::ASYNC_POINT_BASED: {
-                    auto s = this->AddVisualProjPairsAsyncPointBasedToSplineSegments(
-                        estimator, topic, option, {});
-                    spdlog::info("add '{}' 'VisualProjectionFactor' for camera '{}'...", s, topic);
-                    break;
+            }
+        }
+        spdlog::info("the '{}'-th partitioned iteration, cost: {:.6f}", iter, cost);
+        if (sharedSize == 0 || lastCost - cost < config.CostTolerance * lastCost) {
+            break;
+        }
+        lastCost = cost;
+
+        Eigen::MatrixXd H = Eigen::MatrixXd::Zero(sharedSize, sharedSize);
+        Eigen::VectorXd b = Eigen::VectorXd::Zero(sharedSize);
+        // offsets of blocks of a summary in the reduced problem, -1 for not involved blocks
+        std::vector<std::vector<int>> summaryOffsets(summaries.size());
+        for (int i = 0; i < static_cast<int>(summaries.size()); ++i) {
+            const auto& summary = summaries.at(i);
+            auto& offsets = summaryOffsets.at(i);
+            for (auto* block : summary.blocks) {
+                auto found = sharedOffsets.find(block);
+                offsets.push_back(found == sharedOffsets.cend() ? -1 : found->second.first);
+            }
+            for (int r = 0; r < static_cast<int>(summary.blocks.size()); ++r) {
+                const int rSize = summary.offsets.at(r + 1) - summary.offsets.at(r);
+                if (offsets.at(r) < 0) {
+                    continue;
+                }
+                b.segment(offsets.at(r), rSize) += summary.b.segment(summary.offsets.at(r), rSize);
+                for (int c = 0; c < static_cast<int>(summary.blocks.size()); ++c) {
+                    const int cSize = summary.offsets.at(c + 1) - summary.offsets.at(c);
+                    if (offsets.at(c) < 0) {
+                        continue;
+                    }
+                    H.block(offsets.at(r), offsets.at(c), rSize, cSize) += summary.H.block(
+                        summary.offsets.at(r), summary.offsets.at(c), rSize, cSize);
                 }
             }
         }
-        for (auto& [so3Spline, posSpline] : _splineSegments) {
-            estimator->AddRegularizationL2Constraint(so3Spline, option, 1E-3);
-            estimator->AddRegularizationL2Constraint(posSpline, option, 1E-3);
+
+        // backups of the current state
+        ParamBlockBackup backup;
+        for (const auto& [block, info] : sharedOffsets) {
+            Backup(estimators.at(info.second), {block}, backup);
+        }
+        for (int i = 0; i < segCount; ++i) {
+            Backup(estimators.at(i), summaries.at(i).margBlocks, backup);
+        }
+
+        bool accepted = false;
+        for (int attempt = 0; attempt < 5 && !accepted; ++attempt) {
+            Eigen::MatrixXd HDamped = H;
+            HDamped.diagonal() += lambda * H.diagonal().cwiseMax(1E-9);
+            const Eigen::VectorXd dx = HDamped.ldlt().solve(-b);
+
+            // update calibration parameters, and then knots via back substitution
+            for (const auto& [block, info] : sharedOffsets) {
+                estimators.at(info.second)->UpdateParamBlock(block, dx.data() + info.first);
+            }
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < segCount; ++i) {
+                const auto& summary = summaries.at(i);
+                Eigen::VectorXd dxOfSeg(summary.offsets.back());
+                for (int j = 0; j < static_cast<int>(summary.blocks.size()); ++j) {
+                    const int size = summary.offsets.at(j + 1) - summary.offsets.at(j);
+                    dxOfSeg.segment(summary.offsets.at(j), size) =
+                        dx.segment(summaryOffsets.at(i).at(j), size);
+                }
+                const Eigen::VectorXd dm = summary.margStep + summary.margGain * dxOfSeg;
+                for (int j = 0; j < static_cast<int>(summary.margBlocks.size()); ++j) {
+                    estimators.at(i)->UpdateParamBlock(summary.margBlocks.at(j),
+                                                       dm.data() + summary.margOffsets.at(j));
+                }
+            }
+
+            // evaluate the cost of the joint problem
+            std::vector<double> costs(estimators.size(), 0.0);
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < static_cast<int>(estimators.size()); ++i) {
+                estimators.at(i)->Evaluate(ceres::Problem::EvaluateOptions(), &costs.at(i),
+                                           nullptr, nullptr, nullptr);
+            }
+            const double newCost = std::accumulate(costs.cbegin(), costs.cend(), 0.0);
+
+            if (newCost < cost) {
+                accepted = true;
+                lambda = std::max(lambda * 0.1, 1E-8);
+            } else {
+                // revert
+                for (const auto& [block, values] : backup) {
+                    std::copy(values.cbegin(), values.cend(), block);
+                }
+                lambda *= 10.0;
+            }
+        }
+        if (!accepted) {
+            break;
         }
-        // make this problem full rank
-        estimator->SetIMUParamsConstant(Configor::DataStream::RefIMUTopic);
-        auto sum = estimator->Solve(_ceresOption, _priori);
-        spdlog::info("here is the summary:\n{}\n", sum.BriefReport());
-        CalibSolverIO::SaveStageCalibParam(_parMgr,
-                                           "visual_inertial_calib_3_bo_" + std::to_string(i));
     }
+    return true;
 }
 
 }  // namespace ns_ekalibr
\ No newline at end of file
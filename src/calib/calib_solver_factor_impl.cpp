@@ -62,7 +62,8 @@ std::size_t CalibSolver::AddGyroFactorToSplineSegments(const EstimatorPtr &estim
                                                        const std::string &imuTopic,
                                                        OptOption option,
                                                        const std::optional<double> &w,
-                                                       const std::optional<double> &dsRate) const {
+                                                       const std::optional<double> &dsRate,
+                                                       const std::optional<int> &segIdx) const {
     auto weight =
         w == std::nullopt
             ? Configor::DataStream::IMUTopics.at(imuTopic).GyroWeight(_imuFrequency.at(imuTopic))
@@ -75,19 +76,24 @@ std::size_t CalibSolver::AddGyroFactorToSplineSegments(const EstimatorPtr &estim
         const double freq = static_cast<double>(_imuMes.at(imuTopic).size()) / dt;
         pick = std::max(pick, static_cast<std::size_t>(freq / *dsRate));
     }
+    // measurements are organized by segments, so that those in the same knot span are grouped
+    std::vector<std::vector<IMUFrame::Ptr>> framesInSegments(_splineSegments.size());
     for (const auto &frame : _imuMes.at(imuTopic)) {
         if (++index % pick != 0) {
             continue;
         }
 
         auto idx = this->IsTimeInValidSegment(frame->GetTimestamp() + To_BiToBr);
-        if (idx == std::nullopt) {
+        if (idx == std::nullopt || (segIdx != std::nullopt && *idx != *segIdx)) {
             continue;
         }
-        estimator->AddIMUGyroMeasurement(_splineSegments.at(*idx).first, frame, imuTopic, option,
-                                         weight);
+        framesInSegments.at(*idx).push_back(frame);
         ++count;
     }
+    for (int i = 0; i < static_cast<int>(framesInSegments.size()); ++i) {
+        estimator->AddIMUGyroMeasurements(_splineSegments.at(i).first, framesInSegments.at(i),
+                                          imuTopic, option, weight);
+    }
     return count;
 }
 
@@ -95,7 +101,8 @@ std::size_t CalibSolver::AddAcceFactorToSplineSegments(const EstimatorPtr &estim
                                                        const std::string &imuTopic,
                                                        OptOption option,
                                                        const std::optional<double> &w,
-                                                       const std::optional<double> &dsRate) const {
+                                                       const std::optional<double> &dsRate,
+                                                       const std::optional<int> &segIdx) const {
     auto weight =
         w == std::nullopt
             ? Configor::DataStream::IMUTopics.at(imuTopic).AcceWeight(_imuFrequency.at(imuTopic))
@@ -108,20 +115,25 @@ std::size_t CalibSolver::AddAcceFactorToSplineSegments(const EstimatorPtr &estim
         const double freq = static_cast<double>(_imuMes.at(imuTopic).size()) / dt;
         pick = std::max(pick, static_cast<std::size_t>(freq / *dsRate));
     }
+    // measurements are organized by segments, so that those in the same knot span are grouped
+    std::vector<std::vector<IMUFrame::Ptr>> framesInSegments(_splineSegments.size());
     for (const auto &frame : _imuMes.at(imuTopic)) {
         if (++index % pick != 0) {
             continue;
         }
 
         auto idx = this->IsTimeInValidSegment(frame->GetTimestamp() + To_BiToBr);
-        if (idx == std::nullopt) {
+        if (idx == std::nullopt || (segIdx != std::nullopt && *idx != *segIdx)) {
             continue;
         }
-        estimator->AddIMUAcceMeasurement(_splineSegments.at(*idx).first,
-                                         _splineSegments.at(*idx).second, frame, imuTopic, option,
-                                         weight);
+        framesInSegments.at(*idx).push_back(frame);
         ++count;
     }
+    for (int i = 0; i < static_cast<int>(framesInSegments.size()); ++i) {
+        estimator->AddIMUAcceMeasurements(_splineSegments.at(i).first,
+                                          _splineSegments.at(i).second, framesInSegments.at(i),
+                                          imuTopic, option, weight);
+    }
     return count;
 }
 
@@ -129,21 +141,27 @@ std::size_t CalibSolver::AddVisualProjPairsSyncPointBasedToSplineSegments(
     const EstimatorPtr &estimator,
     const std::string &camTopic,
     OptOption option,
-    const std::optional<double> &w) const {
+    const std::optional<double> &w,
+    const std::optional<int> &segIdx) const {
     auto weight = w == std::nullopt ? Configor::Prior::EvCameraWeight() : *w;
     const auto &TO_CjToBr = _parMgr->TEMPORAL.TO_CjToBr.at(camTopic);
     std::size_t count = 0;
 
+    // pairs are collected by segments, and then added in batches
+    std::vector<std::vector<VisualProjectionPair>> pairsInSegments(_splineSegments.size());
     for (const auto &pair : _evSyncPointProjPairs.at(camTopic)) {
         auto idx = this->IsTimeInValidSegment(pair->timestamp + TO_CjToBr);
-        if (idx == std::nullopt) {
+        if (idx == std::nullopt || (segIdx != std::nullopt && *idx != *segIdx)) {
             continue;
         }
-        estimator->AddVisualProjectionFactor(_splineSegments.at(*idx).first,
-                                             _splineSegments.at(*idx).second, camTopic, pair,
-                                             option, weight);
+        pairsInSegments.at(*idx).push_back(*pair);
         ++count;
     }
+    for (std::size_t i = 0; i < _splineSegments.size(); ++i) {
+        estimator->AddVisualProjectionFactors(_splineSegments.at(i).first,
+                                              _splineSegments.at(i).second, camTopic,
+                                              pairsInSegments.at(i), option, weight);
+    }
     return count;
 }
 
@@ -151,21 +169,28 @@ std::size_t CalibSolver::AddVisualProjPairsAsyncPointBasedToSplineSegments(
     const EstimatorPtr &estimator,
     const std::string &camTopic,
     OptOption option,
-    const std::optional<double> &w) const {
+    const std::optional<double> &w,
+    const std::optional<int> &segIdx) const {
     auto weight = w == std::nullopt ? Configor::Prior::EvCameraWeight() : *w;
     const auto &TO_CjToBr = _parMgr->TEMPORAL.TO_CjToBr.at(camTopic);
     std::size_t count = 0;
 
-    for (const auto &pair : _evAsyncPointProjPairs.at(camTopic)) {
-        auto idx = this->IsTimeInValidSegment(pair->timestamp + TO_CjToBr);
-        if (idx == std::nullopt) {
+    const auto &pairs = _evAsyncPointProjPairs.at(camTopic);
+    // pairs are collected by segments, and then added in batches
+    std::vector<std::vector<VisualProjectionPair>> pairsInSegments(_splineSegments.size());
+    for (std::size_t i = 0; i < pairs->Size(); ++i) {
+        auto idx = this->IsTimeInValidSegment(pairs->timestamps[i] + TO_CjToBr);
+        if (idx == std::nullopt || (segIdx != std::nullopt && *idx != *segIdx)) {
             continue;
         }
-        estimator->AddVisualProjectionFactor(_splineSegments.at(*idx).first,
-                                             _splineSegments.at(*idx).second, camTopic, pair,
-                                             option, weight);
+        pairsInSegments.at(*idx).push_back(pairs->At(i));
         ++count;
     }
+    for (std::size_t i = 0; i < _splineSegments.size(); ++i) {
+        estimator->AddVisualProjectionFactors(_splineSegments.at(i).first,
+                                              _splineSegments.at(i).second, camTopic,
+                                              pairsInSegments.at(i), option, weight);
+    }
     return count;
 }
 }  // namespace ns_ekalibr
\ No newline at end of file
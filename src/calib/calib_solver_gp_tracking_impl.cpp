@@ -32,6 +32,7 @@
 #include "core/circle_extractor.h"
 #include "core/circle_grid.h"
 #include "filesystem"
+#include "chrono"
 #include "viewer/viewer.h"
 #include "core/sae.h"
 #include "spdlog/spdlog.h"
@@ -44,6 +45,7 @@
 #include <veta/camera/pinhole.h>
 #include "calib/calib_solver_io.h"
 #include "core/incmp_pattern_tracking.h"
+#include "core/grid_roi_predictor.h"
 #include "opencv2/calib3d.hpp"
 
 #include <sensor/frame.h>
@@ -59,6 +61,50 @@ void CalibSolver::GridPatternTracking(bool tryLoadAndSaveRes) {
     // nfConfig.WinSizeInPlaneFit >= 1
     const auto neighborNormFlowDist = nfConfig.WinSizeInPlaneFit * 2 - 1;
 
+    const auto &ceConfig = Configor::Prior::CircleExtractor;
+    const int pyramidLevels = ceConfig.PyramidLevels, pyramidScale = 1 << pyramidLevels;
+    /**
+     * rois refined at full resolution should cover the dilated clusters and the windows
+     * traversed to estimate norm flows
+     */
+    const int roiMargin = pyramidScale * ceConfig.ClusterDilateSize +
+                          std::max(nfConfig.WinSizeInPlaneFit, neighborNormFlowDist);
+    // the same margin at full resolution, for regions predicted while tracking
+    const int trackingMargin =
+        ceConfig.ClusterDilateSize + std::max(nfConfig.WinSizeInPlaneFit, neighborNormFlowDist);
+
+    auto EstimateNormFlows = [&nfConfig, &neighborNormFlowDist](
+                                 const ActiveEventSurface::Ptr &sae, double window,
+                                 const std::vector<cv::Rect> &rois) {
+        return EventNormFlow(sae).ExtractNormFlows(
+            window,                            // decay seconds for time surface
+            nfConfig.WinSizeInPlaneFit,        // window size to fit local planes
+            neighborNormFlowDist,              // distance between neighbor norm flows
+            nfConfig.RansacInlierRatioThd,     // the ratio, for ransac and in-range candidates
+            nfConfig.EventToPlaneTimeDistThd,  // the point to plane threshold in temporal
+                                               // domain, unit (s)
+            nfConfig.RansacMaxIterations,      // ransac iteration count
+            rois);                             // regions to estimate norm flows, empty for all
+    };
+
+    // thresholds in pixels are scaled for time surfaces downsampled by 'scale'
+    auto CreateCircleExtractor = [&ceConfig](bool visualization, int scale) {
+        return EventCircleExtractor::Create(visualization,
+                                            ceConfig.ValidClusterAreaThd / (scale * scale),
+                                            ceConfig.CircleClusterPairDirThd,
+                                            ceConfig.PointToCircleDistThd / scale,
+                                            std::max(1, ceConfig.ClusterDilateSize / scale));
+    };
+
+    /**
+     * windows are skipped if few events are triggered (e.g., static board), and their lengths are
+     * adapted to the motion, i.e., the number of recently active pixels
+     */
+    const auto &winConfig = Configor::Prior::ActiveEventWindow;
+    const bool adaptiveWindow = winConfig.TargetActivePixels > 0;
+    const double minWindow = adaptiveWindow ? winConfig.MinWindowRate * decay : decay;
+    const double maxWindow = adaptiveWindow ? winConfig.MaxWindowRate * decay : decay;
+
     _grid3d = CircleGrid3D::Create(pattern.Rows, pattern.Cols,
                                    pattern.SpacingMeters /*unit: meters*/, circlePattern);
 
@@ -82,14 +128,6 @@ void CalibSolver::GridPatternTracking(bool tryLoadAndSaveRes) {
             auto [gridPatternPath, rawEvsPath] =
                 CalibSolverIO::GetDiskPathOfExtractedGridPatterns(topic);
             if (std::filesystem::exists(gridPatternPath) && std::filesystem::exists(rawEvsPath)) {
-                // try load '_rawEventsOfExtractedPatterns'
-                spdlog::info(
-                    "try to load existing raw events of extracted circles of grid patterns for "
-                    "camera '{}' from '{}'...",
-                    topic, rawEvsPath);
-                auto rawEvsOfPattern = CalibSolverIO::LoadRawEventsOfExtractedPatterns(
-                    rawEvsPath, _dataRawTimestamp.first, CerealArchiveType::Enum::BINARY);
-
                 // try load '_extractedPatterns'
                 spdlog::info(
                     "try to load existing extracted circles grid patterns for camera '{}' from "
@@ -98,16 +136,29 @@ void CalibSolver::GridPatternTracking(bool tryLoadAndSaveRes) {
                 auto curPattern = CircleGridPattern::Load(gridPatternPath, _dataRawTimestamp.first,
                                                           Configor::Preference::OutputDataFormat);
 
-                if (!rawEvsOfPattern.empty() && curPattern != nullptr) {
+                std::map<int, ExtractedCirclesVec> rawEvsOfPattern;
+                if (curPattern != nullptr) {
                     // select in time-range pattern
-                    auto idsOfRemoved = curPattern->RemoveGrid2DOutOfTimeRange(
-                        _dataRawTimestamp.first, _dataRawTimestamp.second);
+                    curPattern->RemoveGrid2DOutOfTimeRange(_dataRawTimestamp.first,
+                                                           _dataRawTimestamp.second);
 
-                    // filter '_rawEventsOfExtractedPatterns'
-                    for (int grid2dId : idsOfRemoved) {
-                        rawEvsOfPattern.erase(grid2dId);
+                    // try load '_rawEventsOfExtractedPatterns', only of in time-range grids
+                    spdlog::info(
+                        "try to load existing raw events of extracted circles of grid patterns "
+                        "for camera '{}' from '{}'...",
+                        topic, rawEvsPath);
+                    std::vector<int> gridIds;
+                    for (const auto &grid2d : curPattern->GetGrid2d()) {
+                        gridIds.push_back(grid2d->id);
+                    }
+                    if (!gridIds.empty()) {
+                        rawEvsOfPattern = CalibSolverIO::LoadRawEventsOfExtractedPatterns(
+                            rawEvsPath, _dataRawTimestamp.first, CerealArchiveType::Enum::BINARY,
+                            gridIds);
                     }
+                }
 
+                if (!rawEvsOfPattern.empty() && curPattern != nullptr) {
                     // assign
                     _extractedPatterns[topic] = curPattern;
                     _rawEventsOfExtractedPatterns[topic] = rawEvsOfPattern;
@@ -132,9 +183,30 @@ void CalibSolver::GridPatternTracking(bool tryLoadAndSaveRes) {
         }
 
         const auto &config = Configor::DataStream::EventTopics.at(topic);
-        auto sae = ActiveEventSurface::Create(config.Width, config.Height, 0.01);
+        // the cost of extraction is reported, e.g., to compare runs with and without denoising
+        const auto extractionStart = std::chrono::steady_clock::now();
+        std::size_t extractionEventCount = 0;
+        /**
+         * pixels older than the decay cutoff contribute nothing to the per-window surfaces, so
+         * they are dropped from the active set of the sae, and the norm flow estimation only
+         * traverses pixels updated recently
+         */
+        auto sae = ActiveEventSurface::Create(
+            config.Width, config.Height, 0.01,
+            ActiveEventSurface::DecayTimeSurfaceCutoff(std::max(decay, maxWindow)));
+
+        // raw events of extracted circles refer to the ingested ones by their serials in the sae
+        const auto eventSource = EventSerialIndex::Create(eventMes);
+
+        // predicts the grid region in the next window from last detections during tracking
+        auto roiPredictor =
+            GridROIPredictor::Create(sae->GetSize(), trackingMargin, ceConfig.TrackingROIPadding,
+                                     ceConfig.TrackingFullScanInterval);
 
         double lastUpdateTime = eventMes.front()->GetTimestamp();
+        // length of current window, and count of events ingested since the last window
+        double window = decay;
+        std::size_t windowEventCount = 0;
         auto bar = std::make_shared<tqdm>();
 
         auto curPattern = CircleGridPattern::Create(_grid3d, _dataRawTimestamp.first);
@@ -144,52 +216,96 @@ void CalibSolver::GridPatternTracking(bool tryLoadAndSaveRes) {
         for (int i = 0; i < static_cast<int>(eventMes.size()); i++) {
             bar->progress(i, static_cast<int>(eventMes.size()));
 
-            for (const auto &event : eventMes.at(i)->GetEvents()) {
+            const auto &events = eventMes.at(i)->GetEvents();
+            for (std::size_t j = 0; j < events.size();) {
                 /**
-                 * create sae (surface of active events)
+                 * create sae (surface of active events), events are ingested in batch up to the
+                 * one closing the current window
                  */
-                sae->GrabEvent(event, true);
+                const double windowEnd =
+                    std::max(eventMes.front()->GetTimestamp() + 0.05, lastUpdateTime + window);
+                const std::size_t jBegin = j;
+                j = sae->GrabEvents(events, j, windowEnd, true);
+                windowEventCount += j - jBegin;
+                extractionEventCount += j - jBegin;
+                if (events.at(j - 1)->GetTimestamp() < windowEnd) {
+                    // events of this message are exhausted before the window ends
+                    continue;
+                }
                 const auto timeLatest = sae->GetTimeLatest();
+                lastUpdateTime = timeLatest;
 
-                if (timeLatest - eventMes.front()->GetTimestamp() < 0.05 ||
-                    timeLatest - lastUpdateTime < decay) {
+                const std::size_t eventCount = windowEventCount;
+                windowEventCount = 0;
+                if (eventCount < static_cast<std::size_t>(winConfig.MinEventCount)) {
+                    // too few events to extract a grid, e.g., the board is static
                     continue;
-                } else {
-                    lastUpdateTime = timeLatest;
+                }
+                if (adaptiveWindow) {
+                    // the span holding the target number of active pixels, within bounds
+                    window = sae->SpanOfRecentPixels(winConfig.TargetActivePixels, minWindow,
+                                                     maxWindow);
                 }
 
                 // auto dts = sae->DecayTimeSurface(true, 0, decay);
                 // cv::imshow("Decay Surface Of Active Events", dts);
 
                 /**
-                 * estimate norm flows using created sae
+                 * while the grid is tracked, only the region predicted from last detections is
+                 * searched. Otherwise (coarse-to-fine), circles are first extracted on a
+                 * downsampled level of the sae, and norm flows at full resolution are then
+                 * estimated only around them
                  */
-                auto nfPack = EventNormFlow(sae).ExtractNormFlows(
-                    decay,                          // decay seconds for time surface
-                    nfConfig.WinSizeInPlaneFit,     // window size to fit local planes
-                    neighborNormFlowDist,           // distance between neighbor norm flows
-                    nfConfig.RansacInlierRatioThd,  // the ratio, for ransac and in-range candidates
-                    nfConfig.EventToPlaneTimeDistThd,  // the point to plane threshold in temporal
-                                                       // domain, unit (s)
-                    nfConfig.RansacMaxIterations);     // ransac iteration count
+                std::vector<cv::Rect> rois;
+                std::vector<cv::Point2f> coarseCenters;
+                const auto predRoi = roiPredictor->Predict(timeLatest);
+                if (predRoi) {
+                    rois.push_back(*predRoi);
+                } else if (pyramidLevels > 0) {
+                    const auto coarseSae = sae->Pyramid(pyramidLevels).back();
+                    auto [coarseIsCmp, coarseCens, coarseCircles] =
+                        CreateCircleExtractor(false, pyramidScale)
+                            ->ExtractCirclesGrid(EstimateNormFlows(coarseSae, window, {}),
+                                                 patternSize, circlePattern, false);
+                    if (coarseIsCmp) {
+                        rois = EventCircleExtractor::CircleROIs(coarseCircles, pyramidScale,
+                                                                roiMargin, sae->GetSize());
+                        coarseCenters = coarseCens;
+                    }
+                }
 
                 /**
-                 * extract circle grid pattern
+                 * estimate norm flows using created sae and extract circle grid pattern
                  */
-                auto circleExtractor = EventCircleExtractor::Create(
-                    true, /* create sea mats */
-                    Configor::Prior::CircleExtractor.ValidClusterAreaThd,
-                    Configor::Prior::CircleExtractor.CircleClusterPairDirThd,
-                    Configor::Prior::CircleExtractor.PointToCircleDistThd,
-                    Configor::Prior::CircleExtractor.ClusterDilateSize);
-
+                auto nfPack = EstimateNormFlows(sae, window, rois);
+                nfPack->eventSource = eventSource;
+                auto circleExtractor = CreateCircleExtractor(true /* create sea mats */, 1);
                 auto [isCmp, centers, rawEvs] = circleExtractor->ExtractCirclesGrid(
                     nfPack, patternSize, circlePattern, true, _viewer);
 
+                if (!rois.empty() &&
+                    (!isCmp ||
+                     (predRoi && !EventCircleExtractor::CirclesInsideROI(
+                                     rawEvs, *predRoi, trackingMargin, sae->GetSize())) ||
+                     (!coarseCenters.empty() &&
+                      !EventCircleExtractor::CentersAgree(centers, coarseCenters, pyramidScale,
+                                                          ceConfig.PyramidCenterTolerance)))) {
+                    /**
+                     * the grid is lost in the rois, clipped by the predicted region, or drifts
+                     * from the coarse one, use full frame
+                     */
+                    nfPack = EstimateNormFlows(sae, window, {});
+                    nfPack->eventSource = eventSource;
+                    circleExtractor = CreateCircleExtractor(true /* create sea mats */, 1);
+                    std::tie(isCmp, centers, rawEvs) = circleExtractor->ExtractCirclesGrid(
+                        nfPack, patternSize, circlePattern, true, _viewer);
+                }
+
                 auto grid2d = CircleGrid2D::Create(
                     grid2dIdx, nfPack->timestamp, centers,
-                    std::vector<std::uint8_t>(centers.size(), isCmp ? 1 : 0), isCmp);
+                    std::vector<std::uint8_t>(centers.size(), isCmp ? 1 : 0), isCmp, window);
                 curPattern->AddGrid2d(grid2d);
+                roiPredictor->Update(grid2d);
                 /**
                  * distortion in 'res->second' is not considered, i.e., they are raw ones from
                  * input events
@@ -212,7 +328,7 @@ void CalibSolver::GridPatternTracking(bool tryLoadAndSaveRes) {
 
                 if (Configor::Preference::Visualization) {
                     // to save more information, set the parameter as 'true'
-                    nfPack->Visualization(decay, VisualizationSaveForDebug, grid2dIdx);
+                    nfPack->Visualization(window, VisualizationSaveForDebug, grid2dIdx);
                     circleExtractor->Visualization(VisualizationSaveForDebug, grid2dIdx, topic);
 
                     auto ptScale = Configor::Preference::EventViewerSpatialTemporalScale;
@@ -230,6 +346,12 @@ void CalibSolver::GridPatternTracking(bool tryLoadAndSaveRes) {
         }
 
         bar->finish();
+        spdlog::info("circle grid extraction for camera '{}' takes '{:.3f}' (s) for '{}' events",
+                     topic,
+                     std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                   extractionStart)
+                         .count(),
+                     extractionEventCount);
         if (Configor::Preference::Visualization) {
             _viewer->ClearViewer();
             _viewer->ResetViewerCamera();
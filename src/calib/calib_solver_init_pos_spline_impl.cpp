@@ -30,43 +30,87 @@
 #include "calib/estimator.h"
 #include "spdlog/spdlog.h"
 #include <calib/calib_param_mgr.h>
+#include "util/spline_knot_insertion.hpp"
+#include "util/status.hpp"
 
 namespace ns_ekalibr {
 
-void CalibSolver::InitPosSpline() const {
+void CalibSolver::InitPosSpline() {
     spdlog::info("performing position spline recovery...");
 
     /**
      * we throw the head and tail data as the rotations from the fitted SO3 Spline in that range are
      * poor
      */
-    auto estimator = Estimator::Create(_parMgr);
-    auto optOption = OptOption::OPT_SCALE_SPLINE;
+    auto FitPosSplines = [this](const ceres::Solver::Options& options) {
+        auto estimator = Estimator::Create(_parMgr);
+        auto optOption = OptOption::OPT_SCALE_SPLINE;
 
-    // add camera position constraints
-    for (const auto& [topic, poseVec] : _camPoses) {
-        const double TO_CjToBr = _parMgr->TEMPORAL.TO_CjToBr.at(topic);
-        const auto& SE3_BrToCj = _parMgr->EXTRI.SE3_CjToBr(topic).inverse();
+        // add camera position constraints
+        for (const auto& [topic, poseVec] : _camPoses) {
+            const double TO_CjToBr = _parMgr->TEMPORAL.TO_CjToBr.at(topic);
+            const auto& SE3_BrToCj = _parMgr->EXTRI.SE3_CjToBr(topic).inverse();
 
-        for (const auto& pose : poseVec) {
-            const double timeByBr = pose.timeStamp + TO_CjToBr;
+            for (const auto& pose : poseVec) {
+                const double timeByBr = pose.timeStamp + TO_CjToBr;
 
-            auto idx = IsTimeInValidSegment(timeByBr);
-            if (idx == std::nullopt) {
-                continue;
-            }
+                auto idx = IsTimeInValidSegment(timeByBr);
+                if (idx == std::nullopt) {
+                    continue;
+                }
 
-            const Sophus::SE3d SE3_BrToW = pose.se3() * SE3_BrToCj;
-            estimator->AddPositionConstraint(_splineSegments.at(*idx).second, timeByBr,
-                                             SE3_BrToW.translation(), optOption, 10.0);
+                const Sophus::SE3d SE3_BrToW = pose.se3() * SE3_BrToCj;
+                estimator->AddPositionConstraint(_splineSegments.at(*idx).second, timeByBr,
+                                                 SE3_BrToW.translation(), optOption, 10.0);
+            }
         }
+
+        AddAcceFactorToSplineSegments(estimator, Configor::DataStream::RefIMUTopic, optOption,
+                                      0.1, /*weight*/
+                                      100 /*down sampling rate*/);
+
+        auto sum = estimator->Solve(options, _priori);
+        spdlog::info("here is the summary:\n{}\n", sum.BriefReport());
+    };
+
+    const auto& mrConfig = Configor::Prior::MultiResolutionInit;
+    if (mrConfig.Levels == 0) {
+        FitPosSplines(_ceresOption);
+        return;
     }
 
-    AddAcceFactorToSplineSegments(estimator, Configor::DataStream::RefIMUTopic, optOption,
-                                  0.1, /*weight*/
-                                  100 /*down sampling rate*/);
+    /**
+     * position splines are fitted at '2^Levels', ..., 2 times of their knot distances first, and
+     * refined by knot insertion to the next level, they are only polished at the final level
+     */
+    std::vector<PosSplineType> finalSplines;
+    finalSplines.reserve(_splineSegments.size());
+    for (const auto& [so3Spline, posSpline] : _splineSegments) {
+        finalSplines.push_back(posSpline);
+    }
+    for (int level = mrConfig.Levels; level >= 0; --level) {
+        for (int i = 0; i < static_cast<int>(_splineSegments.size()); ++i) {
+            auto& posSpline = _splineSegments.at(i).second;
+            const auto& finalSpline = finalSplines.at(i);
+            auto levelSpline =
+                level == 0 ? finalSpline
+                           : CreatePosSpline(finalSpline.MinTime(), finalSpline.MaxTime(),
+                                             finalSpline.GetTimeInterval() * (1 << level), false);
+            if (level < mrConfig.Levels &&
+                !SplineKnotInsertion::Dyadic(posSpline, levelSpline)) {
+                throw Status(Status::ERROR,
+                             "knot grids of the position splines of two levels are not aligned!");
+            }
+            posSpline = levelSpline;
+        }
+        spdlog::info("fitting position splines at level '{}'...", level);
 
-    auto sum = estimator->Solve(_ceresOption, _priori);
-    spdlog::info("here is the summary:\n{}\n", sum.BriefReport());
+        auto options = _ceresOption;
+        if (level == 0) {
+            options.max_num_iterations = mrConfig.PolishIterations;
+        }
+        FitPosSplines(options);
+    }
 }
+
 }  // namespace ns_ekalibr
\ No newline at end of file
@@ -31,10 +31,12 @@
 #include "spdlog/spdlog.h"
 #include "calib/calib_param_mgr.h"
 #include <calib/cross_correlation.h>
+#include "util/spline_knot_insertion.hpp"
+#include "util/status.hpp"
 
 namespace ns_ekalibr {
 
-void CalibSolver::InitSo3Spline() const {
+void CalibSolver::InitSo3Spline() {
     /**
      * this function would initialize the rotation spline, as well as the extrinsic rotations and
      * time offsets between multiple imus, if they are integrated
@@ -60,13 +62,40 @@ void CalibSolver::InitSo3Spline() const {
      * ----------------------------------------------------------------
      */
 
-    auto estimator = Estimator::Create(_parMgr);
-    // we initialize the rotation spline first use only the measurements from the reference imu
-    this->AddGyroFactorToFullSo3Spline(estimator, Configor::DataStream::RefIMUTopic,
-                                       OptOption::OPT_SO3_SPLINE, 0.1 /*weight*/,
-                                       100 /*down sampling*/);
-    auto sum = estimator->Solve(_ceresOption, _priori);
-    spdlog::info("here is the summary:\n{}\n", sum.BriefReport());
+    /**
+     * the rotation spline is fitted coarse-to-fine if multi-resolution initialization is enabled,
+     * i.e., at '2^Levels', ..., 2 times of its knot distance first, and refined by knot insertion
+     */
+    const auto &mrConfig = Configor::Prior::MultiResolutionInit;
+    const double st = _fullSo3Spline.MinTime(), et = _fullSo3Spline.MaxTime(),
+                 dt = _fullSo3Spline.GetTimeInterval();
+    Estimator::Ptr estimator;
+    ceres::Solver::Summary sum;
+    for (int level = mrConfig.Levels; level >= 0; --level) {
+        auto options = _ceresOption;
+        if (level == mrConfig.Levels && level > 0) {
+            _fullSo3Spline = CreateSo3Spline(st, et, dt * (1 << level), true);
+        } else if (level < mrConfig.Levels) {
+            auto fineSpline = CreateSo3Spline(st, et, dt * (1 << level), true);
+            if (!SplineKnotInsertion::Dyadic(_fullSo3Spline, fineSpline)) {
+                throw Status(Status::ERROR,
+                             "knot grids of the rotation splines of two levels are not aligned!");
+            }
+            _fullSo3Spline = fineSpline;
+            // only polish at the final level
+            if (level == 0) {
+                options.max_num_iterations = mrConfig.PolishIterations;
+            }
+        }
+
+        estimator = Estimator::Create(_parMgr);
+        // we initialize the rotation spline first use only the measurements from the reference imu
+        this->AddGyroFactorToFullSo3Spline(estimator, Configor::DataStream::RefIMUTopic,
+                                           OptOption::OPT_SO3_SPLINE, 0.1 /*weight*/,
+                                           100 /*down sampling*/);
+        sum = estimator->Solve(options, _priori);
+        spdlog::info("here is the summary (level: {}):\n{}\n", level, sum.BriefReport());
+    }
 
     if (Configor::DataStream::IMUTopics.size() > 1) {
         // recover the time offsets using cross correlation max
@@ -130,25 +159,86 @@ void CalibSolver::InitSo3SplineSegments() {
     // fitting so3 segments
     spdlog::info("fitting so3 part of spline segments...");
 
+    /**
+     * if segments are aligned to the knot grid of the full so3 spline (multi-resolution
+     * initialization), and their knot distances are that of the full one divided by powers of two,
+     * they are obtained exactly by knot insertion. Otherwise, they are fitted to dense samples
+     */
+    std::vector<bool> unresolved(_splineSegments.size(), true);
+    if (Configor::Prior::MultiResolutionInit.Levels > 0) {
+        // the full so3 spline refined 0, 1, 2, ... times
+        std::vector<So3SplineType> refinedSplines{_fullSo3Spline};
+        for (int i = 0; i < static_cast<int>(_splineSegments.size()); ++i) {
+            unresolved.at(i) = !So3SplineSegmentByKnotInsertion(i, refinedSplines);
+        }
+        const auto count = std::count(unresolved.cbegin(), unresolved.cend(), true);
+        spdlog::info("'{}' of '{}' so3 spline segments are obtained by knot insertion",
+                     _splineSegments.size() - count, _splineSegments.size());
+        if (count == 0) {
+            return;
+        }
+    }
+
     auto estimator = Estimator::Create(_parMgr);
     double st = _fullSo3Spline.MinTime(), et = _fullSo3Spline.MaxTime(),
-           dt = _splineSegments.front().first.GetTimeInterval() * 0.1;
+           dt = std::numeric_limits<double>::max();
+    // knot distances of segments may differ (adaptive knots), the smallest one is considered
+    for (const auto &[so3Spline, posSpline] : _splineSegments) {
+        dt = std::min(dt, so3Spline.GetTimeInterval() * 0.1);
+    }
     for (double t = st; t < et; t += dt) {
         if (!_fullSo3Spline.TimeStampInRange(t)) {
             continue;
         }
         auto idx = this->IsTimeInValidSegment(t);
-        if (idx == std::nullopt) {
+        if (idx == std::nullopt || !unresolved.at(*idx)) {
             continue;
         }
         estimator->AddSo3Constraint(_splineSegments.at(*idx).first, t, _fullSo3Spline.Evaluate(t),
                                     OptOption::OPT_SO3_SPLINE, 10.0);
     }
-    for (auto &[so3Spline, posSpline] : _splineSegments) {
-        estimator->AddRegularizationL2Constraint(so3Spline, OptOption::OPT_SO3_SPLINE, 1E-3);
+    for (int i = 0; i < static_cast<int>(_splineSegments.size()); ++i) {
+        if (!unresolved.at(i)) {
+            continue;
+        }
+        estimator->AddRegularizationL2Constraint(_splineSegments.at(i).first,
+                                                 OptOption::OPT_SO3_SPLINE, 1E-3);
     }
     auto sum = estimator->Solve(_ceresOption, _priori);
     spdlog::info("here is the summary:\n{}\n", sum.BriefReport());
 }
 
+bool CalibSolver::So3SplineSegmentByKnotInsertion(int segIdx,
+                                                  std::vector<So3SplineType> &refinedSplines) {
+    auto &so3Spline = _splineSegments.at(segIdx).first;
+    const double ratio = _fullSo3Spline.GetTimeInterval() / so3Spline.GetTimeInterval();
+    const int times = static_cast<int>(std::lround(std::log2(ratio)));
+    if (times < 0 || std::abs(std::ldexp(1.0, times) - ratio) > 1E-6) {
+        return false;
+    }
+    while (static_cast<int>(refinedSplines.size()) <= times) {
+        const auto &coarse = refinedSplines.back();
+        auto fine = CreateSo3Spline(coarse.MinTime(), coarse.MaxTime(),
+                                    coarse.GetTimeInterval() * 0.5, false);
+        if (!SplineKnotInsertion::Dyadic(coarse, fine)) {
+            return false;
+        }
+        refinedSplines.push_back(fine);
+    }
+    const auto &refined = refinedSplines.at(times);
+
+    // the segment is a piece of the refined full spline if their knot grids are aligned
+    const double offset = (so3Spline.MinTime() - refined.MinTime()) / so3Spline.GetTimeInterval();
+    const int first = static_cast<int>(std::lround(offset));
+    if (std::abs(offset - first) > 1E-6 || first < 0 ||
+        static_cast<std::size_t>(first) + so3Spline.GetKnots().size() >
+            refined.GetKnots().size()) {
+        return false;
+    }
+    for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+        so3Spline.GetKnot(i) = refined.GetKnot(first + i);
+    }
+    return true;
+}
+
 }  // namespace ns_ekalibr
\ No newline at end of file
@@ -27,6 +27,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "calib/calib_solver_io.h"
+#include "calib/pattern_events_cache.h"
 #include "calib/calib_solver.h"
 #include "spdlog/spdlog.h"
 #include "config/configor.h"
@@ -251,6 +252,9 @@ bool CalibSolverIO::SaveRawEventsOfExtractedPatterns(const std::map<int, Extract
                                                      const std::string &filename,
                                                      double timeBias,
                                                      CerealArchiveType::Enum archiveType) {
+    if (archiveType == CerealArchiveType::Enum::BINARY) {
+        return PatternEventsCache::Save(data, filename, timeBias);
+    }
     std::ofstream file(filename);
     if (!file.is_open()) {
         return false;
@@ -262,7 +266,15 @@ bool CalibSolverIO::SaveRawEventsOfExtractedPatterns(const std::map<int, Extract
 }
 
 std::map<int, CalibSolverIO::ExtractedCirclesVec> CalibSolverIO::LoadRawEventsOfExtractedPatterns(
-    const std::string &filename, double newTimeBias, CerealArchiveType::Enum archiveType) {
+    const std::string &filename,
+    double newTimeBias,
+    CerealArchiveType::Enum archiveType,
+    const std::vector<int> &gridIds) {
+    // the time bias of a compact chunked file is applied when grids are decoded
+    if (auto cache = PatternEventsCache::Open(filename); cache != nullptr) {
+        return cache->Load(newTimeBias, gridIds);
+    }
+    // cereal archives, e.g., saved by former versions
     std::ifstream file(filename);
     if (!file.is_open()) {
         return {};
@@ -281,6 +293,15 @@ std::map<int, CalibSolverIO::ExtractedCirclesVec> CalibSolverIO::LoadRawEventsOf
             "Detailed cereal exception information: \n'{}'",
             filename, exception.what());
     }
+    if (!gridIds.empty()) {
+        for (auto iter = rawEvsOfPattern.begin(); iter != rawEvsOfPattern.end();) {
+            if (std::find(gridIds.cbegin(), gridIds.cend(), iter->first) == gridIds.cend()) {
+                iter = rawEvsOfPattern.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
     for (auto &[id, circles] : rawEvsOfPattern) {
         for (auto &[tvCircles, rawEvs] : circles) {
             if (rawEvs == nullptr) {
@@ -299,9 +320,11 @@ std::map<int, CalibSolverIO::ExtractedCirclesVec> CalibSolverIO::LoadRawEventsOf
             tvCircles->mx(1) = -tvCircles->mx(0) * (time_bias - newTimeBias) + tvCircles->mx(1);
             tvCircles->my(1) = -tvCircles->my(0) * (time_bias - newTimeBias) + tvCircles->my(1);
 
-            for (const auto &ev : rawEvs->GetEvents()) {
-                ev->SetTimestamp(ev->GetTimestamp() + time_bias - newTimeBias);
-            }
+            /**
+             * events are re-based by the time domains of arrays rather than rewritten. Raw events
+             * can be shared among grids, their domains are then shared and set identically
+             */
+            rawEvs->SetTimeBias(newTimeBias - time_bias);
         }
     }
     return rawEvsOfPattern;
@@ -117,8 +117,14 @@ void CalibSolver::Process() {
     }
 
     // create so3 spline given start and end times, knot distances
+    // the knot distance is enlarged for the motion of the whole sequence if adaptive knots enabled
+    const double fullSo3SplineDt =
+        AdaptiveKnotTimeDist(_dataAlignedTimestamp.first, _dataAlignedTimestamp.second,
+                             Configor::Prior::DecayTimeOfActiveEvents * 2.5,
+                             Configor::Prior::DecayTimeOfActiveEvents * 2.5)
+            .first;
     _fullSo3Spline = CreateSo3Spline(_dataAlignedTimestamp.first, _dataAlignedTimestamp.second,
-                                     Configor::Prior::DecayTimeOfActiveEvents * 2.5, true);
+                                     fullSo3SplineDt, true);
 
     if (Configor::Preference::Visualization) {
         _viewer->SetStates(nullptr, _parMgr, nullptr);
@@ -153,8 +159,15 @@ void CalibSolver::Process() {
     // const double SEG_LENGTH = Configor::Prior::DecayTimeOfActiveEvents * 50;  /*length*/
     // this->BreakTimelineToSegments(SEG_NEIGHBOR /*neighbor*/, SEG_LENGTH /*len*/);
     this->BreakTimelineToSegments(0.5 /*neighbor*/, 1.0 /*len*/);
+    // only windows informative for calibration parameters are kept for long sequences
+    this->SelectInformativeTimeSegments();
+    if (Configor::Prior::MultiResolutionInit.Levels > 0) {
+        // so that so3 splines of segments could be obtained from the full one by knot insertion
+        this->AlignTimeSegmentsToKnotGrid(_fullSo3Spline);
+    }
     this->CreateSplineSegments(Configor::Prior::DecayTimeOfActiveEvents * 2.5,
-                               Configor::Prior::DecayTimeOfActiveEvents * 2.5);
+                               Configor::Prior::DecayTimeOfActiveEvents * 2.5, false,
+                               true /*adaptive knots*/);
     this->InitSo3SplineSegments();
 
     /**
@@ -46,8 +46,11 @@
 #include "factor/prior_extri_so3_factor.hpp"
 #include "factor/prior_time_offset_factor.hpp"
 #include "calib/spat_temp_priori.h"
+#include "calib/inertial_integration_cache.h"
 #include <factor/hand_eye_transform_align_factor.hpp>
 #include "factor/regularization_l2_factor.hpp"
+#include "unordered_set"
+#include "Eigen/Sparse"
 
 namespace ns_ekalibr {
 std::shared_ptr<ceres::EigenQuaternionManifold> Estimator::QUATER_MANIFOLD(
@@ -107,6 +110,102 @@ Eigen::MatrixXd Estimator::GetHessianMatrix(const std::vector<double *> &conside
     return HMat;
 }
 
+Estimator::SchurSummary Estimator::MarginalizeParamBlocks(const std::vector<double *> &margBlocks,
+                                                          int numThread) {
+    SchurSummary summary;
+    std::unordered_set<double *> margSet;
+    for (auto *block : margBlocks) {
+        if (this->HasParameterBlock(block) && !this->IsParameterBlockConstant(block) &&
+            margSet.insert(block).second) {
+            summary.margBlocks.push_back(block);
+        }
+    }
+    std::vector<double *> parameterBlocks;
+    this->GetParameterBlocks(&parameterBlocks);
+    for (auto *block : parameterBlocks) {
+        if (!this->IsParameterBlockConstant(block) && margSet.count(block) == 0) {
+            summary.blocks.push_back(block);
+        }
+    }
+
+    // offsets of param blocks in the tangent space
+    auto TangentOffsets = [this](const std::vector<double *> &blocks) {
+        std::vector<int> offsets(1, 0);
+        for (auto *block : blocks) {
+            offsets.push_back(offsets.back() + this->ParameterBlockTangentSize(block));
+        }
+        return offsets;
+    };
+    summary.margOffsets = TangentOffsets(summary.margBlocks);
+    summary.offsets = TangentOffsets(summary.blocks);
+    const int mSize = summary.margOffsets.back(), rSize = summary.offsets.back();
+
+    // evaluate, where eliminated blocks come first
+    ceres::Problem::EvaluateOptions evalOpt;
+    evalOpt.parameter_blocks = summary.margBlocks;
+    evalOpt.parameter_blocks.insert(evalOpt.parameter_blocks.end(), summary.blocks.cbegin(),
+                                    summary.blocks.cend());
+    evalOpt.num_threads = numThread;
+
+    std::vector<double> residuals;
+    ceres::CRSMatrix jacobianCRSMatrix;
+    this->Evaluate(evalOpt, &summary.cost, &residuals, nullptr, &jacobianCRSMatrix);
+
+    const Eigen::SparseMatrix<double> JMat =
+        Eigen::Map<const Eigen::SparseMatrix<double, Eigen::RowMajor>>(
+            jacobianCRSMatrix.num_rows, jacobianCRSMatrix.num_cols,
+            static_cast<int>(jacobianCRSMatrix.values.size()), jacobianCRSMatrix.rows.data(),
+            jacobianCRSMatrix.cols.data(), jacobianCRSMatrix.values.data());
+    const Eigen::Map<const Eigen::VectorXd> rVec(residuals.data(),
+                                                 static_cast<int>(residuals.size()));
+    const Eigen::SparseMatrix<double> JmMat = JMat.leftCols(mSize);
+    const Eigen::SparseMatrix<double> JrMat = JMat.rightCols(rSize);
+
+    summary.H = Eigen::MatrixXd(JrMat.transpose() * JrMat);
+    summary.b = JrMat.transpose() * rVec;
+    if (mSize == 0) {
+        summary.margStep.setZero(0);
+        summary.margGain.setZero(0, rSize);
+        return summary;
+    }
+
+    // the block of eliminated params is sparse (banded for spline knots)
+    const Eigen::SparseMatrix<double> HmmMat = JmMat.transpose() * JmMat;
+    const Eigen::MatrixXd HmrMat = Eigen::MatrixXd(JmMat.transpose() * JrMat);
+    const Eigen::VectorXd bmVec = JmMat.transpose() * rVec;
+
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(HmmMat);
+    if (solver.info() != Eigen::Success) {
+        throw Status(Status::ERROR,
+                     "the eliminated param blocks are not well constrained, the Schur complement "
+                     "can not be performed!");
+    }
+    summary.margGain = -solver.solve(HmrMat);
+    summary.margStep = -solver.solve(bmVec);
+
+    // H = Hrr - Hrm * inv(Hmm) * Hmr, b = br - Hrm * inv(Hmm) * bm
+    summary.H += HmrMat.transpose() * summary.margGain;
+    summary.b += HmrMat.transpose() * summary.margStep;
+
+    return summary;
+}
+
+void Estimator::UpdateParamBlock(double *values, const double *delta) const {
+    const int size = this->ParameterBlockSize(values);
+    std::vector<double> updated(size);
+    if (const auto *manifold = this->GetManifold(values); manifold != nullptr) {
+        manifold->Plus(values, delta, updated.data());
+    } else {
+        for (int i = 0; i < size; ++i) {
+            updated.at(i) = values[i] + delta[i];
+        }
+    }
+    for (int i = 0; i < size; ++i) {
+        values[i] = std::clamp(updated.at(i), this->GetParameterLowerBound(values, i),
+                               this->GetParameterUpperBound(values, i));
+    }
+}
+
 void Estimator::PrintParameterInfo() const {
     std::vector<double *> parameterBlocks;
     this->GetParameterBlocks(&parameterBlocks);
@@ -163,22 +262,17 @@ void Estimator::AddRdKnotsData(std::vector<double *> &paramBlockVec,
                                const Estimator::PosSplineType &spline,
                                const Estimator::SplineMetaType &splineMeta,
                                bool setToConst) {
-    // for each segment
-    for (const auto &seg : splineMeta.segments) {
-        // the factor 'seg.dt * 0.5' is the treatment for numerical accuracy
-        auto idxMaster = spline.ComputeTIndex(seg.t0 + seg.dt * 0.5).second;
+    const std::size_t offset = paramBlockVec.size();
+    KnotsData(paramBlockVec, spline, splineMeta);
 
-        // from the first control point to the last control point
-        for (std::size_t i = idxMaster; i < idxMaster + seg.NumParameters(); ++i) {
-            auto *data = const_cast<double *>(spline.GetKnot(static_cast<int>(i)).data());
+    for (std::size_t i = offset; i < paramBlockVec.size(); ++i) {
+        auto *data = paramBlockVec.at(i);
 
-            this->AddParameterBlock(data, 3);
+        this->AddParameterBlock(data, 3);
 
-            paramBlockVec.push_back(data);
-            // set this param block to be constant
-            if (setToConst) {
-                this->SetParameterBlockConstant(data);
-            }
+        // set this param block to be constant
+        if (setToConst) {
+            this->SetParameterBlockConstant(data);
         }
     }
 }
@@ -187,24 +281,81 @@ void Estimator::AddSo3KnotsData(std::vector<double *> &paramBlockVec,
                                 const Estimator::So3SplineType &spline,
                                 const Estimator::SplineMetaType &splineMeta,
                                 bool setToConst) {
-    // for each segment
-    for (const auto &seg : splineMeta.segments) {
-        // the factor 'seg.dt * 0.5' is the treatment for numerical accuracy
-        auto idxMaster = spline.ComputeTIndex(seg.t0 + seg.dt * 0.5).second;
-
-        // from the first control point to the last control point
-        for (std::size_t i = idxMaster; i < idxMaster + seg.NumParameters(); ++i) {
-            auto *data = const_cast<double *>(spline.GetKnot(static_cast<int>(i)).data());
-            // the local parameterization is very important!!!
-            this->AddParameterBlock(data, 4, QUATER_MANIFOLD.get());
-
-            paramBlockVec.push_back(data);
+    const std::size_t offset = paramBlockVec.size();
+    KnotsData(paramBlockVec, spline, splineMeta);
+
+    for (std::size_t i = offset; i < paramBlockVec.size(); ++i) {
+        auto *data = paramBlockVec.at(i);
+        // the local parameterization is very important!!!
+        this->AddParameterBlock(data, 4, QUATER_MANIFOLD.get());
+
+        // set this param block to be constant
+        if (setToConst) {
+            this->SetParameterBlockConstant(data);
+        }
+    }
+}
+
+std::size_t Estimator::CommitResidualBlocks(const std::vector<ResidualBlockDesc> &descs,
+                                            bool so3KnotsConst,
+                                            bool scaleKnotsConst) {
+    // knots are registered once up front, in the order of descriptors
+    std::unordered_set<double *> knots;
+    for (const auto &desc : descs) {
+        for (std::size_t i = 0; i < desc.so3KnotCount + desc.scaleKnotCount; ++i) {
+            auto *data = desc.paramBlocks.at(i);
+            if (!knots.insert(data).second) {
+                continue;
+            }
+            if (i < desc.so3KnotCount) {
+                // the local parameterization is very important!!!
+                this->AddParameterBlock(data, 4, QUATER_MANIFOLD.get());
+            } else {
+                this->AddParameterBlock(data, 3);
+            }
             // set this param block to be constant
-            if (setToConst) {
+            if (i < desc.so3KnotCount ? so3KnotsConst : scaleKnotsConst) {
                 this->SetParameterBlockConstant(data);
             }
         }
     }
+
+    // pass to problem
+    std::size_t count = 0;
+    for (const auto &desc : descs) {
+        if (desc.costFunc == nullptr) {
+            continue;
+        }
+        this->AddResidualBlock(desc.costFunc, desc.lossFunc, desc.paramBlocks);
+        ++count;
+    }
+    return count;
+}
+
+std::vector<std::vector<IMUFrame::Ptr>> Estimator::GroupByKnotSpan(
+    const std::vector<IMUFrame::Ptr> &imuFrames,
+    double TO_BiToBr,
+    const So3SplineType &so3Spline,
+    const PosSplineType *posSpline) {
+    std::vector<std::vector<IMUFrame::Ptr>> groups;
+    std::pair<std::size_t, std::size_t> lastSpan;
+    for (const auto &frame : imuFrames) {
+        double curTime = frame->GetTimestamp() + TO_BiToBr;
+        // check point time stamp
+        if (!so3Spline.TimeStampInRange(curTime) ||
+            (posSpline != nullptr && !posSpline->TimeStampInRange(curTime))) {
+            continue;
+        }
+        std::pair<std::size_t, std::size_t> span = {
+            so3Spline.ComputeTIndex(curTime).second,
+            posSpline != nullptr ? posSpline->ComputeTIndex(curTime).second : 0};
+        if (groups.empty() || span != lastSpan) {
+            groups.emplace_back();
+            lastSpan = span;
+        }
+        groups.back().push_back(frame);
+    }
+    return groups;
 }
 
 Eigen::MatrixXd Estimator::CRSMatrix2EigenMatrix(const ceres::CRSMatrix *jacobian_crs_matrix) {
@@ -237,13 +388,7 @@ std::optional<std::pair<Eigen::Vector3d, Eigen::Matrix3d>> Estimator::InertialVe
     const std::string &imuTopic,
     double sTimeByBi,
     double eTimeByBi) const {
-    auto vecMatSeq = InertialIntegrationBase(so3Spline, data, imuTopic, sTimeByBi, eTimeByBi);
-    if (vecMatSeq.first.size() < 2 || vecMatSeq.second.size() < 2) {
-        // invalid integration data
-        return {};
-    }
-    return std::pair<Eigen::Vector3d, Eigen::Matrix3d>{TrapIntegrationOnce(vecMatSeq.first),
-                                                       TrapIntegrationOnce(vecMatSeq.second)};
+    return InertialIntegrationBase(so3Spline, data, imuTopic)->VelIntegration(sTimeByBi, eTimeByBi);
 }
 
 std::optional<std::pair<std::pair<Eigen::Vector3d, Eigen::Matrix3d>,
@@ -253,59 +398,22 @@ Estimator::InertialPosIntegration(const So3SplineType &so3Spline,
                                   const std::string &imuTopic,
                                   double sTimeByBi,
                                   double eTimeByBi) const {
-    auto vecMatSeq = InertialIntegrationBase(so3Spline, data, imuTopic, sTimeByBi, eTimeByBi);
-    if (vecMatSeq.first.size() < 2 || vecMatSeq.second.size() < 2) {
-        // invalid integration data
-        return {};
-    }
-    return std::pair<std::pair<Eigen::Vector3d, Eigen::Matrix3d>,
-                     std::pair<Eigen::Vector3d, Eigen::Matrix3d>>{
-        {TrapIntegrationOnce(vecMatSeq.first), TrapIntegrationOnce(vecMatSeq.second)},
-        {TrapIntegrationTwice(vecMatSeq.first), TrapIntegrationTwice(vecMatSeq.second)}};
+    return InertialIntegrationBase(so3Spline, data, imuTopic)->PosIntegration(sTimeByBi, eTimeByBi);
 }
 
-std::pair<std::vector<std::pair<double, Eigen::Vector3d>>,
-          std::vector<std::pair<double, Eigen::Matrix3d>>>
-Estimator::InertialIntegrationBase(const So3SplineType &so3Spline,
-                                   const std::vector<IMUFrame::Ptr> &data,
-                                   const std::string &imuTopic,
-                                   double sTimeByBi,
-                                   double eTimeByBi) const {
-    // vector and matrix sequence for integration
-    std::vector<std::pair<double, Eigen::Vector3d>> vecSeq;
-    std::vector<std::pair<double, Eigen::Matrix3d>> matSeq;
-
-    double timeOffset = parMagr->TEMPORAL.TO_BiToBr.at(imuTopic);
-    auto SO3_BiToBr = parMagr->EXTRI.SO3_BiToBr.at(imuTopic);
-
-    // extract data by considering the initialized time offsets
-    auto [sIter, eIter] = ExtractIMUDataPiece(data, sTimeByBi, eTimeByBi);
-
-    for (auto iter = sIter; iter != eIter; ++iter) {
-        const auto &frame = *iter;
-        double curTimeByBr = frame->GetTimestamp() + timeOffset;
-
-        if (!so3Spline.TimeStampInRange(curTimeByBr)) {
-            continue;
-        }
-
-        auto SO3_BrToBr0 = so3Spline.Evaluate(curTimeByBr);
-
-        // angular velocity in world
-        auto SO3_VEL_BrToBr0InBr0 = SO3_BrToBr0 * so3Spline.VelocityBody(curTimeByBr);
-        Eigen::Matrix3d SO3_VEL_MAT = Sophus::SO3d::hat(SO3_VEL_BrToBr0InBr0);
-
-        // angular acceleration in world
-        auto SO3_ACCE_BrToBr0InBr0 = SO3_BrToBr0 * so3Spline.AccelerationBody(curTimeByBr);
-        Eigen::Matrix3d SO3_ACCE_MAT = Sophus::SO3d::hat(SO3_ACCE_BrToBr0InBr0);
+const InertialIntegrationCachePtr &Estimator::InertialIntegrationBase(
+    const So3SplineType &so3Spline,
+    const std::vector<IMUFrame::Ptr> &data,
+    const std::string &imuTopic) const {
+    const double TO_BiToBr = parMagr->TEMPORAL.TO_BiToBr.at(imuTopic);
+    const auto &SO3_BiToBr = parMagr->EXTRI.SO3_BiToBr.at(imuTopic);
 
-        // store
-        vecSeq.emplace_back(curTimeByBr, SO3_BrToBr0 * SO3_BiToBr * frame->GetAcce());
-        matSeq.emplace_back(curTimeByBr,
-                            (SO3_ACCE_MAT + SO3_VEL_MAT * SO3_VEL_MAT) * SO3_BrToBr0.matrix());
+    // spline states are evaluated once for all alignment factors, unless parameters are changed
+    auto &cache = _inertialIntegCache[{&so3Spline, &data, imuTopic}];
+    if (cache == nullptr || !cache->IsBuiltWith(TO_BiToBr, SO3_BiToBr)) {
+        cache = InertialIntegrationCache::Create(so3Spline, data, TO_BiToBr, SO3_BiToBr);
     }
-
-    return {vecSeq, matSeq};
+    return cache;
 }
 
 /**
@@ -317,6 +425,48 @@ void Estimator::AddIMUGyroMeasurement(const So3SplineType &so3Spline,
                                       const std::string &topic,
                                       Opt option,
                                       double gyroWeight) {
+    auto desc = IMUGyroMeasurementDesc(so3Spline, imuFrame, topic, option, gyroWeight);
+    if (desc.costFunc == nullptr) {
+        return;
+    }
+    CommitResidualBlocks({desc}, !IsOptionWith(Opt::OPT_SO3_SPLINE, option), false);
+    SetIMUGyroParamBlocks(topic, option);
+}
+
+void Estimator::AddIMUGyroMeasurements(const So3SplineType &so3Spline,
+                                       const std::vector<IMUFrame::Ptr> &imuFrames,
+                                       const std::string &topic,
+                                       Opt option,
+                                       double gyroWeight) {
+    // descriptors are created in parallel, and then committed in order
+    std::vector<ResidualBlockDesc> descs;
+    if (IsOptionWith(Opt::OPT_TO_BiToBr, option)) {
+        // the knot span of a measurement is not determined if the time offset is estimated
+        descs.resize(imuFrames.size());
+#pragma omp parallel for
+        for (int i = 0; i < static_cast<int>(imuFrames.size()); ++i) {
+            descs[i] = IMUGyroMeasurementDesc(so3Spline, imuFrames[i], topic, option, gyroWeight);
+        }
+    } else {
+        // chronological measurements in the same knot span are grouped into one residual block
+        const auto groups = GroupByKnotSpan(imuFrames, parMagr->TEMPORAL.TO_BiToBr.at(topic),
+                                            so3Spline, nullptr);
+        descs.resize(groups.size());
+#pragma omp parallel for
+        for (int i = 0; i < static_cast<int>(groups.size()); ++i) {
+            descs[i] = IMUGyroIntervalDesc(so3Spline, groups[i], topic, gyroWeight);
+        }
+    }
+    if (CommitResidualBlocks(descs, !IsOptionWith(Opt::OPT_SO3_SPLINE, option), false) > 0) {
+        SetIMUGyroParamBlocks(topic, option);
+    }
+}
+
+Estimator::ResidualBlockDesc Estimator::IMUGyroMeasurementDesc(const So3SplineType &so3Spline,
+                                                               const IMUFrame::Ptr &imuFrame,
+                                                               const std::string &topic,
+                                                               Opt option,
+                                                               double gyroWeight) const {
     // prepare metas for splines
     SplineMetaType so3Meta;
 
@@ -330,7 +480,7 @@ void Estimator::AddIMUGyroMeasurement(const So3SplineType &so3Spline,
                          Configor::Prior::TimeOffsetPadding;
         // invalid time stamp
         if (!so3Spline.TimeStampInRange(minTime) || !so3Spline.TimeStampInRange(maxTime)) {
-            return;
+            return {};
         }
         SplineBundleType::CalculateSplineMeta(so3Spline, {{minTime, maxTime}}, so3Meta);
     } else {
@@ -338,15 +488,49 @@ void Estimator::AddIMUGyroMeasurement(const So3SplineType &so3Spline,
 
         // check point time stamp
         if (!so3Spline.TimeStampInRange(curTime)) {
-            return;
+            return {};
         }
         SplineBundleType::CalculateSplineMeta(so3Spline, {{curTime, curTime}}, so3Meta);
     }
 
-    // create a cost function
-    auto costFunc =
-        IMUGyroFactor<Configor::Prior::SplineOrder>::Create(so3Meta, imuFrame, gyroWeight);
+    // create a cost function, whose spline basis is precomputed if the time offset is constant
+    ceres::DynamicCostFunction *costFunc;
+    if (IsOptionWith(Opt::OPT_TO_BiToBr, option)) {
+        costFunc =
+            IMUGyroFactor<Configor::Prior::SplineOrder>::Create(so3Meta, imuFrame, gyroWeight);
+    } else {
+        costFunc = IMUGyroFixedTOFactor<Configor::Prior::SplineOrder>::Create(
+            so3Meta, imuFrame, parMagr->TEMPORAL.TO_BiToBr.at(topic), gyroWeight);
+    }
+
+    return IMUGyroResidualBlockDesc(costFunc, 3, so3Spline, so3Meta, topic);
+}
 
+Estimator::ResidualBlockDesc Estimator::IMUGyroIntervalDesc(
+    const So3SplineType &so3Spline,
+    const std::vector<IMUFrame::Ptr> &imuFrames,
+    const std::string &topic,
+    double gyroWeight) const {
+    const double TO_BiToBr = parMagr->TEMPORAL.TO_BiToBr.at(topic);
+
+    // all measurements are in the same knot span
+    SplineMetaType so3Meta;
+    const double curTime = imuFrames.front()->GetTimestamp() + TO_BiToBr;
+    SplineBundleType::CalculateSplineMeta(so3Spline, {{curTime, curTime}}, so3Meta);
+
+    auto costFunc = IMUGyroIntervalFactor<Configor::Prior::SplineOrder>::Create(
+        so3Meta, imuFrames, TO_BiToBr, gyroWeight);
+
+    return IMUGyroResidualBlockDesc(costFunc, static_cast<int>(imuFrames.size()) * 3, so3Spline,
+                                    so3Meta, topic);
+}
+
+Estimator::ResidualBlockDesc Estimator::IMUGyroResidualBlockDesc(
+    ceres::DynamicCostFunction *costFunc,
+    int numResiduals,
+    const So3SplineType &so3Spline,
+    const SplineMetaType &so3Meta,
+    const std::string &topic) const {
     // so3 knots param block [each has four sub params]
     for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
         costFunc->AddParameterBlock(4);
@@ -364,32 +548,37 @@ void Estimator::AddIMUGyroMeasurement(const So3SplineType &so3Spline,
     costFunc->AddParameterBlock(1);
 
     // set Residuals
-    costFunc->SetNumResiduals(3);
+    costFunc->SetNumResiduals(numResiduals);
 
     // organize the param block vector
-    std::vector<double *> paramBlockVec;
+    ResidualBlockDesc desc;
+    desc.costFunc = costFunc;
+    auto &paramBlockVec = desc.paramBlocks;
 
     // so3 knots param block
-    AddSo3KnotsData(paramBlockVec, so3Spline, so3Meta, !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+    KnotsData(paramBlockVec, so3Spline, so3Meta);
+    desc.so3KnotCount = paramBlockVec.size();
 
     // GYRO gyroBias
-    auto gyroBias = parMagr->INTRI.IMU.at(topic)->GYRO.BIAS.data();
-    paramBlockVec.push_back(gyroBias);
+    paramBlockVec.push_back(parMagr->INTRI.IMU.at(topic)->GYRO.BIAS.data());
     // GYRO map coeff
-    auto gyroMapCoeff = parMagr->INTRI.IMU.at(topic)->GYRO.MAP_COEFF.data();
-    paramBlockVec.push_back(gyroMapCoeff);
+    paramBlockVec.push_back(parMagr->INTRI.IMU.at(topic)->GYRO.MAP_COEFF.data());
     // SO3_AtoG
-    auto SO3_AtoG = parMagr->INTRI.IMU.at(topic)->SO3_AtoG.data();
-    paramBlockVec.push_back(SO3_AtoG);
+    paramBlockVec.push_back(parMagr->INTRI.IMU.at(topic)->SO3_AtoG.data());
     // SO3_BiToBr
-    auto SO3_BiToBr = parMagr->EXTRI.SO3_BiToBr.at(topic).data();
-    paramBlockVec.push_back(SO3_BiToBr);
+    paramBlockVec.push_back(parMagr->EXTRI.SO3_BiToBr.at(topic).data());
     // TIME_OFFSET_BiToBc
-    auto TIME_OFFSET_BiToBc = &parMagr->TEMPORAL.TO_BiToBr.at(topic);
-    paramBlockVec.push_back(TIME_OFFSET_BiToBc);
+    paramBlockVec.push_back(&parMagr->TEMPORAL.TO_BiToBr.at(topic));
 
-    // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
+    return desc;
+}
+
+void Estimator::SetIMUGyroParamBlocks(const std::string &topic, Opt option) {
+    auto gyroBias = parMagr->INTRI.IMU.at(topic)->GYRO.BIAS.data();
+    auto gyroMapCoeff = parMagr->INTRI.IMU.at(topic)->GYRO.MAP_COEFF.data();
+    auto SO3_AtoG = parMagr->INTRI.IMU.at(topic)->SO3_AtoG.data();
+    auto SO3_BiToBr = parMagr->EXTRI.SO3_BiToBr.at(topic).data();
+    auto TIME_OFFSET_BiToBc = &parMagr->TEMPORAL.TO_BiToBr.at(topic);
 
     this->SetManifold(SO3_AtoG, QUATER_MANIFOLD.get());
     this->SetManifold(SO3_BiToBr, QUATER_MANIFOLD.get());
@@ -864,6 +1053,53 @@ void Estimator::AddIMUAcceMeasurement(const So3SplineType &so3Spline,
                                       const std::string &topic,
                                       Opt option,
                                       double acceWeight) {
+    auto desc = IMUAcceMeasurementDesc(so3Spline, posSpline, imuFrame, topic, option, acceWeight);
+    if (desc.costFunc == nullptr) {
+        return;
+    }
+    CommitResidualBlocks({desc}, !IsOptionWith(Opt::OPT_SO3_SPLINE, option),
+                         !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+    SetIMUAcceParamBlocks(topic, option);
+}
+
+void Estimator::AddIMUAcceMeasurements(const So3SplineType &so3Spline,
+                                       const PosSplineType &posSpline,
+                                       const std::vector<IMUFrame::Ptr> &imuFrames,
+                                       const std::string &topic,
+                                       Opt option,
+                                       double acceWeight) {
+    // descriptors are created in parallel, and then committed in order
+    std::vector<ResidualBlockDesc> descs;
+    if (IsOptionWith(Opt::OPT_TO_BiToBr, option)) {
+        // the knot span of a measurement is not determined if the time offset is estimated
+        descs.resize(imuFrames.size());
+#pragma omp parallel for
+        for (int i = 0; i < static_cast<int>(imuFrames.size()); ++i) {
+            descs[i] = IMUAcceMeasurementDesc(so3Spline, posSpline, imuFrames[i], topic, option,
+                                              acceWeight);
+        }
+    } else {
+        // chronological measurements in the same knot spans are grouped into one residual block
+        const auto groups = GroupByKnotSpan(imuFrames, parMagr->TEMPORAL.TO_BiToBr.at(topic),
+                                            so3Spline, &posSpline);
+        descs.resize(groups.size());
+#pragma omp parallel for
+        for (int i = 0; i < static_cast<int>(groups.size()); ++i) {
+            descs[i] = IMUAcceIntervalDesc(so3Spline, posSpline, groups[i], topic, acceWeight);
+        }
+    }
+    if (CommitResidualBlocks(descs, !IsOptionWith(Opt::OPT_SO3_SPLINE, option),
+                             !IsOptionWith(Opt::OPT_SCALE_SPLINE, option)) > 0) {
+        SetIMUAcceParamBlocks(topic, option);
+    }
+}
+
+Estimator::ResidualBlockDesc Estimator::IMUAcceMeasurementDesc(const So3SplineType &so3Spline,
+                                                               const PosSplineType &posSpline,
+                                                               const IMUFrame::Ptr &imuFrame,
+                                                               const std::string &topic,
+                                                               Opt option,
+                                                               double acceWeight) const {
     // prepare metas for splines
     SplineMetaType so3Meta, scaleMeta;
 
@@ -878,7 +1114,7 @@ void Estimator::AddIMUAcceMeasurement(const So3SplineType &so3Spline,
         // invalid time stamp
         if (!so3Spline.TimeStampInRange(minTime) || !so3Spline.TimeStampInRange(maxTime) ||
             !posSpline.TimeStampInRange(minTime) || !posSpline.TimeStampInRange(maxTime)) {
-            return;
+            return {};
         }
         SplineBundleType::CalculateSplineMeta(so3Spline, {{minTime, maxTime}}, so3Meta);
         SplineBundleType::CalculateSplineMeta(posSpline, {{minTime, maxTime}}, scaleMeta);
@@ -887,15 +1123,53 @@ void Estimator::AddIMUAcceMeasurement(const So3SplineType &so3Spline,
 
         // check point time stamp
         if (!so3Spline.TimeStampInRange(curTime) || !posSpline.TimeStampInRange(curTime)) {
-            return;
+            return {};
         }
         SplineBundleType::CalculateSplineMeta(so3Spline, {{curTime, curTime}}, so3Meta);
         SplineBundleType::CalculateSplineMeta(posSpline, {{curTime, curTime}}, scaleMeta);
     }
-    // create a cost function
-    auto costFunc = IMUAcceFactor<Configor::Prior::SplineOrder, 2>::Create(so3Meta, scaleMeta,
-                                                                           imuFrame, acceWeight);
+    // create a cost function, whose spline basis is precomputed if the time offset is constant
+    ceres::DynamicCostFunction *costFunc;
+    if (IsOptionWith(Opt::OPT_TO_BiToBr, option)) {
+        costFunc = IMUAcceFactor<Configor::Prior::SplineOrder, 2>::Create(so3Meta, scaleMeta,
+                                                                          imuFrame, acceWeight);
+    } else {
+        costFunc = IMUAcceFixedTOFactor<Configor::Prior::SplineOrder, 2>::Create(
+            so3Meta, scaleMeta, imuFrame, parMagr->TEMPORAL.TO_BiToBr.at(topic), acceWeight);
+    }
+
+    return IMUAcceResidualBlockDesc(costFunc, 3, so3Spline, posSpline, so3Meta, scaleMeta, topic);
+}
+
+Estimator::ResidualBlockDesc Estimator::IMUAcceIntervalDesc(
+    const So3SplineType &so3Spline,
+    const PosSplineType &posSpline,
+    const std::vector<IMUFrame::Ptr> &imuFrames,
+    const std::string &topic,
+    double acceWeight) const {
+    const double TO_BiToBr = parMagr->TEMPORAL.TO_BiToBr.at(topic);
+
+    // all measurements are in the same knot spans
+    SplineMetaType so3Meta, scaleMeta;
+    const double curTime = imuFrames.front()->GetTimestamp() + TO_BiToBr;
+    SplineBundleType::CalculateSplineMeta(so3Spline, {{curTime, curTime}}, so3Meta);
+    SplineBundleType::CalculateSplineMeta(posSpline, {{curTime, curTime}}, scaleMeta);
+
+    auto costFunc = IMUAcceIntervalFactor<Configor::Prior::SplineOrder, 2>::Create(
+        so3Meta, scaleMeta, imuFrames, TO_BiToBr, acceWeight);
 
+    return IMUAcceResidualBlockDesc(costFunc, static_cast<int>(imuFrames.size()) * 3, so3Spline,
+                                    posSpline, so3Meta, scaleMeta, topic);
+}
+
+Estimator::ResidualBlockDesc Estimator::IMUAcceResidualBlockDesc(
+    ceres::DynamicCostFunction *costFunc,
+    int numResiduals,
+    const So3SplineType &so3Spline,
+    const PosSplineType &posSpline,
+    const SplineMetaType &so3Meta,
+    const SplineMetaType &scaleMeta,
+    const std::string &topic) const {
     // so3 knots param block [each has four sub params]
     for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
         costFunc->AddParameterBlock(4);
@@ -918,39 +1192,45 @@ void Estimator::AddIMUAcceMeasurement(const So3SplineType &so3Spline,
     // TO_BiToBr
     costFunc->AddParameterBlock(1);
 
-    costFunc->SetNumResiduals(3);
+    costFunc->SetNumResiduals(numResiduals);
 
     // organize the param block vector
-    std::vector<double *> paramBlockVec;
+    ResidualBlockDesc desc;
+    desc.costFunc = costFunc;
+    auto &paramBlockVec = desc.paramBlocks;
 
     // so3 knots param block
-    AddSo3KnotsData(paramBlockVec, so3Spline, so3Meta, !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+    KnotsData(paramBlockVec, so3Spline, so3Meta);
+    desc.so3KnotCount = paramBlockVec.size();
 
     // lin acce knots
-    AddRdKnotsData(paramBlockVec, posSpline, scaleMeta,
-                   !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+    KnotsData(paramBlockVec, posSpline, scaleMeta);
+    desc.scaleKnotCount = paramBlockVec.size() - desc.so3KnotCount;
 
     // ACCE_BIAS
-    auto acceBias = parMagr->INTRI.IMU.at(topic)->ACCE.BIAS.data();
-    paramBlockVec.push_back(acceBias);
+    paramBlockVec.push_back(parMagr->INTRI.IMU.at(topic)->ACCE.BIAS.data());
     // ACCE_MAP_COEFF
-    auto aceMapCoeff = parMagr->INTRI.IMU.at(topic)->ACCE.MAP_COEFF.data();
-    paramBlockVec.push_back(aceMapCoeff);
+    paramBlockVec.push_back(parMagr->INTRI.IMU.at(topic)->ACCE.MAP_COEFF.data());
     // GRAVITY
-    auto gravity = parMagr->GRAVITY.data();
-    paramBlockVec.push_back(gravity);
+    paramBlockVec.push_back(parMagr->GRAVITY.data());
     // SO3_BiToBc
-    auto SO3_BiToBc = parMagr->EXTRI.SO3_BiToBr.at(topic).data();
-    paramBlockVec.push_back(SO3_BiToBc);
+    paramBlockVec.push_back(parMagr->EXTRI.SO3_BiToBr.at(topic).data());
     // POS_BiInBc
-    auto POS_BiInBc = parMagr->EXTRI.POS_BiInBr.at(topic).data();
-    paramBlockVec.push_back(POS_BiInBc);
+    paramBlockVec.push_back(parMagr->EXTRI.POS_BiInBr.at(topic).data());
     // TIME_OFFSET_BiToBc
+    paramBlockVec.push_back(&parMagr->TEMPORAL.TO_BiToBr.at(topic));
+
+    return desc;
+}
+
+void Estimator::SetIMUAcceParamBlocks(const std::string &topic, Opt option) {
+    auto acceBias = parMagr->INTRI.IMU.at(topic)->ACCE.BIAS.data();
+    auto aceMapCoeff = parMagr->INTRI.IMU.at(topic)->ACCE.MAP_COEFF.data();
+    auto gravity = parMagr->GRAVITY.data();
+    auto SO3_BiToBc = parMagr->EXTRI.SO3_BiToBr.at(topic).data();
+    auto POS_BiInBc = parMagr->EXTRI.POS_BiInBr.at(topic).data();
     auto TIME_OFFSET_BiToBc = &parMagr->TEMPORAL.TO_BiToBr.at(topic);
-    paramBlockVec.push_back(TIME_OFFSET_BiToBc);
 
-    // pass to problem
-    this->AddResidualBlock(costFunc, nullptr, paramBlockVec);
     this->SetManifold(gravity, GRAVITY_MANIFOLD.get());
     this->SetManifold(SO3_BiToBc, QUATER_MANIFOLD.get());
 
@@ -1063,37 +1343,76 @@ void Estimator::AddSo3Constraint(const So3SplineType &so3Spline,
 void Estimator::AddVisualProjectionFactor(const So3SplineType &so3Spline,
                                           const PosSplineType &posSpline,
                                           const std::string &camTopic,
-                                          const VisualProjectionPairPtr &pair,
+                                          const VisualProjectionPair &pair,
                                           Opt option,
                                           double weight) {
+    auto desc = VisualProjectionDesc(so3Spline, posSpline, camTopic, pair, option, weight);
+    if (desc.costFunc == nullptr) {
+        return;
+    }
+    CommitResidualBlocks({desc}, !IsOptionWith(Opt::OPT_SO3_SPLINE, option),
+                         !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+    SetVisualProjectionParamBlocks(camTopic, option);
+}
+
+void Estimator::AddVisualProjectionFactors(const So3SplineType &so3Spline,
+                                           const PosSplineType &posSpline,
+                                           const std::string &camTopic,
+                                           const std::vector<VisualProjectionPair> &pairs,
+                                           Opt option,
+                                           double weight) {
+    // descriptors are created in parallel, and then committed in order
+    std::vector<ResidualBlockDesc> descs(pairs.size());
+#pragma omp parallel for
+    for (int i = 0; i < static_cast<int>(pairs.size()); ++i) {
+        descs[i] = VisualProjectionDesc(so3Spline, posSpline, camTopic, pairs[i], option, weight);
+    }
+    if (CommitResidualBlocks(descs, !IsOptionWith(Opt::OPT_SO3_SPLINE, option),
+                             !IsOptionWith(Opt::OPT_SCALE_SPLINE, option)) > 0) {
+        SetVisualProjectionParamBlocks(camTopic, option);
+    }
+}
+
+Estimator::ResidualBlockDesc Estimator::VisualProjectionDesc(const So3SplineType &so3Spline,
+                                                             const PosSplineType &posSpline,
+                                                             const std::string &camTopic,
+                                                             const VisualProjectionPair &pair,
+                                                             Opt option,
+                                                             double weight) const {
     // prepare metas for splines
     SplineMetaType so3Meta, scaleMeta;
 
     if (IsOptionWith(Opt::OPT_TO_CjToBr, option)) {
-        double minTime = pair->timestamp + parMagr->TEMPORAL.TO_CjToBr.at(camTopic) -
+        double minTime = pair.timestamp + parMagr->TEMPORAL.TO_CjToBr.at(camTopic) -
                          Configor::Prior::TimeOffsetPadding;
-        double maxTime = pair->timestamp + parMagr->TEMPORAL.TO_CjToBr.at(camTopic) +
+        double maxTime = pair.timestamp + parMagr->TEMPORAL.TO_CjToBr.at(camTopic) +
                          Configor::Prior::TimeOffsetPadding;
         // invalid time stamp
         if (!so3Spline.TimeStampInRange(minTime) || !so3Spline.TimeStampInRange(maxTime) ||
             !posSpline.TimeStampInRange(minTime) || !posSpline.TimeStampInRange(maxTime)) {
-            return;
+            return {};
         }
         SplineBundleType::CalculateSplineMeta(so3Spline, {{minTime, maxTime}}, so3Meta);
         SplineBundleType::CalculateSplineMeta(posSpline, {{minTime, maxTime}}, scaleMeta);
     } else {
-        double curTime = pair->timestamp + parMagr->TEMPORAL.TO_CjToBr.at(camTopic);
+        double curTime = pair.timestamp + parMagr->TEMPORAL.TO_CjToBr.at(camTopic);
 
         // check point time stamp
         if (!so3Spline.TimeStampInRange(curTime) || !posSpline.TimeStampInRange(curTime)) {
-            return;
+            return {};
         }
         SplineBundleType::CalculateSplineMeta(so3Spline, {{curTime, curTime}}, so3Meta);
         SplineBundleType::CalculateSplineMeta(posSpline, {{curTime, curTime}}, scaleMeta);
     }
-    // create a cost function
-    auto costFunc = VisualProjectionFactor<Configor::Prior::SplineOrder>::Create(so3Meta, scaleMeta,
-                                                                                 pair, weight);
+    // create a cost function, whose spline basis is precomputed if the time offset is constant
+    ceres::DynamicCostFunction *costFunc;
+    if (IsOptionWith(Opt::OPT_TO_CjToBr, option)) {
+        costFunc = VisualProjectionFactor<Configor::Prior::SplineOrder>::Create(
+            so3Meta, scaleMeta, pair, weight);
+    } else {
+        costFunc = VisualProjectionFixedTOFactor<Configor::Prior::SplineOrder>::Create(
+            so3Meta, scaleMeta, pair, parMagr->TEMPORAL.TO_CjToBr.at(camTopic), weight);
+    }
 
     // so3 knots param block [each has four sub params]
     for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
@@ -1123,24 +1442,25 @@ void Estimator::AddVisualProjectionFactor(const So3SplineType &so3Spline,
     costFunc->SetNumResiduals(2);
 
     // organize the param block vector
-    std::vector<double *> paramBlockVec;
+    ResidualBlockDesc desc;
+    desc.costFunc = costFunc;
+    desc.lossFunc = new ceres::HuberLoss(3.0 /* 3 * sigma as the outliers */);
+    auto &paramBlockVec = desc.paramBlocks;
 
     // so3 knots param block
-    AddSo3KnotsData(paramBlockVec, so3Spline, so3Meta, !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+    KnotsData(paramBlockVec, so3Spline, so3Meta);
+    desc.so3KnotCount = paramBlockVec.size();
 
     // lin acce knots
-    AddRdKnotsData(paramBlockVec, posSpline, scaleMeta,
-                   !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+    KnotsData(paramBlockVec, posSpline, scaleMeta);
+    desc.scaleKnotCount = paramBlockVec.size() - desc.so3KnotCount;
 
     // SO3_CjToBr
-    auto SO3_CjToBr = parMagr->EXTRI.SO3_CjToBr.at(camTopic).data();
-    paramBlockVec.push_back(SO3_CjToBr);
+    paramBlockVec.push_back(parMagr->EXTRI.SO3_CjToBr.at(camTopic).data());
     // POS_CjInBr
-    auto POS_CjInBr = parMagr->EXTRI.POS_CjInBr.at(camTopic).data();
-    paramBlockVec.push_back(POS_CjInBr);
+    paramBlockVec.push_back(parMagr->EXTRI.POS_CjInBr.at(camTopic).data());
     // TIME_OFFSET_CjToBr
-    auto TIME_OFFSET_CjToBr = &parMagr->TEMPORAL.TO_CjToBr.at(camTopic);
-    paramBlockVec.push_back(TIME_OFFSET_CjToBr);
+    paramBlockVec.push_back(&parMagr->TEMPORAL.TO_CjToBr.at(camTopic));
 
     auto &intri = parMagr->INTRI.Camera.at(camTopic);
     paramBlockVec.push_back(intri->FXAddress());
@@ -1149,9 +1469,15 @@ void Estimator::AddVisualProjectionFactor(const So3SplineType &so3Spline,
     paramBlockVec.push_back(intri->CYAddress());
     paramBlockVec.push_back(intri->DistCoeffAddress());
 
-    // pass to problem
-    this->AddResidualBlock(costFunc, new ceres::HuberLoss(3.0 /* 3 * sigma as the outliers */),
-                           paramBlockVec);
+    return desc;
+}
+
+void Estimator::SetVisualProjectionParamBlocks(const std::string &camTopic, Opt option) {
+    auto SO3_CjToBr = parMagr->EXTRI.SO3_CjToBr.at(camTopic).data();
+    auto POS_CjInBr = parMagr->EXTRI.POS_CjInBr.at(camTopic).data();
+    auto TIME_OFFSET_CjToBr = &parMagr->TEMPORAL.TO_CjToBr.at(camTopic);
+    auto &intri = parMagr->INTRI.Camera.at(camTopic);
+
     this->SetManifold(SO3_CjToBr, QUATER_MANIFOLD.get());
 
     if (!IsOptionWith(Opt::OPT_SO3_CjToBr, option)) {
@@ -0,0 +1,151 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "calib/inertial_integration_cache.h"
+
+namespace ns_ekalibr {
+InertialIntegrationCache::InertialIntegrationCache(const So3SplineType &so3Spline,
+                                                   const std::vector<IMUFrame::Ptr> &data,
+                                                   double TO_BiToBr,
+                                                   const Sophus::SO3d &SO3_BiToBr)
+    : _TO_BiToBr(TO_BiToBr),
+      _SO3_BiToBr(SO3_BiToBr) {
+    // measurements in the range of the spline
+    _frames.reserve(data.size());
+    for (const auto &frame : data) {
+        if (so3Spline.TimeStampInRange(frame->GetTimestamp() + TO_BiToBr)) {
+            _frames.push_back(frame);
+        }
+    }
+    const int n = static_cast<int>(_frames.size());
+    _timesByBr.resize(n);
+
+    // a few measurements in each time bucket
+    double bucketWidth = 0.0;
+    if (n > 1) {
+        bucketWidth = (_frames.back()->GetTimestamp() - _frames.front()->GetTimestamp()) / n * 4.0;
+    }
+    _framesIndex = TimeIndexed<IMUFrame>::Create(_frames, bucketWidth);
+
+    // states of the spline at measurements, which are independent of each other
+    std::vector<VecMat> states(n);
+#pragma omp parallel for
+    for (int k = 0; k < n; ++k) {
+        const auto &frame = _frames[k];
+        const double curTimeByBr = frame->GetTimestamp() + TO_BiToBr;
+        _timesByBr[k] = curTimeByBr;
+
+        auto SO3_BrToBr0 = so3Spline.Evaluate(curTimeByBr);
+
+        // angular velocity in world
+        auto SO3_VEL_BrToBr0InBr0 = SO3_BrToBr0 * so3Spline.VelocityBody(curTimeByBr);
+        Eigen::Matrix3d SO3_VEL_MAT = Sophus::SO3d::hat(SO3_VEL_BrToBr0InBr0);
+
+        // angular acceleration in world
+        auto SO3_ACCE_BrToBr0InBr0 = SO3_BrToBr0 * so3Spline.AccelerationBody(curTimeByBr);
+        Eigen::Matrix3d SO3_ACCE_MAT = Sophus::SO3d::hat(SO3_ACCE_BrToBr0InBr0);
+
+        states[k].first = SO3_BrToBr0 * SO3_BiToBr * frame->GetAcce();
+        states[k].second = (SO3_ACCE_MAT + SO3_VEL_MAT * SO3_VEL_MAT) * SO3_BrToBr0.matrix();
+    }
+
+    // prefix sums of the trapezoidal integration
+    _onceSum.resize(n, {Eigen::Vector3d::Zero(), Eigen::Matrix3d::Zero()});
+    for (int k = 1; k < n; ++k) {
+        const double dt = (_timesByBr[k] - _timesByBr[k - 1]) * 0.5;
+        _onceSum[k].first = _onceSum[k - 1].first + (states[k - 1].first + states[k].first) * dt;
+        _onceSum[k].second =
+            _onceSum[k - 1].second + (states[k - 1].second + states[k].second) * dt;
+    }
+
+    // the trapezoidal integration of '_onceSum' sampled at mid times of measurements
+    _twiceSum.resize(std::max(n - 1, 0), {Eigen::Vector3d::Zero(), Eigen::Matrix3d::Zero()});
+    for (int k = 1; k < n - 1; ++k) {
+        const double dt = (MidTime(k) - MidTime(k - 1)) * 0.5;
+        _twiceSum[k].first =
+            _twiceSum[k - 1].first + (_onceSum[k].first + _onceSum[k + 1].first) * dt;
+        _twiceSum[k].second =
+            _twiceSum[k - 1].second + (_onceSum[k].second + _onceSum[k + 1].second) * dt;
+    }
+}
+
+InertialIntegrationCache::Ptr InertialIntegrationCache::Create(
+    const So3SplineType &so3Spline,
+    const std::vector<IMUFrame::Ptr> &data,
+    double TO_BiToBr,
+    const Sophus::SO3d &SO3_BiToBr) {
+    return std::make_shared<InertialIntegrationCache>(so3Spline, data, TO_BiToBr, SO3_BiToBr);
+}
+
+bool InertialIntegrationCache::IsBuiltWith(double TO_BiToBr, const Sophus::SO3d &SO3_BiToBr) const {
+    return _TO_BiToBr == TO_BiToBr &&
+           _SO3_BiToBr.unit_quaternion().coeffs() == SO3_BiToBr.unit_quaternion().coeffs();
+}
+
+std::optional<std::pair<std::size_t, std::size_t>> InertialIntegrationCache::Range(
+    double sTimeByBi, double eTimeByBi) const {
+    auto range = _framesIndex->OpenRange(sTimeByBi, eTimeByBi);
+    if (range.size() < 2) {
+        // invalid integration data
+        return {};
+    }
+    return std::pair<std::size_t, std::size_t>(range.begin() - _frames.cbegin(),
+                                               range.end() - _frames.cbegin());
+}
+
+std::optional<InertialIntegrationCache::VecMat> InertialIntegrationCache::VelIntegration(
+    double sTimeByBi, double eTimeByBi) const {
+    auto range = Range(sTimeByBi, eTimeByBi);
+    if (range == std::nullopt) {
+        return {};
+    }
+    const auto [i, j] = *range;
+    return VecMat{_onceSum[j - 1].first - _onceSum[i].first,
+                  _onceSum[j - 1].second - _onceSum[i].second};
+}
+
+std::optional<std::pair<InertialIntegrationCache::VecMat, InertialIntegrationCache::VecMat>>
+InertialIntegrationCache::PosIntegration(double sTimeByBi, double eTimeByBi) const {
+    auto range = Range(sTimeByBi, eTimeByBi);
+    if (range == std::nullopt) {
+        return {};
+    }
+    const auto [i, j] = *range;
+    VecMat once{_onceSum[j - 1].first - _onceSum[i].first,
+                _onceSum[j - 1].second - _onceSum[i].second};
+    /**
+     * the once integration at the mid time of the k-th and (k+1)-th measurement in the window is
+     * '_onceSum[k + 1] - _onceSum[i]', the twice integration over mid times [i, j - 2] is hence
+     * '_twiceSum[j - 2] - _twiceSum[i] - _onceSum[i] * (MidTime(j - 2) - MidTime(i))'
+     */
+    const double dt = MidTime(j - 2) - MidTime(i);
+    VecMat twice{_twiceSum[j - 2].first - _twiceSum[i].first - _onceSum[i].first * dt,
+                 _twiceSum[j - 2].second - _twiceSum[i].second - _onceSum[i].second * dt};
+    return std::pair<VecMat, VecMat>{once, twice};
+}
+}  // namespace ns_ekalibr
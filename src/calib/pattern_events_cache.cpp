@@ -0,0 +1,389 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "calib/pattern_events_cache.h"
+#include "core/time_varying_ellipse.h"
+#include "sensor/event.h"
+#include "util/status.hpp"
+#include "algorithm"
+#include "array"
+#include "cstring"
+#include "cmath"
+
+namespace ns_ekalibr {
+
+namespace {
+constexpr char CacheMagic[4] = {'E', 'K', 'R', 'E'};
+constexpr std::uint32_t CacheVersion = 1;
+constexpr std::uint32_t FlagChecksum = 1u << 0;
+// magic, version, flags, time bias, grid count
+constexpr std::size_t HeaderSize = 4 + 4 + 4 + 8 + 4;
+// grid id, offset, size, checksum
+constexpr std::size_t IndexEntrySize = 4 + 8 + 8 + 4;
+// flags of a circle in a chunk
+constexpr std::uint8_t CircleHasEllipse = 1u << 0;
+constexpr std::uint8_t CircleHasEvents = 1u << 1;
+constexpr double TickPerSec = 1E9;
+
+template <class Type>
+void PutRaw(std::string &buf, const Type &val) {
+    buf.append(reinterpret_cast<const char *>(&val), sizeof(Type));
+}
+
+template <class Type>
+Type GetRaw(const char *&ptr, const char *end) {
+    if (ptr + sizeof(Type) > end) {
+        throw Status(Status::CRITICAL, "unexpected end of the raw event cache chunk!!!");
+    }
+    Type val;
+    std::memcpy(&val, ptr, sizeof(Type));
+    ptr += sizeof(Type);
+    return val;
+}
+
+void PutVarint(std::string &buf, std::uint64_t val) {
+    while (val >= 0x80) {
+        buf.push_back(static_cast<char>((val & 0x7F) | 0x80));
+        val >>= 7;
+    }
+    buf.push_back(static_cast<char>(val));
+}
+
+std::uint64_t GetVarint(const char *&ptr, const char *end) {
+    std::uint64_t val = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (ptr == end) {
+            break;
+        }
+        const auto byte = static_cast<std::uint8_t>(*ptr++);
+        val |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return val;
+        }
+    }
+    throw Status(Status::CRITICAL, "corrupted varint in the raw event cache chunk!!!");
+}
+
+std::uint64_t ZigZag(std::int64_t val) {
+    return (static_cast<std::uint64_t>(val) << 1) ^ static_cast<std::uint64_t>(val >> 63);
+}
+
+std::int64_t UnZigZag(std::uint64_t val) {
+    return static_cast<std::int64_t>(val >> 1) ^ -static_cast<std::int64_t>(val & 1);
+}
+}  // namespace
+
+PatternEventsCache::PatternEventsCache(std::string filename,
+                                       double timeBias,
+                                       bool checksum,
+                                       std::vector<ChunkIndex> index)
+    : _filename(std::move(filename)),
+      _timeBias(timeBias),
+      _checksum(checksum),
+      _index(std::move(index)) {}
+
+PatternEventsCache::Ptr PatternEventsCache::Open(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+    std::string header(HeaderSize, '\0');
+    if (!file.read(header.data(), HeaderSize) ||
+        std::memcmp(header.data(), CacheMagic, sizeof(CacheMagic)) != 0) {
+        return nullptr;
+    }
+    const char *ptr = header.data() + sizeof(CacheMagic), *end = header.data() + HeaderSize;
+    const auto version = GetRaw<std::uint32_t>(ptr, end);
+    if (version != CacheVersion) {
+        return nullptr;
+    }
+    const auto flags = GetRaw<std::uint32_t>(ptr, end);
+    const auto timeBias = GetRaw<double>(ptr, end);
+    const auto gridCount = GetRaw<std::uint32_t>(ptr, end);
+
+    std::string indexBytes(gridCount * IndexEntrySize, '\0');
+    if (!file.read(indexBytes.data(), static_cast<std::streamsize>(indexBytes.size()))) {
+        return nullptr;
+    }
+    ptr = indexBytes.data(), end = indexBytes.data() + indexBytes.size();
+    std::vector<ChunkIndex> index(gridCount);
+    for (auto &chunk : index) {
+        chunk.gridId = GetRaw<std::int32_t>(ptr, end);
+        chunk.offset = GetRaw<std::uint64_t>(ptr, end);
+        chunk.size = GetRaw<std::uint64_t>(ptr, end);
+        chunk.checksum = GetRaw<std::uint32_t>(ptr, end);
+    }
+    return std::make_shared<PatternEventsCache>(filename, timeBias, flags & FlagChecksum,
+                                                std::move(index));
+}
+
+bool PatternEventsCache::IsCacheFile(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::array<char, sizeof(CacheMagic)> magic{};
+    return file.is_open() && file.read(magic.data(), magic.size()) &&
+           std::memcmp(magic.data(), CacheMagic, sizeof(CacheMagic)) == 0;
+}
+
+bool PatternEventsCache::Save(const std::map<int, ExtractedCirclesVec> &data,
+                              const std::string &filename,
+                              double timeBias,
+                              bool checksum) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    // chunks are encoded first, so that the index table can be written ahead of them
+    std::vector<std::pair<int, const ExtractedCirclesVec *>> grids;
+    grids.reserve(data.size());
+    for (const auto &[id, circles] : data) {
+        grids.emplace_back(id, &circles);
+    }
+    std::vector<std::pair<int, std::string>> chunks(grids.size());
+#pragma omp parallel for
+    for (int i = 0; i < static_cast<int>(grids.size()); ++i) {
+        chunks.at(i) = {grids.at(i).first, EncodeChunk(*grids.at(i).second)};
+    }
+
+    std::string head;
+    head.reserve(HeaderSize + chunks.size() * IndexEntrySize);
+    head.append(CacheMagic, sizeof(CacheMagic));
+    PutRaw(head, CacheVersion);
+    PutRaw(head, checksum ? FlagChecksum : std::uint32_t(0));
+    PutRaw(head, timeBias);
+    PutRaw(head, static_cast<std::uint32_t>(chunks.size()));
+
+    std::uint64_t offset = HeaderSize + chunks.size() * IndexEntrySize;
+    for (const auto &[id, bytes] : chunks) {
+        PutRaw(head, static_cast<std::int32_t>(id));
+        PutRaw(head, offset);
+        PutRaw(head, static_cast<std::uint64_t>(bytes.size()));
+        PutRaw(head, checksum ? CRC32(bytes.data(), bytes.size()) : std::uint32_t(0));
+        offset += bytes.size();
+    }
+    file.write(head.data(), static_cast<std::streamsize>(head.size()));
+    for (const auto &[id, bytes] : chunks) {
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    return file.good();
+}
+
+double PatternEventsCache::GetTimeBias() const { return _timeBias; }
+
+std::vector<int> PatternEventsCache::GridIds() const {
+    std::vector<int> ids(_index.size());
+    std::transform(_index.cbegin(), _index.cend(), ids.begin(),
+                   [](const ChunkIndex &chunk) { return chunk.gridId; });
+    return ids;
+}
+
+const std::vector<PatternEventsCache::ChunkIndex> &PatternEventsCache::GetIndex() const {
+    return _index;
+}
+
+std::map<int, PatternEventsCache::ExtractedCirclesVec> PatternEventsCache::Load(
+    double newTimeBias, const std::vector<int> &gridIds) const {
+    std::ifstream file(_filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw Status(Status::CRITICAL, "can not open the raw event cache file '{}'!!!", _filename);
+    }
+    std::vector<const ChunkIndex *> chunks;
+    if (gridIds.empty()) {
+        for (const auto &chunk : _index) {
+            chunks.push_back(&chunk);
+        }
+    } else {
+        for (const auto &chunk : _index) {
+            if (std::find(gridIds.cbegin(), gridIds.cend(), chunk.gridId) != gridIds.cend()) {
+                chunks.push_back(&chunk);
+            }
+        }
+    }
+    std::map<int, ExtractedCirclesVec> rawEvsOfPattern;
+    for (const auto *chunk : chunks) {
+        rawEvsOfPattern[chunk->gridId] = DecodeChunk(ReadChunk(file, *chunk), newTimeBias);
+    }
+    return rawEvsOfPattern;
+}
+
+PatternEventsCache::ExtractedCirclesVec PatternEventsCache::LoadGrid(int gridId,
+                                                                     double newTimeBias) const {
+    auto iter = std::find_if(_index.cbegin(), _index.cend(),
+                             [gridId](const ChunkIndex &chunk) { return chunk.gridId == gridId; });
+    if (iter == _index.cend()) {
+        return {};
+    }
+    std::ifstream file(_filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw Status(Status::CRITICAL, "can not open the raw event cache file '{}'!!!", _filename);
+    }
+    return DecodeChunk(ReadChunk(file, *iter), newTimeBias);
+}
+
+std::string PatternEventsCache::ReadChunk(std::ifstream &file, const ChunkIndex &chunk) const {
+    std::string bytes(chunk.size, '\0');
+    file.seekg(static_cast<std::streamoff>(chunk.offset));
+    if (!file.read(bytes.data(), static_cast<std::streamsize>(chunk.size))) {
+        throw Status(Status::CRITICAL,
+                     "the chunk of grid '{}' in raw event cache file '{}' is truncated!!!",
+                     chunk.gridId, _filename);
+    }
+    if (_checksum && CRC32(bytes.data(), bytes.size()) != chunk.checksum) {
+        throw Status(Status::CRITICAL,
+                     "checksum of chunk of grid '{}' in raw event cache file '{}' mismatched!!!",
+                     chunk.gridId, _filename);
+    }
+    return bytes;
+}
+
+std::string PatternEventsCache::EncodeChunk(const ExtractedCirclesVec &circles) {
+    std::string buf;
+    PutVarint(buf, circles.size());
+    for (const auto &[tvCircle, rawEvs] : circles) {
+        std::uint8_t flags = 0;
+        if (tvCircle != nullptr) {
+            flags |= CircleHasEllipse;
+        }
+        if (rawEvs != nullptr) {
+            flags |= CircleHasEvents;
+        }
+        PutRaw(buf, flags);
+
+        if (tvCircle != nullptr) {
+            PutRaw(buf, tvCircle->st);
+            PutRaw(buf, tvCircle->et);
+            for (const Eigen::Vector2d *v : {&tvCircle->cx, &tvCircle->cy, &tvCircle->mx,
+                                             &tvCircle->my}) {
+                PutRaw(buf, (*v)(0));
+                PutRaw(buf, (*v)(1));
+            }
+            PutRaw(buf, tvCircle->theta.unit_complex()(0));
+            PutRaw(buf, tvCircle->theta.unit_complex()(1));
+            PutRaw(buf, static_cast<std::uint8_t>(tvCircle->type));
+        }
+
+        if (rawEvs != nullptr) {
+            const auto &events = rawEvs->GetEvents();
+            PutRaw(buf, rawEvs->GetTimestamp());
+            PutVarint(buf, events.size());
+            // the first event is delta encoded against zeros
+            std::int64_t lastTick = 0, lastX = 0, lastY = 0;
+            for (const auto &ev : events) {
+                const std::int64_t tick = std::llround(ev->GetTimestamp() * TickPerSec);
+                const auto &pos = ev->GetPos();
+                PutVarint(buf, ZigZag(tick - lastTick));
+                PutVarint(buf, ZigZag(pos(0) - lastX));
+                PutVarint(buf, (ZigZag(pos(1) - lastY) << 1) | ev->GetPolarity());
+                lastTick = tick, lastX = pos(0), lastY = pos(1);
+            }
+        }
+    }
+    return buf;
+}
+
+PatternEventsCache::ExtractedCirclesVec PatternEventsCache::DecodeChunk(const std::string &bytes,
+                                                                        double newTimeBias) const {
+    const char *ptr = bytes.data(), *end = bytes.data() + bytes.size();
+    // the time bias is applied while decoding, rather than in a separate pass over events
+    const double dt = _timeBias - newTimeBias;
+
+    ExtractedCirclesVec circles(GetVarint(ptr, end));
+    for (auto &[tvCircle, rawEvs] : circles) {
+        const auto flags = GetRaw<std::uint8_t>(ptr, end);
+
+        if (flags & CircleHasEllipse) {
+            tvCircle = std::make_shared<TimeVaryingEllipse>();
+            tvCircle->st = GetRaw<double>(ptr, end);
+            tvCircle->et = GetRaw<double>(ptr, end);
+            for (Eigen::Vector2d *v : {&tvCircle->cx, &tvCircle->cy, &tvCircle->mx,
+                                       &tvCircle->my}) {
+                (*v)(0) = GetRaw<double>(ptr, end);
+                (*v)(1) = GetRaw<double>(ptr, end);
+            }
+            const auto re = GetRaw<double>(ptr, end);
+            const auto im = GetRaw<double>(ptr, end);
+            tvCircle->theta = Sophus::SO2d(re, im);
+            tvCircle->type =
+                static_cast<TimeVaryingEllipse::TVType>(GetRaw<std::uint8_t>(ptr, end));
+        }
+
+        if (flags & CircleHasEvents) {
+            const auto timestamp = GetRaw<double>(ptr, end);
+            std::vector<Event::Ptr> events(GetVarint(ptr, end));
+            // the time bias is applied by the time domain of the array, i.e., read = tick + dt
+            const auto domain = EventTimeDomain::Create(-dt);
+            std::int64_t tick = 0, x = 0, y = 0;
+            for (auto &ev : events) {
+                tick += UnZigZag(GetVarint(ptr, end));
+                x += UnZigZag(GetVarint(ptr, end));
+                const auto yp = GetVarint(ptr, end);
+                y += UnZigZag(yp >> 1);
+                const bool polarity = yp & 1;
+
+                ev = Event::Create(static_cast<double>(tick) / TickPerSec, Event::PosType(x, y),
+                                   polarity, domain.get());
+            }
+            rawEvs = EventArray::Create(timestamp + dt, events, {domain});
+        }
+
+        // identical to the shift of loaded cereal archives, see 'LoadRawEventsOfExtractedPatterns'
+        if (tvCircle != nullptr && rawEvs != nullptr) {
+            tvCircle->st = tvCircle->st + dt;
+            tvCircle->et = tvCircle->et + dt;
+            tvCircle->cx(1) = -tvCircle->cx(0) * dt + tvCircle->cx(1);
+            tvCircle->cy(1) = -tvCircle->cy(0) * dt + tvCircle->cy(1);
+            tvCircle->mx(1) = -tvCircle->mx(0) * dt + tvCircle->mx(1);
+            tvCircle->my(1) = -tvCircle->my(0) * dt + tvCircle->my(1);
+        }
+    }
+    if (ptr != end) {
+        throw Status(Status::CRITICAL,
+                     "unexpected trailing bytes in the chunk of raw event cache file '{}'!!!",
+                     _filename);
+    }
+    return circles;
+}
+
+std::uint32_t PatternEventsCache::CRC32(const char *data, std::size_t size) {
+    static const auto Table = []() {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }();
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = Table[(crc ^ static_cast<std::uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+}  // namespace ns_ekalibr
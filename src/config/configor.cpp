@@ -72,8 +72,16 @@ Configor::Prior Configor::prior = {};
 double Configor::Prior::GravityNorm = {};
 double Configor::Prior::TimeOffsetPadding = {};
 bool Configor::Prior::OptTemporalParams = {};
+double Configor::Prior::InertialSamplingRate = {};
 Configor::Prior::CirclePatternConfig Configor::Prior::CirclePattern = {};
 double Configor::Prior::DecayTimeOfActiveEvents = 0.0;
+Configor::Prior::ActiveEventWindowConfig Configor::Prior::ActiveEventWindow = {};
+Configor::Prior::EventDenoiserConfig Configor::Prior::EventDenoiser = {};
+Configor::Prior::AsyncProjectionPairsConfig Configor::Prior::AsyncProjectionPairs = {};
+Configor::Prior::PartitionedSolverConfig Configor::Prior::PartitionedSolver = {};
+Configor::Prior::AdaptiveKnotsConfig Configor::Prior::AdaptiveKnots = {};
+Configor::Prior::MultiResolutionInitConfig Configor::Prior::MultiResolutionInit = {};
+Configor::Prior::InformativeSegmentsConfig Configor::Prior::InformativeSegments = {};
 Configor::Prior::CircleExtractorConfig Configor::Prior::CircleExtractor = {};
 Configor::Prior::NormFlowEstimatorConfig Configor::Prior::NormFlowEstimator = {};
 std::string Configor::Prior::SpatTempPrioriPath = {};
@@ -124,13 +132,27 @@ void Configor::PrintMainFields() {
             DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
                 DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
                     DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
-                        DESC_FORMAT DESC_FORMAT,
+                        DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                            DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                                DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                                    DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                                        DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
+                                            DESC_FORMAT,
         DESC_FIELD(EventTopics), DESC_FIELD(IMUTopics), DESC_FIELD(DataStream::RefIMUTopic),
         DESC_FIELD(DataStream::BagPath), DESC_FIELD(DataStream::BeginTime),
         DESC_FIELD(DataStream::Duration), DESC_FIELD(DataStream::OutputPath),
         DESC_FIELD(Prior::SpatTempPrioriPath), DESC_FIELD(Prior::GravityNorm),
         DESC_FIELD(Prior::TimeOffsetPadding), DESC_FIELD(Prior::OptTemporalParams),
-        DESC_FIELD(Prior::DecayTimeOfActiveEvents),
+        DESC_FIELD(Prior::InertialSamplingRate), DESC_FIELD(Prior::DecayTimeOfActiveEvents),
+        // fields for ActiveEventWindow
+        "ActiveEventWindow::MinEventCount", Prior::ActiveEventWindow.MinEventCount,
+        "ActiveEventWindow::TargetActivePixels", Prior::ActiveEventWindow.TargetActivePixels,
+        "ActiveEventWindow::MinWindowRate", Prior::ActiveEventWindow.MinWindowRate,
+        "ActiveEventWindow::MaxWindowRate", Prior::ActiveEventWindow.MaxWindowRate,
+        // fields for EventDenoiser
+        "EventDenoiser::BackgroundActivityWindow", Prior::EventDenoiser.BackgroundActivityWindow,
+        "EventDenoiser::RefractoryPeriod", Prior::EventDenoiser.RefractoryPeriod,
+        "EventDenoiser::HotPixelSigma", Prior::EventDenoiser.HotPixelSigma,
         // fields for CirclePattern
         "CirclePattern::Type", Prior::CirclePattern.Type,  // pattern type
         "CirclePattern::Cols", Prior::CirclePattern.Cols,  // number of circles (cols)
@@ -142,12 +164,36 @@ void Configor::PrintMainFields() {
         "CircleExtractor::ValidClusterAreaThd", Prior::CircleExtractor.ValidClusterAreaThd,
         "CircleExtractor::CircleClusterPairDirThd", Prior::CircleExtractor.CircleClusterPairDirThd,
         "CircleExtractor::PointToCircleDistThd", Prior::CircleExtractor.PointToCircleDistThd,
+        "CircleExtractor::PyramidLevels", Prior::CircleExtractor.PyramidLevels,
+        "CircleExtractor::PyramidCenterTolerance", Prior::CircleExtractor.PyramidCenterTolerance,
+        "CircleExtractor::TrackingROIPadding", Prior::CircleExtractor.TrackingROIPadding,
+        "CircleExtractor::TrackingFullScanInterval",
+        Prior::CircleExtractor.TrackingFullScanInterval,
         // fields for NormFlowEstimator
         "NormFlowEstimator::WinSizeInPlaneFit", Prior::NormFlowEstimator.WinSizeInPlaneFit,
         "NormFlowEstimator::RansacMaxIterations", Prior::NormFlowEstimator.RansacMaxIterations,
         "NormFlowEstimator::RansacInlierRatioThd", Prior::NormFlowEstimator.RansacInlierRatioThd,
         "NormFlowEstimator::EventToPlaneTimeDistThd",
         Prior::NormFlowEstimator.EventToPlaneTimeDistThd,
+        // fields for AsyncProjectionPairs
+        "AsyncProjectionPairs::MinSamplingInterval",
+        Prior::AsyncProjectionPairs.MinSamplingInterval, "AsyncProjectionPairs::PixelsPerSample",
+        Prior::AsyncProjectionPairs.PixelsPerSample, "AsyncProjectionPairs::MaxPairCount",
+        Prior::AsyncProjectionPairs.MaxPairCount,
+        // fields for PartitionedSolver
+        "PartitionedSolver::MaxIterations", Prior::PartitionedSolver.MaxIterations,
+        "PartitionedSolver::CostTolerance", Prior::PartitionedSolver.CostTolerance,
+        "PartitionedSolver::PolishIterations", Prior::PartitionedSolver.PolishIterations,
+        // fields for AdaptiveKnots
+        "AdaptiveKnots::MaxLevel", Prior::AdaptiveKnots.MaxLevel,
+        "AdaptiveKnots::GyroFitTolerance", Prior::AdaptiveKnots.GyroFitTolerance,
+        "AdaptiveKnots::AcceFitTolerance", Prior::AdaptiveKnots.AcceFitTolerance,
+        // fields for MultiResolutionInit
+        "MultiResolutionInit::Levels", Prior::MultiResolutionInit.Levels,
+        "MultiResolutionInit::PolishIterations", Prior::MultiResolutionInit.PolishIterations,
+        // fields for InformativeSegments
+        "InformativeSegments::WindowLength", Prior::InformativeSegments.WindowLength,
+        "InformativeSegments::BudgetRatio", Prior::InformativeSegments.BudgetRatio,
         // Preference
         "Preference::Outputs", GetOptString(Preference::Outputs), "Preference::OutputDataFormat",
         Preference::OutputDataFormatStr, DESC_FIELD(Preference::Visualization),
@@ -232,12 +278,33 @@ void Configor::CheckConfigure() {
             Status::ERROR,
             "the time offset padding (i.e., Prior::TimeOffsetPadding) should be positive!");
     }
+    if (Prior::InertialSamplingRate < 0.0) {
+        throw Status(Status::ERROR,
+                     "the sampling rate of inertial measurements (i.e., "
+                     "Prior::InertialSamplingRate) should be non-negative!");
+    }
     if (Prior::DecayTimeOfActiveEvents < 1E-6) {
         throw Status(Status::ERROR,
                      "the decay time of the surface of active events (i.e., "
                      "Prior::DecayTimeOfActiveEvents) should be positive!");
     }
 
+    if (Prior::ActiveEventWindow.MinEventCount < 0 ||
+        Prior::ActiveEventWindow.TargetActivePixels < 0) {
+        throw Status(Status::ERROR,
+                     "the event count and active pixel count of windows (i.e., "
+                     "ActiveEventWindow::MinEventCount, ActiveEventWindow::TargetActivePixels) "
+                     "should be non-negative!");
+    }
+
+    if (Prior::ActiveEventWindow.TargetActivePixels > 0 &&
+        (Prior::ActiveEventWindow.MinWindowRate < 1E-3 ||
+         Prior::ActiveEventWindow.MaxWindowRate < Prior::ActiveEventWindow.MinWindowRate)) {
+        throw Status(Status::ERROR,
+                     "the bounds of the window length (i.e., ActiveEventWindow::MinWindowRate, "
+                     "ActiveEventWindow::MaxWindowRate) should be positive and ordered!");
+    }
+
     if (Prior::CirclePattern.Cols == 0) {
         throw Status(Status::ERROR,
                      "the columns of circle grid pattern (i.e., "
@@ -280,6 +347,32 @@ void Configor::CheckConfigure() {
                      "CircleExtractor::PointToCircleDistThd) should be positive!");
     }
 
+    if (Prior::CircleExtractor.PyramidLevels < 0) {
+        throw Status(Status::ERROR,
+                     "the levels of the time-surface pyramid (i.e., "
+                     "CircleExtractor::PyramidLevels) should be non-negative!");
+    }
+
+    if (Prior::CircleExtractor.PyramidLevels > 0 &&
+        Prior::CircleExtractor.PyramidCenterTolerance < 1E-6 /*pixels*/) {
+        throw Status(Status::ERROR,
+                     "the center tolerance of the time-surface pyramid (i.e., "
+                     "CircleExtractor::PyramidCenterTolerance) should be positive!");
+    }
+
+    if (Prior::CircleExtractor.TrackingFullScanInterval < 0) {
+        throw Status(Status::ERROR,
+                     "the windows between two full-frame scans (i.e., "
+                     "CircleExtractor::TrackingFullScanInterval) should be non-negative!");
+    }
+
+    if (Prior::CircleExtractor.TrackingFullScanInterval > 0 &&
+        Prior::CircleExtractor.TrackingROIPadding < 0.0) {
+        throw Status(Status::ERROR,
+                     "the padding of the predicted grid region (i.e., "
+                     "CircleExtractor::TrackingROIPadding) should be non-negative!");
+    }
+
     if (Prior::NormFlowEstimator.RansacMaxIterations < 1) {
         throw Status(Status::ERROR,
                      "the ransac max iterations (i.e., NormFlowEstimator::RansacMaxIterations) "
@@ -305,6 +398,53 @@ void Configor::CheckConfigure() {
                      "the event-to-plane time dist threshold (i.e., "
                      "NormFlowEstimator::EventToPlaneTimeDistThd) should be larger than zero!");
     }
+
+    if (Prior::AsyncProjectionPairs.MinSamplingInterval < 1E-6) {
+        throw Status(Status::ERROR,
+                     "the sampling interval of asynchronous projection pairs (i.e., "
+                     "AsyncProjectionPairs::MinSamplingInterval) should be larger than zero!");
+    }
+
+    if (Prior::AsyncProjectionPairs.PixelsPerSample < 0.0 ||
+        Prior::AsyncProjectionPairs.MaxPairCount < 0) {
+        throw Status(Status::ERROR,
+                     "the pixels per sample and the pair budget of asynchronous projection pairs "
+                     "(i.e., AsyncProjectionPairs::PixelsPerSample, "
+                     "AsyncProjectionPairs::MaxPairCount) should be non-negative!");
+    }
+
+    if (Prior::PartitionedSolver.MaxIterations < 0 ||
+        Prior::PartitionedSolver.CostTolerance < 0.0 ||
+        Prior::PartitionedSolver.PolishIterations < 0) {
+        throw Status(Status::ERROR,
+                     "the iterations and the cost tolerance of the partitioned solver (i.e., "
+                     "PartitionedSolver::MaxIterations, PartitionedSolver::CostTolerance, "
+                     "PartitionedSolver::PolishIterations) should be non-negative!");
+    }
+
+    if (Prior::AdaptiveKnots.MaxLevel < 0 || Prior::AdaptiveKnots.GyroFitTolerance < 0.0 ||
+        Prior::AdaptiveKnots.AcceFitTolerance < 0.0) {
+        throw Status(Status::ERROR,
+                     "the max level and the fitting tolerances of adaptive knots (i.e., "
+                     "AdaptiveKnots::MaxLevel, AdaptiveKnots::GyroFitTolerance, "
+                     "AdaptiveKnots::AcceFitTolerance) should be non-negative!");
+    }
+
+    if (Prior::MultiResolutionInit.Levels < 0 || Prior::MultiResolutionInit.PolishIterations < 0) {
+        throw Status(Status::ERROR,
+                     "the levels and the polish iterations of the multi-resolution initialization "
+                     "(i.e., MultiResolutionInit::Levels, MultiResolutionInit::PolishIterations) "
+                     "should be non-negative!");
+    }
+
+    if (Prior::InformativeSegments.WindowLength <= 0.0 ||
+        Prior::InformativeSegments.BudgetRatio <= 0.0 ||
+        Prior::InformativeSegments.BudgetRatio > 1.0) {
+        throw Status(Status::ERROR,
+                     "the window length of informative segments (i.e., "
+                     "InformativeSegments::WindowLength) should be positive, and the budget ratio "
+                     "(i.e., InformativeSegments::BudgetRatio) should be in (0, 1]!");
+    }
 }
 
 Configor::Ptr Configor::Create() { return std::make_shared<Configor>(); }
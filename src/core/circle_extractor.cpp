@@ -41,6 +41,7 @@
 #include "core/time_varying_ellipse.h"
 #include "core/sae.h"
 #include "core/circle_grid.h"
+#include "core/spatial_hash.h"
 #include <queue>
 
 namespace ns_ekalibr {
@@ -264,18 +265,28 @@ EventCircleExtractor::ExtractCirclesGrid(const EventNormFlow::NormFlowPack::Ptr&
 
         return {false, centersIncmp /* incomplete grid pattern */, circles};
     } else {
+        /**
+         * associate the grid centers to the fitted circles. A uniform grid hash sized to the
+         * circle spacing is built for both point sets, and only mutual nearest pairs within a
+         * distance gate derived from the pattern spacing are accepted.
+         */
+        std::vector<cv::Point2f> candidates(matPoints.rows);
+        for (int i = 0; i < matPoints.rows; ++i) {
+            const auto& p = matPoints.at<cv::Vec2f>(i, 0);
+            candidates.at(i) = cv::Point2f(p(0), p(1));
+        }
+        const double spacing = EstimateGridSpacing(centers, gridSize, circlePatternType);
+        const auto candHash = SpatialGridHash::Create(candidates, spacing);
+        const auto cenHash = SpatialGridHash::Create(centers, spacing);
+        const auto matches = SpatialGridHash::MutualNearestMatch(*cenHash, *candHash,
+                                                                 GRID_MATCH_GATE_RATIO * spacing);
+
         ExtractedCirclesVec verifiedCircles(centers.size());
         for (int i = 0; i < static_cast<int>(centers.size()); ++i) {
-            const auto& c = centers.at(i);
-            const auto cVec = cv::Vec2f(c.x, c.y);
-            int j = 0;
-            double dist = cv::norm(matPoints.at<cv::Vec2f>(j, 0) - cVec, cv::NORM_L1);
-            for (int k = 1; k < matPoints.rows; ++k) {
-                if (double curDist = cv::norm(matPoints.at<cv::Vec2f>(k, 0) - cVec, cv::NORM_L1);
-                    curDist < dist) {
-                    j = k;
-                    dist = curDist;
-                }
+            const int j = matches.at(i);
+            if (j < 0) {
+                // a found grid center can not be associated to a fitted circle unambiguously
+                return {false, candidates /* incomplete grid pattern */, circles};
             }
             verifiedCircles.at(i) = circles.at(j);
         }
@@ -302,6 +313,112 @@ EventCircleExtractor::ExtractCirclesGrid(const EventNormFlow::NormFlowPack::Ptr&
     }
 }
 
+double EventCircleExtractor::EstimateGridSpacing(const std::vector<cv::Point2f>& centers,
+                                                 const cv::Size& gridSize,
+                                                 CirclePatternType circlePatternType) {
+    // distances between horizontally adjacent centers (the centers are stored row by row)
+    std::vector<double> dists;
+    dists.reserve(centers.size());
+    for (int r = 0; r < gridSize.height; ++r) {
+        for (int c = 0; c < gridSize.width - 1; ++c) {
+            const int idx = r * gridSize.width + c;
+            if (idx + 1 >= static_cast<int>(centers.size())) {
+                break;
+            }
+            dists.push_back(cv::norm(centers.at(idx + 1) - centers.at(idx)));
+        }
+    }
+    if (dists.empty()) {
+        return 1.0;
+    }
+    auto mid = dists.begin() + static_cast<long>(dists.size() / 2);
+    std::nth_element(dists.begin(), mid, dists.end());
+    double spacing = *mid;
+    if (circlePatternType == CirclePatternType::ASYMMETRIC_GRID) {
+        // for asymmetric grids, adjacent centers in a row are two spacings away, while the
+        // nearest neighbor lies on the diagonal
+        spacing *= M_SQRT1_2;
+    }
+    return std::max(spacing, 1.0);
+}
+
+std::vector<cv::Rect> EventCircleExtractor::CircleROIs(const ExtractedCirclesVec& circles,
+                                                       int scale,
+                                                       int margin,
+                                                       const cv::Size& imgSize) {
+    std::vector<cv::Rect> rois;
+    rois.reserve(circles.size());
+    const cv::Rect imgRect(cv::Point(0, 0), imgSize);
+    for (const auto& [circle, events] : circles) {
+        if (events == nullptr || events->GetEvents().empty()) {
+            continue;
+        }
+        int xMin = std::numeric_limits<int>::max(), yMin = std::numeric_limits<int>::max();
+        int xMax = std::numeric_limits<int>::min(), yMax = std::numeric_limits<int>::min();
+        for (const auto& event : events->GetEvents()) {
+            const auto pos = event->GetPos();
+            xMin = std::min(xMin, static_cast<int>(pos(0)));
+            xMax = std::max(xMax, static_cast<int>(pos(0)));
+            yMin = std::min(yMin, static_cast<int>(pos(1)));
+            yMax = std::max(yMax, static_cast<int>(pos(1)));
+        }
+        // a coarse cell 'c' covers full-resolution pixels [c * scale, (c + 1) * scale)
+        const cv::Rect roi(cv::Point(xMin * scale - margin, yMin * scale - margin),
+                           cv::Point((xMax + 1) * scale + margin, (yMax + 1) * scale + margin));
+        rois.push_back(roi & imgRect);
+    }
+    return rois;
+}
+
+bool EventCircleExtractor::CirclesInsideROI(const ExtractedCirclesVec& circles,
+                                            const cv::Rect& roi,
+                                            int margin,
+                                            const cv::Size& imgSize) {
+    // borders of the roi on the image border are never checked
+    const int xMin = roi.x > 0 ? roi.x + margin : std::numeric_limits<int>::min();
+    const int yMin = roi.y > 0 ? roi.y + margin : std::numeric_limits<int>::min();
+    const int xMax = roi.br().x < imgSize.width ? roi.br().x - 1 - margin
+                                                : std::numeric_limits<int>::max();
+    const int yMax = roi.br().y < imgSize.height ? roi.br().y - 1 - margin
+                                                 : std::numeric_limits<int>::max();
+    for (const auto& [circle, events] : circles) {
+        if (events == nullptr) {
+            continue;
+        }
+        for (const auto& event : events->GetEvents()) {
+            const auto pos = event->GetPos();
+            const auto x = static_cast<int>(pos(0)), y = static_cast<int>(pos(1));
+            if (x < xMin || x > xMax || y < yMin || y > yMax) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool EventCircleExtractor::CentersAgree(const std::vector<cv::Point2f>& centers,
+                                        const std::vector<cv::Point2f>& coarseCenters,
+                                        int scale,
+                                        double tolerance) {
+    if (centers.size() != coarseCenters.size()) {
+        return false;
+    }
+    // the center of coarse cell 'c' is at 'c * scale + (scale - 1) / 2' in full resolution
+    const auto s = static_cast<float>(scale), offset = 0.5f * static_cast<float>(scale - 1);
+    std::vector<cv::Point2f> mapped(coarseCenters.size());
+    for (int i = 0; i < static_cast<int>(coarseCenters.size()); ++i) {
+        mapped.at(i) = coarseCenters.at(i) * s + cv::Point2f(offset, offset);
+    }
+    /**
+     * the grid finder may order centers differently on the two levels (e.g., a flipped grid), so
+     * centers are associated by mutual nearest neighbors rather than by their indices
+     */
+    const auto fineHash = SpatialGridHash::Create(centers, tolerance);
+    const auto coarseHash = SpatialGridHash::Create(mapped, tolerance);
+    const auto matches = SpatialGridHash::MutualNearestMatch(*fineHash, *coarseHash, tolerance);
+    return std::all_of(matches.cbegin(), matches.cend(), [](int j) { return j >= 0; });
+}
+
 void EventCircleExtractor::Visualization(bool save, int grid2dIdx, const std::string& topic) const {
     if (!this->visualization) {
         return;
@@ -352,7 +469,8 @@ void EventCircleExtractor::InitMatsForVisualization(
 }
 
 cv::Mat EventCircleExtractor::CreateSAE(const std::string& topic,
-                                        const ExtractedCirclesVec& tvCirclesWithRawEvs) {
+                                        const ExtractedCirclesVec& tvCirclesWithRawEvs,
+                                        double decay) {
     const auto& config = Configor::DataStream::EventTopics.at(topic);
     auto sae = ActiveEventSurface::Create(config.Width, config.Height, 0.01);
     for (const auto& [tvEllipse, evs] : tvCirclesWithRawEvs) {
@@ -361,7 +479,8 @@ cv::Mat EventCircleExtractor::CreateSAE(const std::string& topic,
         }
     }
     // CV_8UC1
-    auto tsImg = sae->DecayTimeSurface(true, 0, Configor::Prior::DecayTimeOfActiveEvents);
+    auto tsImg = sae->DecayTimeSurface(
+        true, 0, decay > 0.0 ? decay : Configor::Prior::DecayTimeOfActiveEvents);
     // CV_8UC3
     cv::cvtColor(tsImg, tsImg, cv::COLOR_GRAY2BGR);
     return tsImg;
@@ -371,7 +490,8 @@ cv::Mat EventCircleExtractor::CreateSAEWithTVEllipses(
     const std::string& topic,
     const ExtractedCirclesVec& tvCirclesWithRawEvs,
     const CircleGrid2DPtr& grid) {
-    auto m = CreateSAE(topic, tvCirclesWithRawEvs);
+    // rendered with the window the grid is extracted from
+    auto m = CreateSAE(topic, tvCirclesWithRawEvs, grid->window);
     DrawTimeVaryingEllipses(m, grid->timestamp, tvCirclesWithRawEvs);
     return m;
 }
@@ -513,27 +633,51 @@ EventCircleExtractor::RawEventsOfCircleClusterPairs(
     const std::map<CircleClusterInfo::Ptr, CircleClusterInfo::Ptr>& pairs,
     const EventNormFlow::NormFlowPack::Ptr& nfPack) {
     cv::Mat occupyMat(nfPack->Rows(), nfPack->Cols(), CV_8UC1, cv::Scalar(0));
-    auto RawEventsOfEachCircleClusterPairs = [&occupyMat,
-                                              &nfPack](const CircleClusterInfo::Ptr& ccs) {
-        std::list<Event::Ptr> clusters;
-        for (const auto& nf : ccs->nfCluster) {
-            for (const auto& [ex, ey, et] : nfPack->nfs.at(nf)) {
-                if (auto& o = occupyMat.at<uchar>(ey, ex); o == 0) {
-                    clusters.push_back(Event::Create(et, {ex, ey}, ccs->polarity));
-                    o = 255;
+    /**
+     * if the source events are available, the raw events refer to them rather than copies, so
+     * that they are shared among grids (and deduplicated in serialization by 'std::shared_ptr').
+     * They are ordered by integer serials, which follow the temporal order
+     */
+    const auto& source = nfPack->eventSource;
+    auto RawEventsOfEachCircleClusterPairs = [&occupyMat, &nfPack,
+                                              &source](const CircleClusterInfo::Ptr& ccs) {
+        std::vector<Event::Ptr> clusters;
+        if (source != nullptr) {
+            std::vector<std::int64_t> serials;
+            for (const auto& nf : ccs->nfCluster) {
+                for (const auto& [ex, ey, et] : nfPack->nfs.at(nf)) {
+                    if (auto& o = occupyMat.at<uchar>(ey, ex); o == 0) {
+                        serials.push_back(nfPack->sourceSerials.at(ey * nfPack->Cols() + ex));
+                        o = 255;
+                    }
+                }
+            }
+            std::sort(serials.begin(), serials.end());
+            clusters.reserve(serials.size());
+            for (auto serial : serials) {
+                clusters.push_back(source->At(serial));
+            }
+        } else {
+            for (const auto& nf : ccs->nfCluster) {
+                for (const auto& [ex, ey, et] : nfPack->nfs.at(nf)) {
+                    if (auto& o = occupyMat.at<uchar>(ey, ex); o == 0) {
+                        clusters.push_back(Event::Create(et, {ex, ey}, ccs->polarity));
+                        o = 255;
+                    }
                 }
             }
+            std::stable_sort(clusters.begin(), clusters.end(),
+                             [](const Event::Ptr& e1, const Event::Ptr& e2) {
+                                 return e1->GetTimestamp() < e2->GetTimestamp();
+                             });
         }
-        clusters.sort([](const Event::Ptr& e1, const Event::Ptr& e2) {
-            return e1->GetTimestamp() < e2->GetTimestamp();
-        });
         return clusters;
     };
-    auto RemoveOldEvents = [](std::list<Event::Ptr>& clusters, double timestamp) {
-        auto it = clusters.begin();
-        while (it != clusters.end() && (*it)->GetTimestamp() < timestamp) {
-            ++it;
-        }
+    auto RemoveOldEvents = [](std::vector<Event::Ptr>& clusters, double timestamp) {
+        auto it = std::lower_bound(clusters.begin(), clusters.end(), timestamp,
+                                   [](const Event::Ptr& e, double t) {
+                                       return e->GetTimestamp() < t;
+                                   });
         clusters.erase(clusters.begin(), it);
     };
     std::vector<std::pair<EventArray::Ptr, EventArray::Ptr>> eventsOfCluster;
@@ -555,11 +699,8 @@ EventCircleExtractor::RawEventsOfCircleClusterPairs(
             continue;
         }
 
-        auto cAry = EventArray::Create(cEventAry.back()->GetTimestamp(),
-                                       {cEventAry.cbegin(), cEventAry.cend()});
-
-        auto rAry = EventArray::Create(rEventAry.back()->GetTimestamp(),
-                                       {rEventAry.cbegin(), rEventAry.cend()});
+        auto cAry = EventArray::Create(cEventAry.back()->GetTimestamp(), cEventAry);
+        auto rAry = EventArray::Create(rEventAry.back()->GetTimestamp(), rEventAry);
 
         eventsOfCluster.push_back({cAry, rAry});
     }
@@ -998,14 +1139,35 @@ EventCircleExtractor::ClusterNormFlowEvents(const EventNormFlow::NormFlowPack::P
      * 1: occupied
      * 2-65535: cluster idx
      */
-    cv::Mat pMat(nfPack->rawTimeSurfaceMap.size(), CV_16U, cv::Scalar(0));
-    cv::Mat nMat(nfPack->rawTimeSurfaceMap.size(), CV_16U, cv::Scalar(0));
-    for (const auto& event : nfPack->NormFlowInlierEvents()) {
-        Event::PosType::Scalar ex = event->GetPos()(0), ey = event->GetPos()(1);
-        if (event->GetPolarity()) {
-            pMat.at<ushort>(ey, ex) = 1;
-        } else {
-            nMat.at<ushort>(ey, ex) = 1;
+    /**
+     * labeling only covers the bounding box of inlier events, expanded by the dilation size so that
+     * dilated clusters are never clipped, thus the cost depends on the extent of the norm flows
+     * (e.g., the region of interest in tracking) rather than the sensor size
+     */
+    int xMin = nfPack->Cols(), yMin = nfPack->Rows(), xMax = -1, yMax = -1;
+    for (const auto& [nf, inliers] : nfPack->nfs) {
+        for (const auto& [x, y, t] : inliers) {
+            xMin = std::min(xMin, x), xMax = std::max(xMax, x);
+            yMin = std::min(yMin, y), yMax = std::max(yMax, y);
+        }
+    }
+    if (xMax < 0) {
+        return {};
+    }
+    const cv::Rect box = cv::Rect(cv::Point(xMin - clusterDilateSize, yMin - clusterDilateSize),
+                                  cv::Point(xMax + clusterDilateSize + 1,
+                                            yMax + clusterDilateSize + 1)) &
+                         cv::Rect(0, 0, nfPack->Cols(), nfPack->Rows());
+
+    cv::Mat pMat(box.size(), CV_16U, cv::Scalar(0));
+    cv::Mat nMat(box.size(), CV_16U, cv::Scalar(0));
+    for (const auto& [nf, inliers] : nfPack->nfs) {
+        for (const auto& [ex, ey, et] : inliers) {
+            if (nfPack->polarityMap.at<uchar>(ey, ex)) {
+                pMat.at<ushort>(ey - box.y, ex - box.x) = 1;
+            } else {
+                nMat.at<ushort>(ey - box.y, ex - box.x) = 1;
+            }
         }
     }
 
@@ -1094,13 +1256,13 @@ EventCircleExtractor::ClusterNormFlowEvents(const EventNormFlow::NormFlowPack::P
     // cv::imwrite(Configor::DataStream::DebugPath + "/connected_pMat.png", pMat);
     // cv::imwrite(Configor::DataStream::DebugPath + "/connected_nMat.png", nMat);
 
-    auto AssignNormFlowsToClasses = [&nfPack, &clusterAreaThd](
+    auto AssignNormFlowsToClasses = [&nfPack, &clusterAreaThd, &box](
                                         const cv::Mat& mat,
                                         const std::unordered_map<ushort, int>& classArea) {
         std::unordered_map<ushort, std::list<NormFlow::Ptr>> classNFs;
         for (const auto& [nf, inliers] : nfPack->nfs) {
             for (const auto& [x, y, t] : inliers) {
-                ushort cls = mat.at<ushort>(y, x);
+                ushort cls = mat.at<ushort>(y - box.y, x - box.x);
                 if (cls < 2) {
                     continue;
                 }
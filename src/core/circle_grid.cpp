@@ -38,19 +38,23 @@ CircleGrid2D::CircleGrid2D(int id,
                            double timestamp,
                            const std::vector<cv::Point2f>& centers,
                            const std::vector<uint8_t>& cenValidity,
-                           bool isComplete)
+                           bool isComplete,
+                           double window)
     : id(id),
       timestamp(timestamp),
       centers(centers),
       cenValidity(cenValidity),
-      isComplete(isComplete) {}
+      isComplete(isComplete),
+      window(window) {}
 
 CircleGrid2D::Ptr CircleGrid2D::Create(int id,
                                        double timestamp,
                                        const std::vector<cv::Point2f>& centers,
                                        const std::vector<uint8_t>& cenValidity,
-                                       bool isComplete) {
-    return std::make_shared<CircleGrid2D>(id, timestamp, centers, cenValidity, isComplete);
+                                       bool isComplete,
+                                       double window) {
+    return std::make_shared<CircleGrid2D>(id, timestamp, centers, cenValidity, isComplete,
+                                          window);
 }
 
 void CircleGrid2D::DrawCenters(cv::Mat& image, cv::Size patternSize) const {
@@ -0,0 +1,160 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "core/event_denoiser.h"
+#include "sensor/event.h"
+#include "spdlog/fmt/fmt.h"
+#include "algorithm"
+#include "limits"
+#include "cmath"
+
+namespace ns_ekalibr {
+std::size_t EventDenoiser::Statistics::Removed() const {
+    return hotPixel + refractory + backgroundActivity;
+}
+
+std::string EventDenoiser::Statistics::InfoString() const {
+    const double base = std::max<double>(1.0, static_cast<double>(total));
+    return fmt::format(
+        "'{}' of '{}' events removed ({:.2f}%), hot pixel: '{}' (from '{}' pixels), refractory: "
+        "'{}', background activity: '{}'",
+        Removed(), total, Removed() * 100.0 / base, hotPixel, hotPixelCount, refractory,
+        backgroundActivity);
+}
+
+EventDenoiser::EventDenoiser(
+    int w, int h, double baWindow, double refractoryPeriod, double hotPixelSigma)
+    : w(w),
+      h(h),
+      BA_WINDOW(baWindow),
+      REFRACTORY_PERIOD(refractoryPeriod),
+      HOT_PIXEL_SIGMA(hotPixelSigma),
+      _lastStamp((w + 2) * (h + 2), std::numeric_limits<double>::lowest()),
+      _lastAccepted((w + 2) * (h + 2), std::numeric_limits<double>::lowest()),
+      _isHot((w + 2) * (h + 2), 0) {}
+
+EventDenoiser::Ptr EventDenoiser::Create(
+    int w, int h, double baWindow, double refractoryPeriod, double hotPixelSigma) {
+    return std::make_shared<EventDenoiser>(w, h, baWindow, refractoryPeriod, hotPixelSigma);
+}
+
+void EventDenoiser::DetectHotPixels(const std::vector<EventArray::Ptr>& arrays) {
+    if (HOT_PIXEL_SIGMA <= 0.0) {
+        return;
+    }
+    std::vector<std::uint32_t> counts(_isHot.size(), 0);
+    for (const auto& ary : arrays) {
+        for (const auto& event : ary->GetEvents()) {
+            const auto& pos = event->GetPos();
+            ++counts[PaddedIndex(pos(0), pos(1))];
+        }
+    }
+
+    // robust statistics (median, MAD) of log counts of pixels with events
+    std::vector<double> logCounts;
+    for (auto count : counts) {
+        if (count > 0) {
+            logCounts.push_back(std::log(static_cast<double>(count)));
+        }
+    }
+    if (logCounts.size() < 2) {
+        return;
+    }
+    auto Median = [](std::vector<double>& data) {
+        auto mid = data.begin() + static_cast<long>(data.size() / 2);
+        std::nth_element(data.begin(), mid, data.end());
+        return *mid;
+    };
+    const double median = Median(logCounts);
+    for (auto& v : logCounts) {
+        v = std::abs(v - median);
+    }
+    // each sigma is at least a doubling of the rate, in case most pixels share the same count
+    const double sigma = std::max(1.4826 * Median(logCounts), std::log(2.0));
+    const double thd = median + HOT_PIXEL_SIGMA * sigma;
+
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0 && std::log(static_cast<double>(counts[i])) > thd) {
+            _isHot[i] = 1;
+            ++_stats.hotPixelCount;
+        }
+    }
+}
+
+std::vector<EventArray::Ptr> EventDenoiser::Filter(const std::vector<EventArray::Ptr>& arrays) {
+    const int stride = w + 2;
+    // offsets of the 8-neighborhood in padded buffers
+    const int neighbors[8] = {-stride - 1, -stride, -stride + 1, -1,
+                              1,           stride - 1, stride,   stride + 1};
+
+    std::vector<EventArray::Ptr> filtered;
+    filtered.reserve(arrays.size());
+    std::vector<Event::Ptr> kept;
+    for (const auto& ary : arrays) {
+        const auto& events = ary->GetEvents();
+        kept.clear();
+        kept.reserve(events.size());
+        for (const auto& event : events) {
+            const auto& pos = event->GetPos();
+            const int idx = PaddedIndex(pos(0), pos(1));
+            const double t = event->GetTimestamp();
+
+            if (_isHot[idx]) {
+                // hot pixels neither pass nor support their neighbors
+                ++_stats.hotPixel;
+                continue;
+            }
+            _lastStamp[idx] = t;
+
+            if (REFRACTORY_PERIOD > 0.0 && t - _lastAccepted[idx] < REFRACTORY_PERIOD) {
+                ++_stats.refractory;
+                continue;
+            }
+
+            if (BA_WINDOW > 0.0) {
+                double latest = _lastStamp[idx + neighbors[0]];
+                for (int k = 1; k < 8; ++k) {
+                    latest = std::max(latest, _lastStamp[idx + neighbors[k]]);
+                }
+                if (t - latest > BA_WINDOW) {
+                    ++_stats.backgroundActivity;
+                    continue;
+                }
+            }
+
+            _lastAccepted[idx] = t;
+            kept.push_back(event);
+        }
+        _stats.total += events.size();
+        filtered.push_back(EventArray::Create(ary->GetTimestamp(), kept, ary->GetTimeDomains()));
+    }
+    return filtered;
+}
+
+const EventDenoiser::Statistics& EventDenoiser::GetStatistics() const { return _stats; }
+}  // namespace ns_ekalibr
@@ -0,0 +1,126 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "core/grid_roi_predictor.h"
+#include "core/circle_grid.h"
+#include "util/utils_tpl.hpp"
+#include "algorithm"
+#include "limits"
+#include "cmath"
+
+namespace ns_ekalibr {
+GridROIPredictor::GridROIPredictor(const cv::Size& imgSize,
+                                   int margin,
+                                   double padding,
+                                   int fullScanInterval)
+    : _imgSize(imgSize),
+      _margin(margin),
+      _padding(padding),
+      _fullScanInterval(fullScanInterval),
+      _spacing(0.0),
+      _windowsSinceFullScan(0) {}
+
+GridROIPredictor::Ptr GridROIPredictor::Create(const cv::Size& imgSize,
+                                               int margin,
+                                               double padding,
+                                               int fullScanInterval) {
+    return std::make_shared<GridROIPredictor>(imgSize, margin, padding, fullScanInterval);
+}
+
+std::optional<cv::Rect> GridROIPredictor::Predict(double t) {
+    if (_fullScanInterval <= 0 || _history.size() < 3 ||
+        ++_windowsSinceFullScan >= _fullScanInterval) {
+        _windowsSinceFullScan = 0;
+        return std::nullopt;
+    }
+    const std::array<double, 3> tData{_history[0].first, _history[1].first, _history[2].first};
+    const auto basis = LagrangeBasis<double, 3>(t, tData);
+
+    // corners of the bounding box are extrapolated independently
+    double x0 = 0.0, y0 = 0.0, x1 = 0.0, y1 = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        const auto& box = _history[i].second;
+        x0 += basis[i] * box.x, x1 += basis[i] * (box.x + box.width);
+        y0 += basis[i] * box.y, y1 += basis[i] * (box.y + box.height);
+    }
+
+    // the last box is included, so that a poor extrapolation never loses the pattern entirely
+    const auto& last = _history.back().second;
+    const double motion = std::max({std::abs(x0 - last.x), std::abs(y0 - last.y),
+                                    std::abs(x1 - last.x - last.width),
+                                    std::abs(y1 - last.y - last.height)});
+    /**
+     * boxes only cover circle centers: the center spacing bounds the circle radius (with slack for
+     * the board approaching the camera), and the extrapolated motion is also padded backwards in
+     * case the motion changes abruptly
+     */
+    const double padding = _spacing + _margin + motion + _padding;
+    x0 = std::min(x0, last.x) - padding, x1 = std::max(x1, last.x + last.width) + padding;
+    y0 = std::min(y0, last.y) - padding, y1 = std::max(y1, last.y + last.height) + padding;
+
+    const cv::Rect roi = cv::Rect(cv::Point(cvFloor(x0), cvFloor(y0)),
+                                  cv::Point(cvCeil(x1) + 1, cvCeil(y1) + 1)) &
+                         cv::Rect(cv::Point(0, 0), _imgSize);
+    if (roi.empty()) {
+        _windowsSinceFullScan = 0;
+        return std::nullopt;
+    }
+    return roi;
+}
+
+void GridROIPredictor::Update(const CircleGrid2D::Ptr& grid) {
+    if (!grid->isComplete || grid->centers.empty() ||
+        (!_history.empty() && grid->timestamp <= _history.back().first)) {
+        _history.clear();
+        return;
+    }
+    double x0 = grid->centers.front().x, x1 = x0;
+    double y0 = grid->centers.front().y, y1 = y0;
+    for (const auto& c : grid->centers) {
+        x0 = std::min(x0, double(c.x)), x1 = std::max(x1, double(c.x));
+        y0 = std::min(y0, double(c.y)), y1 = std::max(y1, double(c.y));
+    }
+    _history.emplace_back(grid->timestamp, cv::Rect2d(x0, y0, x1 - x0, y1 - y0));
+
+    _spacing = 0.0;
+    for (const auto& c1 : grid->centers) {
+        double nearest = std::numeric_limits<double>::max();
+        for (const auto& c2 : grid->centers) {
+            if (&c1 != &c2) {
+                nearest = std::min(nearest, double(cv::norm(c1 - c2)));
+            }
+        }
+        if (nearest < std::numeric_limits<double>::max()) {
+            _spacing = std::max(_spacing, nearest);
+        }
+    }
+    if (_history.size() > 3) {
+        _history.pop_front();
+    }
+}
+}  // namespace ns_ekalibr
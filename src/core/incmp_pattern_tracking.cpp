@@ -36,7 +36,7 @@
 #include "util/utils_tpl.hpp"
 #include "core/circle_extractor.h"
 #include <core/time_varying_ellipse.h>
-#include <opencv2/flann/flann.hpp>
+#include "core/spatial_hash.h"
 #include <util/status.hpp>
 #include <calib/calib_solver_io.h>
 
@@ -69,112 +69,133 @@ std::set<int> InCmpPatternTracker::Tracking(
         cenNumThdForEachInCmpPattern, distThdToTrackCen);
 
     const auto& grid2ds = std::vector(pattern->GetGrid2d().cbegin(), pattern->GetGrid2d().cend());
-    std::map<int, CircleGrid2D::Ptr> circleGrid2ds;
+    const int gridCount = static_cast<int>(grid2ds.size());
 
-    bool isAscendingOrder = true;
-    std::set<int> processedIncmpGridIds, trackedGridIdx;
-    for (const auto& grid2d : grid2ds) {
+    // each incomplete grid is only tried to be tracked once
+    std::vector<uint8_t> isTracked(gridCount, 0), isProcessed(gridCount, 0);
+    std::vector<int> worklist;
+    for (int k = 0; k < gridCount; ++k) {
+        const auto& grid2d = grid2ds.at(k);
         if (grid2d->isComplete) {
-            trackedGridIdx.insert(grid2d->id);
+            isTracked.at(k) = 1;
+        } else if (static_cast<int>(grid2d->centers.size()) < cenNumThdForEachInCmpPattern) {
+            // no need to processed
+            isProcessed.at(k) = 1;
+        } else {
+            worklist.push_back(k);
         }
     }
+
+    // one spatial index over the centers of each incomplete grid, shared by all tracking attempts
+    std::vector<SpatialGridHash::Ptr> cenIndices(gridCount, nullptr);
+#pragma omp parallel for
+    for (int j = 0; j < static_cast<int>(worklist.size()); ++j) {
+        const int k = worklist.at(j);
+        cenIndices.at(k) = SpatialGridHash::Create(grid2ds.at(k)->centers, distThdToTrackCen);
+    }
+
+    auto IsTracked = [&isTracked, gridCount](int k) {
+        return k >= 0 && k < gridCount && isTracked.at(k) != 0;
+    };
+
+    /**
+     * worklist-based tracking: in each round, all grids that can be predicted from three adjacent
+     * tracked grids are processed (in parallel), only the grids adjacent to the newly tracked ones
+     * are revisited in the next round, instead of re-sweeping the whole sequence
+     */
     int trackingLoopCount = 0;
-    while (true) {
-        int newIncmpGridTrackedCount = 0;
-        for (int i = 1; i < static_cast<int>(grid2ds.size()) - 3; i++) {
-            auto grid1 = grid2ds.at(i), grid2 = grid2ds.at(i + 1), grid3 = grid2ds.at(i + 2);
-            if (trackedGridIdx.count(grid1->id) == 0 ||  // 'grid1' is not tracked
-                trackedGridIdx.count(grid2->id) == 0 ||  // 'grid2' is not tracked
-                trackedGridIdx.count(grid3->id) == 0) {  // 'grid3' is not tracked
-                continue;
-            }
-            const int headIdx = i - 1, tailIdx = i + 3;
-            const auto& gridToTrack = isAscendingOrder ? grid2ds.at(tailIdx) : grid2ds.at(headIdx);
-            if (trackedGridIdx.count(gridToTrack->id) != 0) {
-                // this grid has been tracked
-                continue;
-            }
-            if (processedIncmpGridIds.count(gridToTrack->id) != 0) {
-                // this grid has been processed
-                continue;
-            }
-            if (static_cast<int>(gridToTrack->centers.size()) < cenNumThdForEachInCmpPattern) {
-                // no need to processed
-                processedIncmpGridIds.insert(gridToTrack->id);
+    while (!worklist.empty()) {
+        // the index of the grid to track, and its three reference grids (the last is the nearest)
+        std::vector<std::pair<int, std::array<int, 3>>> attempts;
+        for (int k : worklist) {
+            if (isTracked.at(k) || isProcessed.at(k)) {
                 continue;
             }
-            if (!isAscendingOrder) {
-                auto gridTmp = grid1;
-                grid1 = grid3;
-                grid3 = gridTmp;
+            if (IsTracked(k - 3) && IsTracked(k - 2) && IsTracked(k - 1)) {
+                // ascending order, predicted by the three preceding grids
+                attempts.push_back({k, {k - 3, k - 2, k - 1}});
+            } else if (IsTracked(k + 3) && IsTracked(k + 2) && IsTracked(k + 1)) {
+                // descending order, predicted by the three following grids
+                attempts.push_back({k, {k + 3, k + 2, k + 1}});
             }
-            // spdlog::info("'isAscendingOrder': {}, try to track 2d grid: [{}, {}, {}]->[{}]",
-            //              static_cast<int>(isAscendingOrder), grid1->id, grid2->id, grid3->id,
-            //              gridToTrack->id);
+        }
+        if (attempts.empty()) {
+            break;
+        }
+
+        // attempts in the same round are independent: their reference grids are all tracked
+        std::vector<std::vector<int>> results(attempts.size());
+#pragma omp parallel for if (!visualization)
+        for (int j = 0; j < static_cast<int>(attempts.size()); ++j) {
+            const auto& [k, refs] = attempts.at(j);
+            results.at(j) = TryToTrackInCmpGridPattern(
+                topic, grid2ds.at(refs[0]), grid2ds.at(refs[1]), grid2ds.at(refs[2]),
+                grid2ds.at(k), *cenIndices.at(k), tvCirclesWithRawEvs);
+        }
+
+        // commit in order, and collect the grids adjacent to the newly tracked ones
+        std::set<int> nextWorklist;
+        for (int j = 0; j < static_cast<int>(attempts.size()); ++j) {
+            const int k = attempts.at(j).first;
+            const auto& gridToTrack = grid2ds.at(k);
+            const auto& incmpGridPatternIdx = results.at(j);
+            isProcessed.at(k) = 1;
 
-            auto incmpGridPatternIdx = TryToTrackInCmpGridPattern(topic, grid1, grid2, grid3,
-                                                                  gridToTrack, tvCirclesWithRawEvs);
             // good count (tracked centers)
             const std::size_t trackedCount =
                 std::count_if(incmpGridPatternIdx.cbegin(), incmpGridPatternIdx.cend(),
                               [](int value) { return value >= 0; });
 
-            // tracked success
-            if (static_cast<int>(trackedCount) >= cenNumThdForEachInCmpPattern) {
-                // store
-                auto oldCenters = gridToTrack->centers;
-                gridToTrack->centers.resize(incmpGridPatternIdx.size());
-                gridToTrack->cenValidity.resize(incmpGridPatternIdx.size());
-
-                const auto& rawEvsOfGridToTrack = tvCirclesWithRawEvs.at(gridToTrack->id);
-                ExtractedCirclesVec newRawEvsOfGridToTrack(incmpGridPatternIdx.size());
-
-                for (std::size_t j = 0; j < incmpGridPatternIdx.size(); j++) {
-                    auto cenIdxInOldCenters = incmpGridPatternIdx.at(j);
-                    if (cenIdxInOldCenters >= 0) {
-                        // tracked
-                        gridToTrack->centers.at(j) = oldCenters.at(cenIdxInOldCenters);
-                        gridToTrack->cenValidity.at(j) = 1;
-                        newRawEvsOfGridToTrack.at(j) = rawEvsOfGridToTrack.at(cenIdxInOldCenters);
-                    } else {
-                        // not tracked
-                        gridToTrack->centers.at(j) = cv::Point2f(-1.0f, -1.0f);
-                        gridToTrack->cenValidity.at(j) = 0;
-                        newRawEvsOfGridToTrack.at(j) = {};
-                    }
-                }
-                tvCirclesWithRawEvs.at(gridToTrack->id) = newRawEvsOfGridToTrack;
-
-                trackedGridIdx.insert(gridToTrack->id);
-
-                newIncmpGridTrackedCount += 1;
-                // break continuous tracking
-                i += 1;
-
-                // spdlog::info("grid '{}' is tracked, with valid '{}'>'{}' centers.",
-                // gridToTrack->id, trackedCount, cenNumThdForEachInCmpPattern);
-            } else {
+            if (static_cast<int>(trackedCount) < cenNumThdForEachInCmpPattern) {
                 // spdlog::warn("grid '{}' is not tracked: valid '{}'<'{}' centers.",
                 // gridToTrack->id, trackedCount, cenNumThdForEachInCmpPattern);
+                continue;
             }
 
-            processedIncmpGridIds.insert(gridToTrack->id);
+            // tracked success, store
+            auto oldCenters = gridToTrack->centers;
+            gridToTrack->centers.resize(incmpGridPatternIdx.size());
+            gridToTrack->cenValidity.resize(incmpGridPatternIdx.size());
+
+            const auto& rawEvsOfGridToTrack = tvCirclesWithRawEvs.at(gridToTrack->id);
+            ExtractedCirclesVec newRawEvsOfGridToTrack(incmpGridPatternIdx.size());
+
+            for (std::size_t i = 0; i < incmpGridPatternIdx.size(); i++) {
+                auto cenIdxInOldCenters = incmpGridPatternIdx.at(i);
+                if (cenIdxInOldCenters >= 0) {
+                    // tracked
+                    gridToTrack->centers.at(i) = oldCenters.at(cenIdxInOldCenters);
+                    gridToTrack->cenValidity.at(i) = 1;
+                    newRawEvsOfGridToTrack.at(i) = rawEvsOfGridToTrack.at(cenIdxInOldCenters);
+                } else {
+                    // not tracked
+                    gridToTrack->centers.at(i) = cv::Point2f(-1.0f, -1.0f);
+                    gridToTrack->cenValidity.at(i) = 0;
+                    newRawEvsOfGridToTrack.at(i) = {};
+                }
+            }
+            tvCirclesWithRawEvs.at(gridToTrack->id) = newRawEvsOfGridToTrack;
+            isTracked.at(k) = 1;
+
+            for (int n = std::max(k - 3, 0); n <= std::min(k + 3, gridCount - 1); ++n) {
+                if (!isTracked.at(n) && !isProcessed.at(n)) {
+                    nextWorklist.insert(n);
+                }
+            }
         }
+        worklist.assign(nextWorklist.cbegin(), nextWorklist.cend());
         ++trackingLoopCount;
-        isAscendingOrder = !isAscendingOrder;
-        // spdlog::info("'newIncmpGridTrackedCount' in this tracking loop: {}",
-        //              newIncmpGridTrackedCount);
-        if (newIncmpGridTrackedCount == 0 && trackingLoopCount >= 2) {
-            break;
-        }
     }
 
     std::set<int> tackedIncmpGridIdx;
-    for (const auto& grid2d : grid2ds) {
-        if (!grid2d->isComplete && trackedGridIdx.count(grid2d->id) != 0) {
-            tackedIncmpGridIdx.insert(grid2d->id);
+    for (int k = 0; k < gridCount; ++k) {
+        if (!grid2ds.at(k)->isComplete && isTracked.at(k)) {
+            tackedIncmpGridIdx.insert(grid2ds.at(k)->id);
         }
     }
+    spdlog::info(
+        "InCmpPatternTracker::Tracking: '{}' incomplete grids are tracked in '{}' worklist rounds",
+        tackedIncmpGridIdx.size(), trackingLoopCount);
 
     return tackedIncmpGridIdx;
 }
@@ -185,6 +206,7 @@ std::vector<int> InCmpPatternTracker::TryToTrackInCmpGridPattern(
     const CircleGrid2DPtr& grid2,
     const CircleGrid2DPtr& grid3,
     const CircleGrid2DPtr& gridToTrack,
+    const SpatialGridHash& cenIndex,
     const std::map<int, ExtractedCirclesVec>& tvCirclesWithRawEvs) const {
     std::array<cv::Mat, 4> mats;
     if (visualization) {
@@ -201,15 +223,12 @@ std::vector<int> InCmpPatternTracker::TryToTrackInCmpGridPattern(
     assert(size == grid2->centers.size());
     assert(size == grid3->centers.size());
 
-    cv::Mat data(static_cast<int>(gridToTrack->centers.size()), 2, CV_32F);
-    for (int i = 0; i < static_cast<int>(gridToTrack->centers.size()); ++i) {
-        data.at<float>(i, 0) = gridToTrack->centers[i].x;
-        data.at<float>(i, 1) = gridToTrack->centers[i].y;
-    }
-    cv::flann::Index kdtree(data, cv::flann::KDTreeIndexParams(1));
+    // all centers are sampled at the same three timestamps, thus share the same lagrange basis
+    const std::array<double, 3> tData{grid1->timestamp, grid2->timestamp, grid3->timestamp};
+    const auto basis = LagrangeBasis<double, 3>(gridToTrack->timestamp, tData);
 
-    // the nearest point index, and corresponding distance (pixels)
-    std::vector<std::optional<std::pair<std::size_t, double>>> nearestPts(size, std::nullopt);
+    // the nearest point index, and corresponding distance (pixels), -1 means not found
+    std::vector<std::pair<int, double>> nearestPts(size, {-1, 0.0});
 
     for (int i = 0; i < size; i++) {
         if (!grid1->cenValidity[i] || !grid2->cenValidity[i] || !grid3->cenValidity[i]) {
@@ -217,20 +236,12 @@ std::vector<int> InCmpPatternTracker::TryToTrackInCmpGridPattern(
         }
         const auto &c1 = grid1->centers[i], c2 = grid2->centers[i], c3 = grid3->centers[i];
 
-        std::array<double, 3> tData{grid1->timestamp, grid2->timestamp, grid3->timestamp};
-        std::array<double, 3> xData{c1.x, c2.x, c3.x};
-        std::array<double, 3> yData{c1.y, c2.y, c3.y};
-        double xPred = LagrangePolynomial<double, 3>(gridToTrack->timestamp, tData, xData);
-        double yPred = LagrangePolynomial<double, 3>(gridToTrack->timestamp, tData, yData);
+        const double xPred = basis[0] * c1.x + basis[1] * c2.x + basis[2] * c3.x;
+        const double yPred = basis[0] * c1.y + basis[1] * c2.y + basis[2] * c3.y;
         auto pPred = cv::Point2f(static_cast<float>(xPred), static_cast<float>(yPred));
 
-        cv::Mat query = (cv::Mat_<float>(1, 2) << pPred.x, pPred.y);
-        std::vector<int> indices(1);
-        std::vector<float> dists(1);
-        kdtree.knnSearch(query, indices, dists, 1);
-        float distance = std::sqrt(dists[0]);
-        if (distance < distThdToTrackCen) {
-            nearestPts.at(i) = {indices[0], distance};
+        if (auto nearest = cenIndex.Nearest(pPred, distThdToTrackCen); nearest != std::nullopt) {
+            nearestPts.at(i) = *nearest;
         }
 
         if (visualization) {
@@ -247,36 +258,23 @@ std::vector<int> InCmpPatternTracker::TryToTrackInCmpGridPattern(
         }
     }
 
-    // Map to store the minimum distance and corresponding index position for each unique index
-    std::unordered_map<std::size_t, std::pair<double, std::size_t>> indexToMinDistance;
-
-    // First pass: Identify the minimum distance for each index
-    for (std::size_t i = 0; i < nearestPts.size(); ++i) {
-        if (nearestPts[i].has_value()) {
-            auto [index, distance] = nearestPts[i].value();
-            // Update if the index is new or the current distance is smaller
-            if (indexToMinDistance.find(index) == indexToMinDistance.end() ||
-                distance < indexToMinDistance[index].first) {
-                indexToMinDistance[index] = {distance, i};
-            }
+    // for each center of 'gridToTrack', the predicted center with the minimum distance to it
+    std::vector<int> closestPred(cenIndex.Size(), -1);
+    for (int i = 0; i < size; ++i) {
+        const auto& [index, distance] = nearestPts[i];
+        if (index < 0) {
+            continue;
         }
-    }
-
-    // Second pass: Set all non-minimum distance entries to std::nullopt
-    for (std::size_t i = 0; i < nearestPts.size(); ++i) {
-        if (nearestPts[i].has_value()) {
-            auto [index, distance] = nearestPts[i].value();
-            // Check if the current entry is not the one with the minimum distance
-            if (indexToMinDistance[index].second != i) {
-                nearestPts[i] = std::nullopt;  // Set to nullopt if not the closest
-            }
+        if (int& owner = closestPred[index]; owner < 0 || distance < nearestPts[owner].second) {
+            owner = i;
         }
     }
 
+    // only keep the predicted centers that are the closest ones
     std::vector<int> incmpGridPatternIdx(size, -1);
     for (int i = 0; i < size; i++) {
-        if (nearestPts[i].has_value()) {
-            incmpGridPatternIdx.at(i) = static_cast<int>(nearestPts.at(i)->first);
+        if (const int index = nearestPts[i].first; index >= 0 && closestPred[index] == i) {
+            incmpGridPatternIdx.at(i) = index;
         }
     }
 
@@ -35,6 +35,7 @@
 #include "opencv4/opencv2/imgproc.hpp"
 #include "opengv/sac/Ransac.hpp"
 #include "util/status.hpp"
+#include "numeric"
 
 #include <config/configor.h>
 #include <opencv2/highgui.hpp>
@@ -177,19 +178,45 @@ int EventNormFlow::NormFlowPack::Cols() const { return rawTimeSurfaceMap.cols; }
 EventNormFlow::EventNormFlow(const ActiveEventSurfacePtr &sea)
     : _sea(sea) {}
 
-EventNormFlow::NormFlowPack::Ptr EventNormFlow::ExtractNormFlows(double decaySec,
-                                                                 int winSize,
-                                                                 int neighborDist,
-                                                                 double goodRatioThd,
-                                                                 double timeDistEventToPlaneThd,
-                                                                 int ransacMaxIter) const {
-    // CV_64FC1
-    auto [rtsMat, pMat] = _sea->RawTimeSurface(true);
-    // CV_8UC1
-    auto tsImg = _sea->DecayTimeSurface(true, 0, decaySec);
+EventNormFlow::NormFlowPack::Ptr EventNormFlow::ExtractNormFlows(
+    double decaySec,
+    int winSize,
+    int neighborDist,
+    double goodRatioThd,
+    double timeDistEventToPlaneThd,
+    int ransacMaxIter,
+    const std::vector<cv::Rect> &rois) const {
     const double timeLast = _sea->GetTimeLatest();
-    cv::Mat mask;
-    cv::inRange(rtsMat, std::max(1E-3, timeLast - decaySec), timeLast, mask);
+    const double sinceTime = std::max(1E-3, timeLast - decaySec);
+    /**
+     * mask (CV_8UC1), raw time surface (CV_64FC1) and polarity map of pixels in the decay window,
+     * and the decayed surface (CV_8UC1), all rendered in a single pass
+     */
+    const auto &window = _sea->RenderWindow(sinceTime, decaySec, true);
+    const cv::Mat &rtsMat = window.rawTimeSurface, &pMat = window.polarityMap;
+    cv::Mat mask = window.mask, tsImg = window.decayImg;
+    // masked pixels in raster order
+    std::vector<int> activePixels = window.pixels;
+
+    if (!rois.empty()) {
+        // pixels out of the regions of interest are excluded from the mask
+        cv::Mat roiMask = cv::Mat::zeros(mask.size(), CV_8UC1);
+        for (const auto &roi : rois) {
+            roiMask(roi & cv::Rect(0, 0, mask.cols, mask.rows)).setTo(255);
+        }
+        mask = mask.clone();
+        mask.setTo(0, roiMask == 0);
+        auto outOfRoi = [&roiMask](int idx) { return roiMask.at<uchar>(idx) == 0; };
+        activePixels.erase(std::remove_if(activePixels.begin(), activePixels.end(), outOfRoi),
+                           activePixels.end());
+    }
+
+    int xMin = mask.cols, yMin = mask.rows, xMax = -1, yMax = -1;
+    for (int idx : activePixels) {
+        const int y = idx / mask.cols, x = idx % mask.cols;
+        xMin = std::min(xMin, x), xMax = std::max(xMax, x);
+        yMin = std::min(yMin, y), yMax = std::max(yMax, y);
+    }
 
     cv::cvtColor(tsImg, tsImg, cv::COLOR_GRAY2BGR);
     auto nfsImg = tsImg.clone();
@@ -204,65 +231,89 @@ EventNormFlow::NormFlowPack::Ptr EventNormFlow::ExtractNormFlows(double decaySec
     cv::Mat occupy = cv::Mat::zeros(rows, cols, CV_8UC1);
     std::map<NormFlow::Ptr, std::vector<std::tuple<int, int, double>>> nfsInliers;
 
+    /**
+     * moments of the masked surface, for closed-form plane pre-fit. The tables cover the bounding
+     * box of the mask expanded by the window size, i.e., all windows queried below
+     */
+    EventLocalPlaneIntegral::Ptr planeIntegral = nullptr;
+    if (xMax >= 0) {
+        const cv::Rect roi = cv::Rect(cv::Point(xMin - ws, yMin - ws),
+                                      cv::Point(xMax + ws + 1, yMax + ws + 1)) &
+                             cv::Rect(0, 0, cols, rows);
+        planeIntegral = EventLocalPlaneIntegral::Create(rtsMat, mask, roi, timeLast);
+    }
+
 #define OUTPUT_PLANE_FIT 0
 #if OUTPUT_PLANE_FIT
     std::list<std::pair<Eigen::Vector3d, std::list<std::tuple<double, double, double>>>> drawData;
 #endif
-    for (int y = subTravSize; y < mask.rows - subTravSize; y++) {
-        for (int x = subTravSize; x < mask.cols - subTravSize; x++) {
-            if (mask.at<uchar>(y /*row*/, x /*col*/) != 255) {
-                continue;
-            }
-            // for this window, obtain the values [x, y, timestamp]
-            std::vector<std::tuple<int, int, double>> inRangeData;
-            double timeCen = 0.0;
-            inRangeData.reserve(winSampleCount);
-            bool jumpCurPixel = false;
-            for (int dy = -subTravSize; dy <= subTravSize; ++dy) {
-                for (int dx = -subTravSize; dx <= subTravSize; ++dx) {
-                    int nx = x + dx;
-                    int ny = y + dy;
-
-                    // this pixel is in neighbor range
-                    if (std::abs(dx) <= neighborDist && std::abs(dy) <= neighborDist) {
-                        if (occupy.at<uchar>(ny /*row*/, nx /*col*/) == 255) {
-                            // this pixl has been occupied, thus the current pixel would not be
-                            // considered in norm flow estimation
-                            jumpCurPixel = true;
-                            break;
-                        }
-                    }
-
-                    // this pixel is not considered in the window
-                    if (std::abs(dx) > ws || std::abs(dy) > ws) {
-                        continue;
+    // same traversal order as a full raster scan, as the 'occupy' map depends on it
+    for (int idx : activePixels) {
+        const int y = idx / cols, x = idx % cols;
+        if (y < subTravSize || y >= rows - subTravSize || x < subTravSize ||
+            x >= cols - subTravSize) {
+            continue;
+        }
+        if (mask.at<uchar>(y /*row*/, x /*col*/) != 255) {
+            continue;
+        }
+        // for this window, obtain the values [x, y, timestamp]
+        std::vector<std::tuple<int, int, double>> inRangeData;
+        double timeCen = 0.0;
+        inRangeData.reserve(winSampleCount);
+        bool jumpCurPixel = false;
+        for (int dy = -subTravSize; dy <= subTravSize; ++dy) {
+            for (int dx = -subTravSize; dx <= subTravSize; ++dx) {
+                int nx = x + dx;
+                int ny = y + dy;
+
+                // this pixel is in neighbor range
+                if (std::abs(dx) <= neighborDist && std::abs(dy) <= neighborDist) {
+                    if (occupy.at<uchar>(ny /*row*/, nx /*col*/) == 255) {
+                        // this pixl has been occupied, thus the current pixel would not be
+                        // considered in norm flow estimation
+                        jumpCurPixel = true;
+                        break;
                     }
+                }
 
-                    // in window but not involved in norm flow estimation
-                    if (mask.at<uchar>(ny /*row*/, nx /*col*/) != 255) {
-                        continue;
-                    }
+                // this pixel is not considered in the window
+                if (std::abs(dx) > ws || std::abs(dy) > ws) {
+                    continue;
+                }
 
-                    double timestamp = rtsMat.at<double>(ny /*row*/, nx /*col*/);
-                    inRangeData.emplace_back(nx, ny, timestamp);
-                    if (nx == x && ny == y) {
-                        timeCen = timestamp;
-                    }
+                // in window but not involved in norm flow estimation
+                if (mask.at<uchar>(ny /*row*/, nx /*col*/) != 255) {
+                    continue;
                 }
-                if (jumpCurPixel) {
-                    break;
+
+                double timestamp = rtsMat.at<double>(ny /*row*/, nx /*col*/);
+                inRangeData.emplace_back(nx, ny, timestamp);
+                if (nx == x && ny == y) {
+                    timeCen = timestamp;
                 }
             }
-            // data in this window is sufficient
-            if (jumpCurPixel || static_cast<int>(inRangeData.size()) < winSampleCountThd) {
-                continue;
+            if (jumpCurPixel) {
+                break;
             }
-            /**
-             * drawing
-             */
-            nfSeedsImg.at<cv::Vec3b>(y, x) = cv::Vec3b(0, 0, 255);  // selected but not verified
-            occupy.at<uchar>(y /*row*/, x /*col*/) = 255;
-
+        }
+        // data in this window is sufficient
+        if (jumpCurPixel || static_cast<int>(inRangeData.size()) < winSampleCountThd) {
+            continue;
+        }
+        /**
+         * drawing
+         */
+        nfSeedsImg.at<cv::Vec3b>(y, x) = cv::Vec3b(0, 0, 255);  // selected but not verified
+        occupy.at<uchar>(y /*row*/, x /*col*/) = 255;
+
+        Eigen::Vector3d abc;
+        std::vector<int> inlierIndices;
+        if (planeIntegral->FitPlane(x, y, ws, timeDistEventToPlaneThd, abc)) {
+            // all events in this window are inliers of the closed-form plane, skip ransac
+            inlierIndices.resize(inRangeData.size());
+            std::iota(inlierIndices.begin(), inlierIndices.end(), 0);
+        } else {
             // try fit planes using ransac
             auto centeredInRangeData = Centralization(inRangeData);
             opengv::sac::Ransac<EventLocalPlaneSacProblem> ransac;
@@ -278,41 +329,42 @@ EventNormFlow::NormFlowPack::Ptr EventNormFlow::ExtractNormFlows(double decaySec
                 continue;
             }
             // success
-            Eigen::Vector3d abc;
             probPtr->optimizeModelCoefficients(ransac.inliers_, ransac.model_coefficients_, abc);
+            inlierIndices = ransac.inliers_;
+        }
 
-            // 'abd' is the params we are interested in
-            const double dtdx = -abc(0), dtdy = -abc(1);
-            Eigen::Vector2d nf = 1.0 / (dtdx * dtdx + dtdy * dtdy) * Eigen::Vector2d(dtdx, dtdy);
+        // 'abd' is the params we are interested in
+        const double dtdx = -abc(0), dtdy = -abc(1);
+        Eigen::Vector2d nf = 1.0 / (dtdx * dtdx + dtdy * dtdy) * Eigen::Vector2d(dtdx, dtdy);
 
-            if (nf.squaredNorm() > 4E3 * 4E3) {
-                // the fitted plane is orthogonal to the t-axis, todo: a better way?
-                continue;
-            }
+        if (nf.squaredNorm() > 4E3 * 4E3) {
+            // the fitted plane is orthogonal to the t-axis, todo: a better way?
+            continue;
+        }
 
-            // inliers of the norm flow
-            std::vector<std::tuple<int, int, double>> inlierData;
-            inlierData.reserve(ransac.inliers_.size());
-            for (int idx : ransac.inliers_) {
-                inlierData.emplace_back(inRangeData.at(idx));
-            }
-            auto newNormFlow = NormFlow::Create(timeCen, Eigen::Vector2i{x, y}, nf);
-            nfsInliers[newNormFlow] = inlierData;
+        // inliers of the norm flow
+        std::vector<std::tuple<int, int, double>> inlierData;
+        inlierData.reserve(inlierIndices.size());
+        for (int idx : inlierIndices) {
+            inlierData.emplace_back(inRangeData.at(idx));
+        }
+        auto newNormFlow = NormFlow::Create(timeCen, Eigen::Vector2i{x, y}, nf);
+        nfsInliers[newNormFlow] = inlierData;
 
-            /**
-             * drawing
-             */
-            nfSeedsImg.at<cv::Vec3b>(y, x) = cv::Vec3b(0, 255, 0);  // selected and verified
-            DrawLineOnCVMat(nfsImg, Eigen::Vector2d{x, y} + 0.01 * nf, {x, y});
+        /**
+         * drawing
+         */
+        nfSeedsImg.at<cv::Vec3b>(y, x) = cv::Vec3b(0, 255, 0);  // selected and verified
+        DrawLineOnCVMat(nfsImg, Eigen::Vector2d{x, y} + 0.01 * nf, {x, y});
 
 #if OUTPUT_PLANE_FIT
-            std::list<std::tuple<double, double, double>> centeredInliers;
-            for (int idx : ransac.inliers_) {
-                centeredInliers.push_back(centeredInRangeData.at(idx));
-            }
-            drawData.push_back({abc, centeredInliers});
-#endif
+        std::list<std::tuple<double, double, double>> centeredInliers;
+        const auto centeredData = Centralization(inRangeData);
+        for (int idx : inlierIndices) {
+            centeredInliers.push_back(centeredData.at(idx));
         }
+        drawData.push_back({abc, centeredInliers});
+#endif
     }
 #if OUTPUT_PLANE_FIT
     auto path = Configor::DataStream::DebugPath;
@@ -330,6 +382,13 @@ EventNormFlow::NormFlowPack::Ptr EventNormFlow::ExtractNormFlows(double decaySec
     pack->polarityMap = pMat;
     pack->rawTimeSurfaceMap = rtsMat;
     pack->timestamp = _sea->GetTimeLatest();
+    pack->sourceSerials.assign(rows * cols, -1);
+    for (const auto &[nf, inliers] : nfsInliers) {
+        for (const auto &[x, y, t] : inliers) {
+            const int idx = y * cols + x;
+            pack->sourceSerials[idx] = _sea->SourceSerialAt(idx);
+        }
+    }
     // for visualization
     pack->nfsImg = nfsImg;
     pack->nfSeedsImg = nfSeedsImg;
@@ -364,6 +423,113 @@ std::vector<std::tuple<double, double, double>> EventNormFlow::Centralization(
     return centeredInRangeData;
 }
 
+/**
+ * EventLocalPlaneIntegral
+ */
+EventLocalPlaneIntegral::EventLocalPlaneIntegral(const cv::Mat &rtsMat,
+                                                 const cv::Mat &mask,
+                                                 const cv::Rect &roi,
+                                                 double timeRef)
+    : _roi(roi),
+      _timeRef(timeRef),
+      _sat((roi.height + 1) * (roi.width + 1)) {
+    const int stride = _roi.width + 1;
+    // the first row and column are zeros
+    _sat.at(0).fill(0.0);
+    for (int c = 1; c < stride; ++c) {
+        _sat.at(c).fill(0.0);
+    }
+    for (int r = 0; r < _roi.height; ++r) {
+        const auto *maskRow = mask.ptr<uchar>(_roi.y + r) + _roi.x;
+        const auto *tsRow = rtsMat.ptr<double>(_roi.y + r) + _roi.x;
+        auto *cur = _sat.data() + (r + 1) * stride;
+        const auto *prev = _sat.data() + r * stride;
+        cur[0].fill(0.0);
+
+        // prefix sums in this row, accumulated on the table above
+        std::array<double, MOMENT_COUNT> rowSum{};
+        for (int c = 0; c < _roi.width; ++c) {
+            if (maskRow[c] == 255) {
+                const double x = c, y = r, t = tsRow[c] - _timeRef;
+                rowSum[N] += 1.0;
+                rowSum[X] += x;
+                rowSum[Y] += y;
+                rowSum[XX] += x * x;
+                rowSum[XY] += x * y;
+                rowSum[YY] += y * y;
+                rowSum[T] += t;
+                rowSum[XT] += x * t;
+                rowSum[YT] += y * t;
+                rowSum[TT] += t * t;
+            }
+            for (int m = 0; m < MOMENT_COUNT; ++m) {
+                cur[c + 1][m] = prev[c + 1][m] + rowSum[m];
+            }
+        }
+    }
+}
+
+EventLocalPlaneIntegral::Ptr EventLocalPlaneIntegral::Create(const cv::Mat &rtsMat,
+                                                             const cv::Mat &mask,
+                                                             const cv::Rect &roi,
+                                                             double timeRef) {
+    return std::make_shared<EventLocalPlaneIntegral>(rtsMat, mask, roi, timeRef);
+}
+
+std::array<double, EventLocalPlaneIntegral::MOMENT_COUNT> EventLocalPlaneIntegral::WindowSum(
+    int x0, int y0, int x1, int y1) const {
+    // window [x0, x1) x [y0, y1) in roi coordinates
+    const int stride = _roi.width + 1;
+    const auto &a = _sat.at(y0 * stride + x0), &b = _sat.at(y0 * stride + x1);
+    const auto &c = _sat.at(y1 * stride + x0), &d = _sat.at(y1 * stride + x1);
+    std::array<double, MOMENT_COUNT> sum{};
+    for (int m = 0; m < MOMENT_COUNT; ++m) {
+        sum[m] = d[m] - b[m] - c[m] + a[m];
+    }
+    return sum;
+}
+
+bool EventLocalPlaneIntegral::FitPlane(int x,
+                                       int y,
+                                       int ws,
+                                       double timeDistThd,
+                                       Eigen::Vector3d &abc) const {
+    // pixels out of the roi are not masked, thus the window is clipped to the roi
+    const int x0 = std::max(x - ws - _roi.x, 0), x1 = std::min(x + ws + 1 - _roi.x, _roi.width);
+    const int y0 = std::max(y - ws - _roi.y, 0), y1 = std::min(y + ws + 1 - _roi.y, _roi.height);
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+    const auto s = WindowSum(x0, y0, x1, y1);
+    const double n = s[N];
+    if (n < 3.0) {
+        return false;
+    }
+
+    // central moments
+    const double mx = s[X] / n, my = s[Y] / n, mt = s[T] / n;
+    const double sxx = s[XX] - n * mx * mx, sxy = s[XY] - n * mx * my, syy = s[YY] - n * my * my;
+    const double sxt = s[XT] - n * mx * mt, syt = s[YT] - n * my * mt, stt = s[TT] - n * mt * mt;
+
+    // the spatial distribution should be well-conditioned, i.e., not (nearly) collinear
+    const double det = sxx * syy - sxy * sxy;
+    if (det <= 1E-6 * sxx * syy || sxx <= 0.0 || syy <= 0.0) {
+        return false;
+    }
+
+    // least-squares plane 't = a * x + b * y + c' about the mean
+    const double a = (syy * sxt - sxy * syt) / det;
+    const double b = (sxx * syt - sxy * sxt) / det;
+    // sum of squared residuals, each squared residual is bounded by it
+    const double ssr = stt - a * sxt - b * syt;
+    if (ssr > timeDistThd * timeDistThd) {
+        return false;
+    }
+
+    abc = Eigen::Vector3d(-a, -b, 0.0);
+    return true;
+}
+
 /**
  * EventLocalPlaneSacProblem
  */
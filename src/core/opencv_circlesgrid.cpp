@@ -28,6 +28,7 @@
 
 // #include "precomp.hpp"
 #include "../../include/core/opencv_circlesgrid.h"
+#include "core/spatial_hash.h"
 #include <limits>
 #include "opencv2/calib3d.hpp"
 
@@ -108,34 +109,34 @@ size_t Graph::getDegree(size_t id) const {
     return it->second.neighbors.size();
 }
 
-void Graph::floydWarshall(cv::Mat &distanceMatrix, int infinity) const {
-    const int edgeWeight = 1;
-
+void Graph::allPairsShortestPaths(cv::Mat &distanceMatrix, int infinity, int maxDistance) const {
     const int n = (int)getVerticesCount();
     distanceMatrix.create(n, n, CV_32SC1);
     distanceMatrix.setTo(infinity);
-    for (Vertices::const_iterator it1 = vertices.begin(); it1 != vertices.end(); ++it1) {
-        distanceMatrix.at<int>((int)it1->first, (int)it1->first) = 0;
-        for (Neighbors::const_iterator it2 = it1->second.neighbors.begin();
-             it2 != it1->second.neighbors.end(); ++it2) {
-            CV_Assert(it1->first != *it2);
-            distanceMatrix.at<int>((int)it1->first, (int)*it2) = edgeWeight;
-        }
-    }
 
-    for (Vertices::const_iterator it1 = vertices.begin(); it1 != vertices.end(); ++it1) {
-        for (Vertices::const_iterator it2 = vertices.begin(); it2 != vertices.end(); ++it2) {
-            for (Vertices::const_iterator it3 = vertices.begin(); it3 != vertices.end(); ++it3) {
-                int i1 = (int)it1->first, i2 = (int)it2->first, i3 = (int)it3->first;
-                int val1 = distanceMatrix.at<int>(i2, i3);
-                int val2;
-                if (distanceMatrix.at<int>(i2, i1) == infinity ||
-                    distanceMatrix.at<int>(i1, i3) == infinity)
-                    val2 = val1;
-                else {
-                    val2 = distanceMatrix.at<int>(i2, i1) + distanceMatrix.at<int>(i1, i3);
-                }
-                distanceMatrix.at<int>(i2, i3) = (val1 == infinity) ? val2 : std::min(val1, val2);
+    // the graph is unweighted, thus a breadth-first search from each vertex gives the exact
+    // shortest distances, reusing one queue for all sources
+    std::vector<size_t> queue;
+    queue.reserve(n);
+    for (Vertices::const_iterator it = vertices.begin(); it != vertices.end(); ++it) {
+        const int src = (int)it->first;
+        int *row = distanceMatrix.ptr<int>(src);
+        row[src] = 0;
+        queue.clear();
+        queue.push_back(it->first);
+        for (size_t head = 0; head < queue.size(); head++) {
+            const size_t cur = queue[head];
+            const int dist = row[cur];
+            if (maxDistance >= 0 && dist >= maxDistance) {
+                // early out: vertices farther than the bound are left as 'infinity'
+                continue;
+            }
+            const Neighbors &neighbors = vertices.at(cur).neighbors;
+            for (Neighbors::const_iterator nIt = neighbors.begin(); nIt != neighbors.end(); ++nIt) {
+                CV_Assert(cur != *nIt);
+                if (row[*nIt] != infinity) continue;
+                row[*nIt] = dist + 1;
+                queue.push_back(*nIt);
             }
         }
     }
@@ -152,7 +153,7 @@ CirclesGridFinder::Segment::Segment(cv::Point2f _s, cv::Point2f _e)
       e(_e) {}
 
 void computeShortestPath(Mat &predecessorMatrix, int v1, int v2, std::vector<int> &path);
-void computePredecessorMatrix(const Mat &dm, int verticesCount, Mat &predecessorMatrix);
+void computePredecessorMatrix(const Mat &dm, const Graph &graph, Mat &predecessorMatrix);
 
 CirclesGridFinderParameters::CirclesGridFinderParameters() {
     minDensity = 10;
@@ -171,6 +172,8 @@ CirclesGridFinderParameters::CirclesGridFinderParameters() {
 
     minRNGEdgeSwitchDist = 5.f;
     gridType = SYMMETRIC_GRID;
+    candidatePruningFactor = 0.f;
+    pathLengthBoundFactor = 0.f;
 
     squareSize = 1.0f;
     maxRectifiedDistance = squareSize / 2.0f;
@@ -722,16 +725,24 @@ void CirclesGridFinder::computeRNG(Graph &rng,
     }
 }
 
-void computePredecessorMatrix(const Mat &dm, int verticesCount, Mat &predecessorMatrix) {
+// the predecessor of 'j' on a shortest path from 'i' is its first neighbor (in ascending order) one
+// step closer to 'i', thus only the neighbors of 'j' are checked instead of all vertices
+void computePredecessorMatrix(const Mat &dm, const Graph &graph, Mat &predecessorMatrix) {
     CV_Assert(dm.type() == CV_32SC1);
+    const int verticesCount = (int)graph.getVerticesCount();
     predecessorMatrix.create(verticesCount, verticesCount, CV_32SC1);
     predecessorMatrix = -1;
     for (int i = 0; i < predecessorMatrix.rows; i++) {
+        const int *dmRow = dm.ptr<int>(i);
+        int *predRow = predecessorMatrix.ptr<int>(i);
         for (int j = 0; j < predecessorMatrix.cols; j++) {
-            int dist = dm.at<int>(i, j);
-            for (int k = 0; k < verticesCount; k++) {
-                if (dm.at<int>(i, k) == dist - 1 && dm.at<int>(k, j) == 1) {
-                    predecessorMatrix.at<int>(i, j) = k;
+            const int dist = dmRow[j];
+            if (dist <= 0) continue;
+            const Graph::Neighbors &neighbors = graph.getNeighbors(j);
+            for (Graph::Neighbors::const_iterator it = neighbors.begin(); it != neighbors.end();
+                 ++it) {
+                if (dmRow[*it] == dist - 1) {
+                    predRow[j] = (int)*it;
                     break;
                 }
             }
@@ -758,12 +769,18 @@ size_t CirclesGridFinder::findLongestPath(std::vector<Graph> &basisGraphs, Path
 
     size_t bestGraphIdx = 0;
     const int infinity = -1;
+    // paths in basis graphs longer than the bound (relative to the grid extent) are not searched
+    const int maxDistance =
+        parameters.pathLengthBoundFactor > 0.f
+            ? cvCeil(parameters.pathLengthBoundFactor *
+                     (float)std::max(patternSize.width, patternSize.height))
+            : -1;
     for (size_t graphIdx = 0; graphIdx < basisGraphs.size(); graphIdx++) {
         const Graph &g = basisGraphs[graphIdx];
         Mat distanceMatrix;
-        g.floydWarshall(distanceMatrix, infinity);
+        g.allPairsShortestPaths(distanceMatrix, infinity, maxDistance);
         Mat predecessorMatrix;
-        computePredecessorMatrix(distanceMatrix, (int)g.getVerticesCount(), predecessorMatrix);
+        computePredecessorMatrix(distanceMatrix, g, predecessorMatrix);
 
         double maxVal;
         Point maxLoc;
@@ -1075,6 +1092,45 @@ size_t CirclesGridFinder::getFirstCorner(std::vector<Point> &largeCornerIndices,
     CV_Error(Error::StsNoConv, "isInsider array has the same values");
 }
 
+// drop isolated candidates, i.e., those whose nearest neighbor is much farther than the typical
+// neighbor spacing of all candidates, before any graph is built on them
+static void pruneCandidatesBySpacing(std::vector<cv::Point2f> &points, float factor) {
+    const size_t n = points.size();
+    if (factor <= 0.f || n < 3) return;
+
+    /**
+     * nearest neighbors are searched in a grid hash whose cells are sized to the mean spacing of
+     * candidates spread over their bounding box, the search radius is doubled until one is found,
+     * thus distances are identical to the ones of a brute-force search
+     */
+    const cv::Rect box = cv::boundingRect(points);
+    const double cellSize = std::max(1.0, std::sqrt((double)box.area() / (double)n));
+    const auto hash = ns_ekalibr::SpatialGridHash::Create(points, cellSize);
+    const double maxRadius = 2.0 * (std::hypot((double)box.width, (double)box.height) + cellSize);
+
+    std::vector<float> nearestDist(n, std::numeric_limits<float>::max());
+    for (size_t i = 0; i < n; i++) {
+        for (double radius = 2.0 * cellSize;
+             nearestDist[i] == std::numeric_limits<float>::max() && radius < maxRadius;
+             radius *= 2.0) {
+            for (int j : hash->Radius(points[i], radius)) {
+                if (j == (int)i) continue;
+                nearestDist[i] = std::min(nearestDist[i], (float)norm(points[i] - points[j]));
+            }
+        }
+    }
+    std::vector<float> sorted = nearestDist;
+    std::nth_element(sorted.begin(), sorted.begin() + n / 2, sorted.end());
+    const float distThd = factor * sorted[n / 2];
+
+    std::vector<cv::Point2f> kept;
+    kept.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (nearestDist[i] <= distThd) kept.push_back(points[i]);
+    }
+    points.swap(kept);
+}
+
 bool FindCirclesGrid(cv::InputArray _image,
                      cv::Size patternSize,
                      cv::OutputArray _centers,
@@ -1106,6 +1162,7 @@ bool FindCirclesGrid(cv::InputArray _image,
                        "(std::vector<Point2f>) with candidates");
         _image.copyTo(points);
     }
+    pruneCandidatesBySpacing(points, parameters.candidatePruningFactor);
 
     if (flags & cv::CALIB_CB_ASYMMETRIC_GRID)
         parameters.gridType = ns_cv_helper::CirclesGridFinderParameters::ASYMMETRIC_GRID;
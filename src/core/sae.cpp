@@ -29,42 +29,72 @@
 #include "core/sae.h"
 #include "sensor/event.h"
 #include "opencv4/opencv2/imgproc.hpp"
+#include "algorithm"
+#include "cstring"
+#include "functional"
 
 namespace ns_ekalibr {
-ActiveEventSurface::ActiveEventSurface(int w, int h, double filterThd)
+ActiveEventSurface::ActiveEventSurface(int w, int h, double filterThd, double activeRetention)
     : FILTER_THD(filterThd),
+      FILTER_THD_TICKS(std::llround(filterThd / TICK)),
       w(w),
       h(h),
-      _accEventImg(cv::Size(w, h), CV_8UC3, cv::Scalar(0, 0, 0)) {
-    _sae[0] = Eigen::MatrixXd::Zero(w, h);
-    _sae[1] = Eigen::MatrixXd::Zero(w, h);
-    _saeLatest[0] = Eigen::MatrixXd::Zero(w, h);
-    _saeLatest[1] = Eigen::MatrixXd::Zero(w, h);
-    _timeLatest = 0.0;
+      _timeBase(0.0),
+      _hasTimeBase(false),
+      _timeLatest(0.0),
+      _tickLatest(NO_STAMP),
+      _eventSerial(0),
+      _activeRetention(activeRetention),
+      _isActive(w * h, false),
+      _activeInRow(h, 0),
+      _activeSizeAfterCompact(0),
+      _accEventImg(cv::Size(w, h), CV_8UC3, cv::Scalar(0, 0, 0)),
+      _runMark(w * h, 0),
+      _runSerial(0) {
+    for (int i = 0; i < 2; ++i) {
+        _sae[i] = cv::Mat(h, w, CV_32SC1, cv::Scalar(NO_STAMP));
+        _saeLatest[i] = cv::Mat(h, w, CV_32SC1, cv::Scalar(NO_STAMP));
+        _saeSource[i].assign(w * h, -1);
+    }
 }
 
-ActiveEventSurface::Ptr ActiveEventSurface::Create(int w, int h, double filterThd) {
-    return std::make_shared<ActiveEventSurface>(w, h, filterThd);
+ActiveEventSurface::Ptr ActiveEventSurface::Create(int w,
+                                                   int h,
+                                                   double filterThd,
+                                                   double activeRetention) {
+    return std::make_shared<ActiveEventSurface>(w, h, filterThd, activeRetention);
 }
 
 void ActiveEventSurface::GrabEvent(const Event::Ptr &event, bool drawEventMat) {
     const bool ep = event->GetPolarity();
     const std::uint16_t ex = event->GetPos()(0), ey = event->GetPos()(1);
-    const double et = event->GetTimestamp();
+    const std::int32_t et = TimeToTick(event->GetTimestamp());
+    const int idx = ey * w + ex;
 
     // update Surface of Active Events
     const int pol = ep ? 1 : 0;
     const int polInv = !ep ? 1 : 0;
-    double &tLast = _saeLatest[pol](ex, ey);
-    double &tLastInv = _saeLatest[polInv](ex, ey);
+    std::int32_t &tLast = _saeLatest[pol].ptr<std::int32_t>()[idx];
+    const std::int32_t tLastInv = _saeLatest[polInv].ptr<std::int32_t>()[idx];
 
-    if ((et > tLast + FILTER_THD) || (tLastInv > tLast)) {
+    if ((et > tLast + FILTER_THD_TICKS) || (tLastInv > tLast)) {
         tLast = et;
-        _sae[pol](ex, ey) = et;
+        _sae[pol].ptr<std::int32_t>()[idx] = et;
+        _saeSource[pol][idx] = _eventSerial;
+
+        MarkActive(idx);
     } else {
         tLast = et;
     }
-    _timeLatest = et;
+    ++_eventSerial;
+    _tickLatest = et;
+    _timeLatest = TickToTime(et);
+
+    // amortized compaction, only worthwhile when stale pixels can be dropped at all
+    if (_activeRetention < std::numeric_limits<double>::max() &&
+        _activePixels.size() > 2 * _activeSizeAfterCompact + 1024) {
+        CompactActivePixels();
+    }
 
     if (drawEventMat) {
         // draw image
@@ -74,8 +104,117 @@ void ActiveEventSurface::GrabEvent(const Event::Ptr &event, bool drawEventMat) {
 }
 
 void ActiveEventSurface::GrabEvent(const EventArray::Ptr &events, bool drawAccumulatedEventMat) {
-    for (const auto &event : events->GetEvents()) {
-        GrabEvent(event, drawAccumulatedEventMat);
+    GrabEvents(events->GetEvents(), 0, std::numeric_limits<double>::max(),
+               drawAccumulatedEventMat);
+}
+
+std::size_t ActiveEventSurface::GrabEvents(const std::vector<Event::Ptr> &events,
+                                           std::size_t begin,
+                                           double timeEnd,
+                                           bool drawEventMat) {
+    std::size_t cur = begin;
+    bool reachEnd = false;
+    while (cur < events.size() && !reachEnd) {
+        if (++_runSerial == 0) {
+            // the serial wraps around, reset marks
+            std::fill(_runMark.begin(), _runMark.end(), 0);
+            _runSerial = 1;
+        }
+        _runs[0].Clear(), _runs[1].Clear();
+
+        /**
+         * decode a run of events, split by polarity. A run ends at the window boundary, the run
+         * capacity, a pixel already in the run, or an event requiring rebasing the time ticks
+         */
+        std::int32_t tickLatest = _tickLatest;
+        for (int runSize = 0; cur < events.size() && runSize < RUN_CAPACITY; ++runSize) {
+            const auto &event = events[cur];
+            const auto pos = event->GetPos();
+            const int idx = pos(1) * w + pos(0);
+            if (_runMark[idx] == _runSerial) {
+                break;
+            }
+            const double et = event->GetTimestamp();
+            if (runSize > 0 && std::llround((et - _timeBase) / TICK) > TICK_RANGE) {
+                break;
+            }
+            _runMark[idx] = _runSerial;
+            tickLatest = TimeToTick(et);
+            _runs[event->GetPolarity() ? 1 : 0].Push(idx, tickLatest, _eventSerial++);
+            ++cur;
+
+            if (et >= timeEnd) {
+                reachEnd = true;
+                break;
+            }
+        }
+
+        IngestRuns(drawEventMat);
+        _tickLatest = tickLatest;
+        _timeLatest = TickToTime(tickLatest);
+
+        // amortized compaction, only worthwhile when stale pixels can be dropped at all
+        if (_activeRetention < std::numeric_limits<double>::max() &&
+            _activePixels.size() > 2 * _activeSizeAfterCompact + 1024) {
+            CompactActivePixels();
+        }
+    }
+    return cur;
+}
+
+void ActiveEventSurface::IngestRuns(bool drawEventMat) {
+    /**
+     * pixels are distinct in the runs of both polarities, so the order of events in a run does
+     * not matter and the steps below are free of cross-event dependencies
+     */
+    const auto filterTicks =
+        static_cast<std::int32_t>(std::min<std::int64_t>(FILTER_THD_TICKS, TICK_RANGE - 1));
+
+    for (int pol = 0; pol < 2; ++pol) {
+        auto &run = _runs[pol];
+        const int n = static_cast<int>(run.idx.size());
+        auto *latest = _saeLatest[pol].ptr<std::int32_t>();
+        auto *latestInv = _saeLatest[1 - pol].ptr<std::int32_t>();
+        auto *sae = _sae[pol].ptr<std::int32_t>();
+        auto *source = _saeSource[pol].data();
+
+        for (int i = 0; i < n; ++i) {
+            __builtin_prefetch(latest + run.idx[i], 1);
+            __builtin_prefetch(latestInv + run.idx[i], 0);
+            __builtin_prefetch(sae + run.idx[i], 1);
+        }
+
+        run.tLast.resize(n), run.tLastInv.resize(n), run.keep.resize(n);
+        for (int i = 0; i < n; ++i) {
+            run.tLast[i] = latest[run.idx[i]];
+            run.tLastInv[i] = latestInv[run.idx[i]];
+        }
+
+        // the time filter, see 'GrabEvent'
+        const std::int32_t *tick = run.tick.data(), *tLast = run.tLast.data(),
+                           *tLastInv = run.tLastInv.data();
+        uchar *keep = run.keep.data();
+        for (int i = 0; i < n; ++i) {
+            keep[i] = (tick[i] > tLast[i] + filterTicks) | (tLastInv[i] > tLast[i]);
+        }
+
+        for (int i = 0; i < n; ++i) {
+            const int idx = run.idx[i];
+            latest[idx] = tick[i];
+            if (keep[i]) {
+                sae[idx] = tick[i];
+                source[idx] = run.serial[i];
+                MarkActive(idx);
+            }
+        }
+
+        if (drawEventMat) {
+            const auto color = pol ? cv::Vec3b(255, 0, 0) : cv::Vec3b(0, 0, 255);
+            auto *img = _accEventImg.ptr<cv::Vec3b>();
+            for (int i = 0; i < n; ++i) {
+                img[run.idx[i]] = color;
+            }
+        }
     }
 }
 
@@ -88,60 +227,407 @@ cv::Mat ActiveEventSurface::GetAccumulatedEventImg(bool resetMat) {
 }
 
 cv::Mat ActiveEventSurface::DecayTimeSurface(bool ignorePolarity,
-                                        int medianBlurKernelSize,
-                                        double decaySec) {
+                                             int medianBlurKernelSize,
+                                             double decaySec) {
+    cv::Mat timeSurfaceMap;
+    DecayTimeSurface(timeSurfaceMap, ignorePolarity, medianBlurKernelSize, decaySec);
+    return timeSurfaceMap;
+}
+
+void ActiveEventSurface::DecayTimeSurface(cv::Mat &timeSurfaceMap,
+                                          bool ignorePolarity,
+                                          int medianBlurKernelSize,
+                                          double decaySec) {
     // create exponential-decayed Time Surface map
-    const auto imgSize = cv::Size(w, h);
-    cv::Mat timeSurfaceMap = cv::Mat::zeros(imgSize, CV_64F);
+    timeSurfaceMap.create(h, w, CV_8UC1);
+    const auto tickToX = static_cast<float>(TICK / decaySec);
+    const std::int32_t tickLatest = _tickLatest == NO_STAMP ? 0 : _tickLatest;
 
-    for (int y = 0; y < imgSize.height; ++y) {
-        for (int x = 0; x < imgSize.width; ++x) {
-            const double mostRecentStampAtCoord = std::max(_sae[1](x, y), _sae[0](x, y));
+    if (ignorePolarity && ActivePixelsCover(_timeLatest - DecayTimeSurfaceCutoff(decaySec))) {
+        /**
+         * pixels out of the active set are older than the cutoff and would be rounded to zero,
+         * thus only active ones are evaluated: gathered, rendered in a contiguous run, scattered
+         */
+        timeSurfaceMap.setTo(0);
+        const int n = static_cast<int>(_activePixels.size());
+        _gatherBuf.resize(n);
+        _decayBuf.resize(n);
+        for (int i = 0; i < n; ++i) {
+            _gatherBuf[i] = MostRecentTickAt(_activePixels[i]);
+        }
+        DecayTicksTo8U(_gatherBuf.data(), _gatherBuf.data(), true, tickLatest, tickToX,
+                       _decayBuf.data(), n);
+        auto *out = timeSurfaceMap.ptr<uchar>();
+        for (int i = 0; i < n; ++i) {
+            out[_activePixels[i]] = _decayBuf[i];
+        }
+    } else {
+        for (int y = 0; y < h; ++y) {
+            DecayTicksTo8U(_sae[0].ptr<std::int32_t>(y), _sae[1].ptr<std::int32_t>(y),
+                           ignorePolarity, tickLatest, tickToX, timeSurfaceMap.ptr<uchar>(y), w);
+        }
+    }
 
-            const double dt = _timeLatest - mostRecentStampAtCoord;
-            double expVal = std::exp(-dt / decaySec);
+    if (medianBlurKernelSize > 0) {
+        cv::medianBlur(timeSurfaceMap, timeSurfaceMap, 2 * medianBlurKernelSize + 1);
+    }
+}
+
+std::pair<cv::Mat, cv::Mat> ActiveEventSurface::RawTimeSurface(bool ignorePolarity,
+                                                               double sinceTime) {
+    cv::Mat timeSurfaceMap, polarityMap;
+    RawTimeSurface(timeSurfaceMap, polarityMap, ignorePolarity, sinceTime);
+    return {timeSurfaceMap, polarityMap};
+}
+
+void ActiveEventSurface::RawTimeSurface(cv::Mat &timeSurfaceMap,
+                                        cv::Mat &polarityMap,
+                                        bool ignorePolarity,
+                                        double sinceTime) {
+    timeSurfaceMap.create(h, w, CV_64FC1);
+    timeSurfaceMap.setTo(0.0);
+    polarityMap.create(h, w, CV_8UC1);
+    polarityMap.setTo(0);
 
-            if (!ignorePolarity) {
-                double polarity = _sae[1](x, y) > _sae[0](x, y) ? 1.0 : -1.0;
-                expVal *= polarity;
+    const auto *sae0 = _sae[0].ptr<std::int32_t>(), *sae1 = _sae[1].ptr<std::int32_t>();
+    auto *tsOut = timeSurfaceMap.ptr<double>();
+    auto *pOut = polarityMap.ptr<uchar>();
+
+    auto fill = [&](int idx) {
+        double mostRecentStampAtCoord = MostRecentStampAt(idx);
+        if (mostRecentStampAtCoord < sinceTime) {
+            return;
+        }
+        double polarity = sae1[idx] > sae0[idx] ? 1.0 : -1.0;
+        pOut[idx] = polarity;
+        if (!ignorePolarity) {
+            mostRecentStampAtCoord *= polarity;
+        }
+        tsOut[idx] = mostRecentStampAtCoord;
+    };
+
+    if (ActivePixelsCover(sinceTime)) {
+        for (int idx : _activePixels) {
+            fill(idx);
+        }
+    } else {
+        for (int idx = 0; idx < w * h; ++idx) {
+            fill(idx);
+        }
+    }
+}
+
+const ActiveEventSurface::WindowSurface &ActiveEventSurface::RenderWindow(double sinceTime,
+                                                                         double decaySec,
+                                                                         bool renderDecay) {
+    auto &win = _window;
+    win.mask.create(h, w, CV_8UC1);
+    win.rawTimeSurface = cv::Mat(h, w, CV_64FC1);
+    win.polarityMap = cv::Mat(h, w, CV_8UC1);
+    if (renderDecay) {
+        win.decayImg.create(h, w, CV_8UC1);
+    }
+    _rowPixels.resize(h);
+
+    // rows without active pixels are out of the window, and fully decayed if the cutoff is covered
+    const bool skipForWin = ActivePixelsCover(sinceTime);
+    const bool skipForDecay = ActivePixelsCover(_timeLatest - DecayTimeSurfaceCutoff(decaySec));
+    const auto tickToX = static_cast<float>(TICK / decaySec);
+    const std::int32_t tickLatest = _tickLatest == NO_STAMP ? 0 : _tickLatest;
+
+#pragma omp parallel for
+    for (int y = 0; y < h; ++y) {
+        auto *mask = win.mask.ptr<uchar>(y);
+        auto *ts = win.rawTimeSurface.ptr<double>(y);
+        auto *pol = win.polarityMap.ptr<uchar>(y);
+        auto &rowPixels = _rowPixels[y];
+        rowPixels.clear();
+
+        const bool rowInactive = _activeInRow[y] == 0;
+        if (rowInactive && skipForWin) {
+            std::fill(mask, mask + w, 0);
+            std::fill(ts, ts + w, 0.0);
+            std::fill(pol, pol + w, 0);
+        } else {
+            const auto *sae0 = _sae[0].ptr<std::int32_t>(y), *sae1 = _sae[1].ptr<std::int32_t>(y);
+            for (int x = 0; x < w; ++x) {
+                const double stamp = TickToTime(std::max(sae0[x], sae1[x]));
+                if (stamp >= sinceTime && stamp <= _timeLatest) {
+                    double polarity = sae1[x] > sae0[x] ? 1.0 : -1.0;
+                    mask[x] = 255, ts[x] = stamp, pol[x] = polarity;
+                    rowPixels.push_back(y * w + x);
+                } else {
+                    mask[x] = 0, ts[x] = 0.0, pol[x] = 0;
+                }
             }
-            timeSurfaceMap.at<double>(y, x) = expVal;
+        }
+
+        if (!renderDecay) {
+            continue;
+        }
+        auto *decay = win.decayImg.ptr<uchar>(y);
+        if (rowInactive && skipForDecay) {
+            std::fill(decay, decay + w, 0);
+        } else {
+            // the tick rows are still in cache
+            DecayTicksTo8U(_sae[0].ptr<std::int32_t>(y), _sae[1].ptr<std::int32_t>(y), true,
+                           tickLatest, tickToX, decay, w);
         }
     }
 
-    if (!ignorePolarity) {
-        timeSurfaceMap = 255.0 * (timeSurfaceMap + 1.0) / 2.0;
-    } else {
-        timeSurfaceMap = 255.0 * timeSurfaceMap;
+    win.pixels.clear();
+    for (const auto &rowPixels : _rowPixels) {
+        win.pixels.insert(win.pixels.end(), rowPixels.begin(), rowPixels.end());
     }
-    timeSurfaceMap.convertTo(timeSurfaceMap, CV_8U);
+    return win;
+}
 
-    if (medianBlurKernelSize > 0) {
-        cv::medianBlur(timeSurfaceMap, timeSurfaceMap, 2 * medianBlurKernelSize + 1);
+ActiveEventSurface::Ptr ActiveEventSurface::Downsample(int factor) const {
+    const int cw = (w + factor - 1) / factor, ch = (h + factor - 1) / factor;
+    auto coarse = Create(cw, ch, FILTER_THD, _activeRetention);
+    coarse->_timeBase = _timeBase;
+    coarse->_hasTimeBase = _hasTimeBase;
+    coarse->_timeLatest = _timeLatest;
+    coarse->_tickLatest = _tickLatest;
+
+    for (int idx : _activePixels) {
+        const int cIdx = (idx / w) / factor * cw + (idx % w) / factor;
+        for (int pol = 0; pol < 2; ++pol) {
+            auto &cSae = coarse->_sae[pol].ptr<std::int32_t>()[cIdx];
+            auto &cLatest = coarse->_saeLatest[pol].ptr<std::int32_t>()[cIdx];
+            cSae = std::max(cSae, _sae[pol].ptr<std::int32_t>()[idx]);
+            cLatest = std::max(cLatest, _saeLatest[pol].ptr<std::int32_t>()[idx]);
+        }
+        coarse->MarkActive(cIdx);
     }
+    coarse->_activeSizeAfterCompact = coarse->_activePixels.size();
+    return coarse;
+}
 
-    return timeSurfaceMap;
+std::vector<ActiveEventSurface::Ptr> ActiveEventSurface::Pyramid(int levels) const {
+    std::vector<Ptr> pyramid;
+    pyramid.reserve(levels);
+    for (int i = 0; i < levels; ++i) {
+        pyramid.push_back(i == 0 ? Downsample(2) : pyramid.back()->Downsample(2));
+    }
+    return pyramid;
 }
 
-std::pair<cv::Mat, cv::Mat> ActiveEventSurface::RawTimeSurface(bool ignorePolarity) {
-    // create exponential-decayed Time Surface map
-    const auto imgSize = cv::Size(w, h);
-    cv::Mat timeSurfaceMap = cv::Mat::zeros(imgSize, CV_64FC1);
-    cv::Mat polarityMap = cv::Mat::zeros(imgSize, CV_8UC1);
-
-    for (int y = 0; y < imgSize.height; ++y) {
-        for (int x = 0; x < imgSize.width; ++x) {
-            double mostRecentStampAtCoord = std::max(_sae[1](x, y), _sae[0](x, y));
-            double polarity = _sae[1](x, y) > _sae[0](x, y) ? 1.0 : -1.0;
-            polarityMap.at<uchar>(y, x) = polarity;
-            if (!ignorePolarity) {
-                mostRecentStampAtCoord *= polarity;
+std::vector<int> ActiveEventSurface::ActivePixels(double sinceTime) const {
+    std::vector<int> pixels;
+    if (ActivePixelsCover(sinceTime)) {
+        pixels.reserve(_activePixels.size());
+        for (int idx : _activePixels) {
+            if (MostRecentStampAt(idx) >= sinceTime) {
+                pixels.push_back(idx);
+            }
+        }
+        std::sort(pixels.begin(), pixels.end());
+    } else {
+        // already in raster order
+        for (int idx = 0; idx < w * h; ++idx) {
+            if (MostRecentStampAt(idx) >= sinceTime) {
+                pixels.push_back(idx);
             }
-            timeSurfaceMap.at<double>(y, x) = mostRecentStampAtCoord;
         }
     }
-    return {timeSurfaceMap, polarityMap};
+    return pixels;
+}
+
+double ActiveEventSurface::SpanOfRecentPixels(std::size_t count,
+                                              double minSpan,
+                                              double maxSpan) const {
+    if (count == 0 || _tickLatest == NO_STAMP) {
+        return maxSpan;
+    }
+    const double sinceTime = _timeLatest - maxSpan;
+    std::vector<std::int32_t> ticks;
+    auto collect = [this, &ticks, &sinceTime](int idx) {
+        const std::int32_t tick = MostRecentTickAt(idx);
+        if (tick != NO_STAMP && TickToTime(tick) >= sinceTime) {
+            ticks.push_back(tick);
+        }
+    };
+    if (ActivePixelsCover(sinceTime)) {
+        ticks.reserve(_activePixels.size());
+        for (int idx : _activePixels) {
+            collect(idx);
+        }
+    } else {
+        for (int idx = 0; idx < w * h; ++idx) {
+            collect(idx);
+        }
+    }
+    if (ticks.size() < count) {
+        return maxSpan;
+    }
+    // the 'count'-th most recent tick
+    std::nth_element(ticks.begin(), ticks.begin() + static_cast<long>(count - 1), ticks.end(),
+                     std::greater<>());
+    const double span = _timeLatest - TickToTime(ticks[count - 1]);
+    return std::clamp(span, minSpan, maxSpan);
+}
+
+std::int64_t ActiveEventSurface::SourceSerialAt(int idx) const {
+    // the same tie-breaking as the polarity of the most recent stamp
+    return _sae[1].ptr<std::int32_t>()[idx] > _sae[0].ptr<std::int32_t>()[idx]
+               ? _saeSource[1][idx]
+               : _saeSource[0][idx];
 }
 
 double ActiveEventSurface::GetTimeLatest() const { return _timeLatest; }
-}  // namespace ns_ekalibr
\ No newline at end of file
+
+cv::Size ActiveEventSurface::GetSize() const { return {w, h}; }
+
+double ActiveEventSurface::DecayTimeSurfaceCutoff(double decaySec) {
+    // 255 * exp(-dt / decaySec) <= 0.5
+    return decaySec * std::log(510.0);
+}
+
+double ActiveEventSurface::MostRecentStampAt(int idx) const {
+    return TickToTime(MostRecentTickAt(idx));
+}
+
+std::int32_t ActiveEventSurface::MostRecentTickAt(int idx) const {
+    return std::max(_sae[1].ptr<std::int32_t>()[idx], _sae[0].ptr<std::int32_t>()[idx]);
+}
+
+double ActiveEventSurface::TickToTime(std::int32_t tick) const {
+    // never-updated cells are treated as zero stamps
+    return tick == NO_STAMP ? 0.0 : _timeBase + tick * TICK;
+}
+
+std::int32_t ActiveEventSurface::TimeToTick(double time) {
+    if (!_hasTimeBase) {
+        _timeBase = time;
+        _hasTimeBase = true;
+    }
+    std::int64_t tick = std::llround((time - _timeBase) / TICK);
+    if (tick > TICK_RANGE) {
+        Rebase(time);
+        tick = std::llround((time - _timeBase) / TICK);
+    }
+    // events far earlier than the time base are clamped, they are too old to be rendered anyway
+    return static_cast<std::int32_t>(std::max<std::int64_t>(tick, -TICK_RANGE));
+}
+
+void ActiveEventSurface::Rebase(double timeBase) {
+    // shift by whole ticks, so that stamps keep on the same tick grid
+    const std::int64_t shift = std::llround((timeBase - _timeBase) / TICK);
+    for (cv::Mat *surface : {&_sae[0], &_sae[1], &_saeLatest[0], &_saeLatest[1]}) {
+        auto *ticks = surface->ptr<std::int32_t>();
+        for (int idx = 0; idx < w * h; ++idx) {
+            if (ticks[idx] != NO_STAMP) {
+                ticks[idx] = static_cast<std::int32_t>(
+                    std::max<std::int64_t>(ticks[idx] - shift, -TICK_RANGE));
+            }
+        }
+    }
+    if (_tickLatest != NO_STAMP) {
+        _tickLatest = static_cast<std::int32_t>(
+            std::max<std::int64_t>(_tickLatest - shift, -TICK_RANGE));
+    }
+    _timeBase += static_cast<double>(shift) * TICK;
+}
+
+bool ActiveEventSurface::ActivePixelsCover(double sinceTime) const {
+    /**
+     * pixels dropped from the active set are older than the retention horizon. Never-updated
+     * pixels hold zero stamps, so a non-positive 'sinceTime' always involves the whole frame
+     */
+    return sinceTime > 0.0 && sinceTime >= _timeLatest - _activeRetention;
+}
+
+void ActiveEventSurface::CompactActivePixels() {
+    const double sinceTime = _timeLatest - _activeRetention;
+    std::size_t count = 0;
+    for (int idx : _activePixels) {
+        if (MostRecentStampAt(idx) >= sinceTime) {
+            _activePixels[count++] = idx;
+        } else {
+            _isActive[idx] = false;
+            --_activeInRow[idx / w];
+        }
+    }
+    _activePixels.resize(count);
+    _activeSizeAfterCompact = count;
+}
+
+void ActiveEventSurface::MarkActive(int idx) {
+    if (!_isActive[idx]) {
+        _isActive[idx] = true;
+        _activePixels.push_back(idx);
+        ++_activeInRow[idx / w];
+    }
+}
+
+void ActiveEventSurface::EventRun::Clear() {
+    idx.clear();
+    tick.clear();
+    serial.clear();
+}
+
+void ActiveEventSurface::EventRun::Push(int pixelIdx,
+                                        std::int32_t eventTick,
+                                        std::int64_t eventSerial) {
+    idx.push_back(pixelIdx);
+    tick.push_back(eventTick);
+    serial.push_back(eventSerial);
+}
+
+float ActiveEventSurface::ExpNegApprox(float x) {
+    const float y = -x * 1.44269504f;
+    // round to the nearest integer ('y' is non-positive), the fraction lies in [-0.5, 0.5]
+    const std::int32_t n = static_cast<std::int32_t>(y - 0.5f);
+    const float f = y - static_cast<float>(n);
+    // polynomial approximation of 2^f on [-0.5, 0.5]
+    float p = 1.535336188e-4f;
+    p = p * f + 1.339887440e-3f;
+    p = p * f + 9.618437357e-3f;
+    p = p * f + 5.550332471e-2f;
+    p = p * f + 2.402264791e-1f;
+    p = p * f + 6.931472028e-1f;
+    p = p * f + 1.0f;
+    // 2^n, assembled from the exponent bits
+    const std::int32_t bits = (n + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(float));
+    return p * scale;
+}
+
+void ActiveEventSurface::DecayTicksTo8U(const std::int32_t *ticks0,
+                                        const std::int32_t *ticks1,
+                                        bool ignorePolarity,
+                                        std::int32_t tickLatest,
+                                        float tickToX,
+                                        uchar *out,
+                                        int n) {
+    /**
+     * ages are clamped in the integer domain, so that 'ExpNegApprox' stays in its valid range and
+     * no float comparison breaks the vectorization
+     */
+    const auto maxAge =
+        static_cast<std::int32_t>(std::min(87.0 / static_cast<double>(tickToX), 1.0 * TICK_RANGE));
+    const std::int32_t tickFloor = tickLatest - maxAge;
+
+    if (ignorePolarity) {
+        for (int i = 0; i < n; ++i) {
+            std::int32_t tick = ticks0[i] > ticks1[i] ? ticks0[i] : ticks1[i];
+            tick = tick > tickFloor ? tick : tickFloor;
+            tick = tick < tickLatest ? tick : tickLatest;
+            const float expVal = ExpNegApprox(static_cast<float>(tickLatest - tick) * tickToX);
+            out[i] = static_cast<uchar>(static_cast<std::int32_t>(255.0f * expVal + 0.5f));
+        }
+    } else {
+        for (int i = 0; i < n; ++i) {
+            const bool positive = ticks1[i] > ticks0[i];
+            std::int32_t tick = positive ? ticks1[i] : ticks0[i];
+            tick = tick > tickFloor ? tick : tickFloor;
+            tick = tick < tickLatest ? tick : tickLatest;
+            float expVal = ExpNegApprox(static_cast<float>(tickLatest - tick) * tickToX);
+            expVal = positive ? expVal : -expVal;
+            out[i] = static_cast<uchar>(static_cast<std::int32_t>(127.5f * (expVal + 1.0f) + 0.5f));
+        }
+    }
+}
+}  // namespace ns_ekalibr
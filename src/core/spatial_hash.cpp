@@ -0,0 +1,130 @@
+// eKalibr, Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/eKalibr.git
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+// Purpose: See .h/.hpp file.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "core/spatial_hash.h"
+#include "algorithm"
+#include "numeric"
+
+namespace ns_ekalibr {
+SpatialGridHash::SpatialGridHash(const std::vector<cv::Point2f>& points, double cellSize)
+    : _cellSize(std::max(cellSize, 1E-3)),
+      _cellSizeInv(1.0 / _cellSize),
+      _points(points) {
+    const int size = static_cast<int>(_points.size());
+    std::vector<std::int64_t> keys(size);
+    for (int i = 0; i < size; ++i) {
+        const auto [cx, cy] = CellCoord(_points[i]);
+        keys[i] = CellKey(cx, cy);
+    }
+    // counting-sort like layout: indices of the same cell are stored contiguously
+    _indices.resize(size);
+    std::iota(_indices.begin(), _indices.end(), 0);
+    std::stable_sort(_indices.begin(), _indices.end(),
+                     [&keys](int i, int j) { return keys[i] < keys[j]; });
+    _cells.reserve(size);
+    for (int i = 0; i < size;) {
+        int j = i + 1;
+        while (j < size && keys[_indices[j]] == keys[_indices[i]]) {
+            ++j;
+        }
+        _cells[keys[_indices[i]]] = {i, j};
+        i = j;
+    }
+}
+
+SpatialGridHash::Ptr SpatialGridHash::Create(const std::vector<cv::Point2f>& points,
+                                             double cellSize) {
+    return std::make_shared<SpatialGridHash>(points, cellSize);
+}
+
+std::optional<std::pair<int, double>> SpatialGridHash::Nearest(const cv::Point2f& p,
+                                                               double maxDist) const {
+    int bestIdx = -1;
+    double bestDist2 = maxDist * maxDist;
+    ForEachInRange(p, maxDist, [&](int idx) {
+        const cv::Point2f d = _points[idx] - p;
+        const double dist2 = d.x * d.x + d.y * d.y;
+        // ties are broken by the smaller index to keep the query deterministic
+        if (dist2 < bestDist2 || (dist2 == bestDist2 && bestIdx >= 0 && idx < bestIdx)) {
+            bestIdx = idx;
+            bestDist2 = dist2;
+        }
+    });
+    if (bestIdx < 0) {
+        return std::nullopt;
+    }
+    return std::make_pair(bestIdx, std::sqrt(bestDist2));
+}
+
+std::vector<int> SpatialGridHash::Radius(const cv::Point2f& p, double radius) const {
+    std::vector<int> indices;
+    const double radius2 = radius * radius;
+    ForEachInRange(p, radius, [&](int idx) {
+        const cv::Point2f d = _points[idx] - p;
+        if (d.x * d.x + d.y * d.y < radius2) {
+            indices.push_back(idx);
+        }
+    });
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+std::vector<int> SpatialGridHash::MutualNearestMatch(const SpatialGridHash& src,
+                                                     const SpatialGridHash& dst,
+                                                     double gate) {
+    std::vector<int> matches(src.Size(), -1);
+    for (int i = 0; i < static_cast<int>(src.Size()); ++i) {
+        auto forward = dst.Nearest(src._points[i], gate);
+        if (forward == std::nullopt) {
+            continue;
+        }
+        // consistency check: the nearest point of the matched one should be the current one
+        auto backward = src.Nearest(dst._points[forward->first], gate);
+        if (backward == std::nullopt || backward->first != i) {
+            continue;
+        }
+        matches[i] = forward->first;
+    }
+    return matches;
+}
+
+const std::vector<cv::Point2f>& SpatialGridHash::GetPoints() const { return _points; }
+
+double SpatialGridHash::GetCellSize() const { return _cellSize; }
+
+std::size_t SpatialGridHash::Size() const { return _points.size(); }
+
+std::pair<int, int> SpatialGridHash::CellCoord(const cv::Point2f& p) const {
+    return {static_cast<int>(std::floor(p.x * _cellSizeInv)),
+            static_cast<int>(std::floor(p.y * _cellSizeInv))};
+}
+
+std::int64_t SpatialGridHash::CellKey(int cx, int cy) {
+    return (static_cast<std::int64_t>(cx) << 32) ^ static_cast<std::uint32_t>(cy);
+}
+}  // namespace ns_ekalibr
@@ -151,6 +151,22 @@ Ellipse::Ptr TimeVaryingEllipse::EllipseAt(double t) const {
     return {};
 }
 
+double TimeVaryingEllipse::MotionExtent() const {
+    double extent = (PosAt(et) - PosAt(st)).norm();
+    switch (type) {
+        case TVType::NONE: {
+        } break;
+        case TVType::CIRCLE: {
+            extent += std::abs(RadiusAt(et) - RadiusAt(st));
+        } break;
+        case TVType::ELLIPSE: {
+            extent += std::max(std::abs(EllipseAxs1At(et) - EllipseAxs1At(st)),
+                               std::abs(EllipseAxs2At(et) - EllipseAxs2At(st)));
+        } break;
+    }
+    return extent;
+}
+
 void TimeVaryingEllipse::Draw(cv::Mat& mat,
                               double timestamp,
                               const std::optional<cv::Scalar>& color) const {
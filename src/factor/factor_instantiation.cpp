@@ -39,16 +39,21 @@
 
 namespace ns_ekalibr {
 template struct IMUGyroFactor<Configor ::Prior::SplineOrder>;
+template struct IMUGyroFixedTOFactor<Configor::Prior::SplineOrder>;
+template struct IMUGyroIntervalFactor<Configor::Prior::SplineOrder>;
 template struct HandEyeRotationAlignFactor<Configor::Prior::SplineOrder>;
 template struct So3SplineAlignToWorldFactor<Configor::Prior::SplineOrder>;
 template struct EventInertialAlignHelper<Configor::Prior::SplineOrder>;
 template struct EventInertialAlignFactor<Configor::Prior::SplineOrder>;
 template struct IMUAcceFactor<Configor::Prior::SplineOrder, 2>;
+template struct IMUAcceFixedTOFactor<Configor::Prior::SplineOrder, 2>;
+template struct IMUAcceIntervalFactor<Configor::Prior::SplineOrder, 2>;
 template struct LinearScaleDerivFactor<Configor::Prior::SplineOrder, 2>;
 template struct LinearScaleDerivFactor<Configor::Prior::SplineOrder, 1>;
 template struct LinearScaleDerivFactor<Configor::Prior::SplineOrder, 0>;
 template struct So3Factor<Configor::Prior::SplineOrder>;
 template struct VisualProjectionFactor<Configor::Prior::SplineOrder>;
+template struct VisualProjectionFixedTOFactor<Configor::Prior::SplineOrder>;
 template struct HandEyeTransformAlignFactor<Configor::Prior::SplineOrder>;
 template struct RegularizationL2Factor<3>;
 }  // namespace ns_ekalibr
\ No newline at end of file
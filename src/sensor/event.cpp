@@ -27,36 +27,114 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "sensor/event.h"
+#include "algorithm"
 
 namespace ns_ekalibr {
-Event::Event(double timestamp, PosType pos, bool polarity)
+EventTimeDomain::EventTimeDomain(double bias)
+    : bias(bias) {}
+
+EventTimeDomain::Ptr EventTimeDomain::Create(double bias) {
+    return std::make_shared<EventTimeDomain>(bias);
+}
+
+Event::Event(double timestamp, PosType pos, bool polarity, EventTimeDomain* domain)
     : _timestamp(timestamp),
       _pos(std::move(pos)),
-      _polarity(polarity) {}
+      _polarity(polarity),
+      _domain(domain) {}
 
-Event::Ptr Event::Create(double timestamp, const PosType& pos, bool polarity) {
-    return std::make_shared<Event>(timestamp, pos, polarity);
+Event::Ptr Event::Create(double timestamp,
+                         const PosType& pos,
+                         bool polarity,
+                         EventTimeDomain* domain) {
+    return std::make_shared<Event>(timestamp, pos, polarity, domain);
 }
 
-double Event::GetTimestamp() const { return _timestamp; }
+double Event::GetTimestamp() const {
+    return _domain == nullptr ? _timestamp : _timestamp - _domain->bias;
+}
 
-void Event::SetTimestamp(double timestamp) { _timestamp = timestamp; }
+void Event::SetTimestamp(double timestamp) {
+    _timestamp = _domain == nullptr ? timestamp : timestamp + _domain->bias;
+}
 
 Event::PosType Event::GetPos() const { return _pos; }
 
 bool Event::GetPolarity() const { return _polarity; }
 
-EventArray::EventArray(double timestamp, const std::vector<Event::Ptr>& events)
-    : _timestamp(timestamp),
-      _events(events) {}
+EventTimeDomain* Event::GetTimeDomain() const { return _domain; }
 
-EventArray::Ptr EventArray::Create(double timestamp, const std::vector<Event::Ptr>& events) {
-    return std::make_shared<EventArray>(timestamp, events);
+void Event::SetTimeDomain(EventTimeDomain* domain) {
+    const double timestamp = GetTimestamp();
+    _domain = domain;
+    SetTimestamp(timestamp);
 }
 
-double EventArray::GetTimestamp() const { return _timestamp; }
+EventArray::EventArray(double timestamp,
+                       const std::vector<Event::Ptr>& events,
+                       const std::vector<EventTimeDomain::Ptr>& domains)
+    : _events(events),
+      _domains(domains) {
+    if (_domains.empty()) {
+        CollectTimeDomains();
+    }
+    if (_domains.empty()) {
+        _domains.push_back(EventTimeDomain::Create());
+    }
+    _timestamp = timestamp + _domains.front()->bias;
+}
+
+EventArray::Ptr EventArray::Create(double timestamp,
+                                   const std::vector<Event::Ptr>& events,
+                                   const std::vector<EventTimeDomain::Ptr>& domains) {
+    return std::make_shared<EventArray>(timestamp, events, domains);
+}
+
+double EventArray::GetTimestamp() const { return _timestamp - _domains.front()->bias; }
 
 const std::vector<Event::Ptr>& EventArray::GetEvents() const { return _events; }
 
-void EventArray::SetTimestamp(double timestamp) { _timestamp = timestamp; }
+void EventArray::SetTimestamp(double timestamp) { _timestamp = timestamp + _domains.front()->bias; }
+
+const std::vector<EventTimeDomain::Ptr>& EventArray::GetTimeDomains() const { return _domains; }
+
+void EventArray::SetTimeBias(double bias) {
+    for (const auto& domain : _domains) {
+        domain->bias = bias;
+    }
+}
+
+void EventArray::CollectTimeDomains() {
+    // events of a domain are mostly contiguous, thus the last collected one is checked first
+    for (const auto& event : _events) {
+        EventTimeDomain* domain = event->GetTimeDomain();
+        if (domain == nullptr || (!_domains.empty() && _domains.back().get() == domain) ||
+            std::any_of(_domains.cbegin(), _domains.cend(),
+                        [domain](const auto& d) { return d.get() == domain; })) {
+            continue;
+        }
+        _domains.push_back(domain->shared_from_this());
+    }
+}
+
+EventSerialIndex::EventSerialIndex(const std::vector<EventArray::Ptr>& arrays)
+    : _arrays(arrays),
+      _offsets(arrays.size() + 1, 0) {
+    for (std::size_t i = 0; i < _arrays.size(); ++i) {
+        _offsets[i + 1] = _offsets[i] + static_cast<std::int64_t>(_arrays[i]->GetEvents().size());
+    }
+}
+
+EventSerialIndex::Ptr EventSerialIndex::Create(const std::vector<EventArray::Ptr>& arrays) {
+    return std::make_shared<EventSerialIndex>(arrays);
+}
+
+const Event::Ptr& EventSerialIndex::At(std::int64_t serial) const {
+    // the last array starting at or before 'serial', empty arrays share offsets and are skipped
+    const auto iter = std::upper_bound(_offsets.cbegin(), _offsets.cend() - 1, serial) - 1;
+    const auto i = static_cast<std::size_t>(iter - _offsets.cbegin());
+    return _arrays[i]->GetEvents()[serial - *iter];
+}
+
+std::int64_t EventSerialIndex::Size() const { return _offsets.back(); }
 }  // namespace ns_ekalibr
\ No newline at end of file
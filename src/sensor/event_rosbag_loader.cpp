@@ -195,17 +195,19 @@ EventArray::Ptr PropheseeEventDataLoader::UnpackData(const rosbag::MessageInstan
     CheckMessage<ekalibr::PropheseeEventArray>(msg);
 
     std::vector<Event::Ptr> events(msg->events.size());
+    // events of this array are created in its time domain, re-based later as a whole
+    const auto domain = EventTimeDomain::Create();
 
     for (int i = 0; i < static_cast<int>(msg->events.size()); i++) {
         const auto &event = msg->events.at(i);
-        events.at(i) =
-            Event::Create(event.ts.toSec(), Event::PosType(event.x, event.y), event.polarity);
+        events.at(i) = Event::Create(event.ts.toSec(), Event::PosType(event.x, event.y),
+                                     event.polarity, domain.get());
     }
 
     if (msg->header.stamp.isZero()) {
-        return EventArray::Create(events.back()->GetTimestamp(), events);
+        return EventArray::Create(events.back()->GetTimestamp(), events, {domain});
     } else {
-        return EventArray::Create(msg->header.stamp.toSec(), events);
+        return EventArray::Create(msg->header.stamp.toSec(), events, {domain});
     }
 }
 
@@ -222,16 +224,18 @@ EventArray::Ptr DVSEventDataLoader::UnpackData(const rosbag::MessageInstance &ms
     CheckMessage<ekalibr::DVSEventArray>(msg);
 
     std::vector<Event::Ptr> events(msg->events.size());
+    // events of this array are created in its time domain, re-based later as a whole
+    const auto domain = EventTimeDomain::Create();
 
     for (int i = 0; i < static_cast<int>(msg->events.size()); i++) {
         const auto &event = msg->events.at(i);
-        events.at(i) =
-            Event::Create(event.ts.toSec(), Event::PosType(event.x, event.y), event.polarity);
+        events.at(i) = Event::Create(event.ts.toSec(), Event::PosType(event.x, event.y),
+                                     event.polarity, domain.get());
     }
     if (msg->header.stamp.isZero()) {
-        return EventArray::Create(events.back()->GetTimestamp(), events);
+        return EventArray::Create(events.back()->GetTimestamp(), events, {domain});
     } else {
-        return EventArray::Create(msg->header.stamp.toSec(), events);
+        return EventArray::Create(msg->header.stamp.toSec(), events, {domain});
     }
 }
 }  // namespace ns_ekalibr
\ No newline at end of file